@@ -0,0 +1,203 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements the bit-packed encoding of integer values
+// in frames of BITPACK_FRAMESIZE values
+
+#include "BitPack.hpp"
+#include "ContMan.hpp"
+#include "UnCompCont.hpp"
+
+void *BitPackFrame::operator new(size_t size)
+{
+   return blockmem.GetByteBlock(size);
+}
+
+inline unsigned char GetBitWidth(unsigned long val)
+   // Returns the number of bits needed to represent 'val'
+{
+   unsigned char width=0;
+   while(val!=0)
+   {
+      width++;
+      val>>=1;
+   }
+   return width;
+}
+
+inline unsigned long LoadLittleEndian32(unsigned char *ptr)
+   // Reads four bytes with the least significant byte first
+   // Modern compilers translate this into a single load instruction
+{
+   return (unsigned long)ptr[0]|((unsigned long)ptr[1]<<8)|
+          ((unsigned long)ptr[2]<<16)|((unsigned long)ptr[3]<<24);
+}
+
+//**************************************************************************
+
+void StoreBitPackFrame(CompressContainer *cont,BitPackFrame *frame)
+   // Stores the values of the frame in 'cont' and empties the frame
+{
+   unsigned long  minval,maxval,val;
+   unsigned long  i,bitbuf;
+   unsigned char  width,bitnum;
+   unsigned char  packed[BITPACK_FRAMESIZE*4];
+   unsigned char  *ptr;
+
+   // We determine the frame of reference and the bit width
+   minval=maxval=frame->values[0];
+   for(i=1;i<frame->count;i++)
+   {
+      if(frame->values[i]<minval)
+         minval=frame->values[i];
+      if(frame->values[i]>maxval)
+         maxval=frame->values[i];
+   }
+   width=GetBitWidth((maxval-minval)&0xFFFFFFFFUL);
+
+   if(frame->count<BITPACK_FRAMESIZE)
+   {
+      cont->StoreChar(width|BITPACK_PARTIAL);
+      cont->StoreUInt32(frame->count);
+   }
+   else
+      cont->StoreChar(width);
+
+   cont->StoreChar((unsigned char)minval);
+   cont->StoreChar((unsigned char)(minval>>8));
+   cont->StoreChar((unsigned char)(minval>>16));
+   cont->StoreChar((unsigned char)(minval>>24));
+
+   if(width>0)
+   {
+      // We pack the differences to the minimum with the least significant bit first
+      // Since 'bitbuf' might only have 32 bits, we add the upper 8 bits of
+      // wide values separately
+      ptr=packed;
+      bitbuf=0;
+      bitnum=0;
+
+      for(i=0;i<frame->count;i++)
+      {
+         val=(frame->values[i]-minval)&0xFFFFFFFFUL;
+
+         bitbuf|=(val&0xFFFFFFL)<<bitnum;
+         bitnum+=(width>24) ? 24 : width;
+         while(bitnum>=8)
+         {
+            *(ptr++)=(unsigned char)bitbuf;
+            bitbuf>>=8;
+            bitnum-=8;
+         }
+         if(width>24)
+         {
+            bitbuf|=(val>>24)<<bitnum;
+            bitnum+=width-24;
+            while(bitnum>=8)
+            {
+               *(ptr++)=(unsigned char)bitbuf;
+               bitbuf>>=8;
+               bitnum-=8;
+            }
+         }
+      }
+      if(bitnum>0)
+         *(ptr++)=(unsigned char)bitbuf;
+
+      cont->StoreData((char *)packed,ptr-packed);
+   }
+   frame->count=0;
+}
+
+//**************************************************************************
+
+void LoadBitPackFrame(UncompressContainer *cont,BitPackFrame *frame)
+   // Loads the next frame from 'cont'
+{
+   unsigned long  minval,mask,bitpos;
+   unsigned long  i,count;
+   unsigned char  width;
+   // We keep a few more bytes, since we always read four (or five) bytes at once
+   unsigned char  packed[BITPACK_FRAMESIZE*4+8];
+   unsigned char  *ptr;
+   unsigned       packedlen;
+
+   width=(unsigned char)cont->LoadChar();
+   if(width&BITPACK_PARTIAL)
+   {
+      width&=~BITPACK_PARTIAL;
+      count=cont->LoadUInt32();
+      if((count==0)||(count>=BITPACK_FRAMESIZE))
+         ExitCorruptFile();
+   }
+   else
+      count=BITPACK_FRAMESIZE;
+
+   if(width>32)
+      ExitCorruptFile();
+
+   minval=(unsigned long)(unsigned char)cont->LoadChar();
+   minval|=(unsigned long)(unsigned char)cont->LoadChar()<<8;
+   minval|=(unsigned long)(unsigned char)cont->LoadChar()<<16;
+   minval|=(unsigned long)(unsigned char)cont->LoadChar()<<24;
+
+   frame->count=count;
+   frame->curidx=0;
+
+   if(width==0)   // All values are equal?
+   {
+      for(i=0;i<count;i++)
+         frame->values[i]=minval;
+      return;
+   }
+
+   packedlen=(count*width+7)>>3;
+   mymemcpy((char *)packed,(char *)cont->GetDataPtr(packedlen),packedlen);
+   memset(packed+packedlen,0,8);
+
+   mask=(width==32) ? 0xFFFFFFFFUL : ((1UL<<width)-1);
+
+   // Each value is unpacked with a single (unaligned) load, a shift and a mask
+   // Values with more than 25 bits might span five bytes, so we need
+   // to add the bits of the fifth byte
+   bitpos=0;
+   if(width<=25)
+   {
+      for(i=0;i<count;i++)
+      {
+         frame->values[i]=minval+((LoadLittleEndian32(packed+(bitpos>>3))>>(bitpos&7))&mask);
+         bitpos+=width;
+      }
+   }
+   else
+   {
+      for(i=0;i<count;i++)
+      {
+         ptr=packed+(bitpos>>3);
+         frame->values[i]=(minval+(((LoadLittleEndian32(ptr)>>(bitpos&7))|
+                                    (((unsigned long)ptr[4]<<8)<<(24-(bitpos&7))))&mask))&0xFFFFFFFFUL;
+         bitpos+=width;
+      }
+   }
+}
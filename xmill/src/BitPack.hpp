@@ -0,0 +1,106 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements the bit-packed encoding of integer values that is
+// used by the integer compressors 'u', 'u8', 'i' and 'di', if option '-b' is set.
+// Instead of storing each value as a variable-length integer, the values
+// are collected in frames of BITPACK_FRAMESIZE values. A frame is stored
+// as the minimum of its values (i.e. the frame of reference) and the bit width
+// of the largest difference, followed by the differences of all values
+// packed with exactly that number of bits.
+// Since values within a container are usually of similar size, most frames
+// need only a few bits per value and the fixed layout can be unpacked
+// with a simple loop without any branches per value.
+//
+// A frame has the following format:
+//    - A byte with the bit width (0..32). If the frame contains fewer than
+//      BITPACK_FRAMESIZE values (which can only happen for the last frame
+//      of a container), then bit 7 is set and the number of values follows
+//    - The minimum value (four bytes)
+//    - The differences to the minimum, packed with the least significant bit first
+
+#ifndef BITPACK_HPP
+#define BITPACK_HPP
+
+#include "Types.hpp"
+
+class CompressContainer;
+class UncompressContainer;
+class MemStreamer;
+
+extern MemStreamer blockmem;
+
+#define BITPACK_FRAMESIZE  128      // The number of values in a frame
+#define BITPACK_PARTIAL    0x80     // Marks a frame with less than BITPACK_FRAMESIZE values
+
+struct BitPackFrame
+   // Keeps the values of the current frame
+   // For compression, these are the values that have not been stored yet
+   // For decompression, these are the values of the last frame that has been loaded
+{
+   unsigned long  count;      // The number of values in the frame
+   unsigned long  curidx;     // The index of the next value to be returned (decompression only)
+   unsigned long  values[BITPACK_FRAMESIZE];
+
+   void *operator new(size_t size);
+   void operator delete(void *ptr)  {}
+
+   BitPackFrame()
+   {
+      count=curidx=0;
+   }
+};
+
+void StoreBitPackFrame(CompressContainer *cont,BitPackFrame *frame);
+   // Stores the values of the frame in 'cont' and empties the frame
+
+void LoadBitPackFrame(UncompressContainer *cont,BitPackFrame *frame);
+   // Loads the next frame from 'cont'
+
+inline void BitPackValue(CompressContainer *cont,BitPackFrame *frame,unsigned long val)
+   // Adds value 'val' to the frame
+   // The frame is stored as soon as it is full
+{
+   frame->values[frame->count++]=val;
+   if(frame->count==BITPACK_FRAMESIZE)
+      StoreBitPackFrame(cont,frame);
+}
+
+inline void BitPackFinish(CompressContainer *cont,BitPackFrame *frame)
+   // Stores the remaining values at the end of the container block
+{
+   if(frame->count>0)
+      StoreBitPackFrame(cont,frame);
+}
+
+inline unsigned long BitUnpackValue(UncompressContainer *cont,BitPackFrame *frame)
+   // Returns the next value - a new frame is loaded,
+   // if all values of the current frame have been returned
+{
+   if(frame->curidx==frame->count)
+      LoadBitPackFrame(cont,frame);
+   return frame->values[frame->curidx++];
+}
+
+#endif
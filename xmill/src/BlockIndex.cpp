@@ -0,0 +1,642 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements the block index
+
+#include "BlockIndex.hpp"
+#include "Compress.hpp"
+#include "Input.hpp"
+#include "Output.hpp"
+#include "SmallUncompress.hpp"
+#include "LabelDict.hpp"
+#include "CurPath.hpp"
+#include "ContMan.hpp"
+
+extern MemStreamer mainmem;
+
+BlockIndex blockindex;
+
+// The sync points are kept until the end of the file. Their memory is not
+// counted for the memory limit of the blocks, since the blocks would
+// otherwise become smaller and smaller.
+unsigned long syncpointmemory=0;
+
+inline void StoreIndexNumber(MemStreamer *mem,unsigned long val)
+   // Stores a number that might not fit into 30 bits
+{
+   mem->StoreUInt32(val&0x3FFFFFFFUL);
+   mem->StoreUInt32((val>>30)&3);
+}
+
+inline unsigned long LoadIndexNumber(SmallBlockUncompressor *uncompressor)
+   // Loads a number that has been stored with 'StoreIndexNumber'
+{
+   unsigned long val=uncompressor->LoadUInt32();
+   return val|(uncompressor->LoadUInt32()<<30);
+}
+
+inline void StoreIndexPos(MemStreamer *mem,TFilePos val)
+   // Stores a file position - like 'StoreIndexNumber', but the second
+   // number contains all upper bits
+{
+   mem->StoreUInt32((unsigned long)(val&0x3FFFFFFFUL));
+   mem->StoreUInt32((unsigned long)(val>>30));
+}
+
+inline TFilePos LoadIndexPos(SmallBlockUncompressor *uncompressor)
+   // Loads a file position that has been stored with 'StoreIndexPos'
+{
+   TFilePos val=uncompressor->LoadUInt32();
+   return val|((TFilePos)uncompressor->LoadUInt32()<<30);
+}
+
+//**************************************************************************
+
+void BlockIndex::StartBlock(TFilePos offset)
+   // Adds a new block that starts at position 'offset' of the output file
+{
+   CurPathIterator   it;
+   unsigned long     i,depth=curpath.GetDepth();
+
+   StoreIndexPos(&indexmem,offset);
+   StoreIndexNumber(&indexmem,recordcount);
+   indexmem.StoreUInt32(globallabeldict.GetSavedLabelNum());
+
+   // We store the open labels starting with the innermost element
+   indexmem.StoreUInt32(depth);
+
+   curpath.InitIterator(&it);
+   for(i=0;i<depth;i++)
+      indexmem.StoreUInt32(GET_LABELID(it.GotoPrev()));
+
+   blocknum++;
+}
+
+void BlockIndex::AddLargeContainer(unsigned long compressedsize)
+   // Adds the compressed size of the next large container of the current block
+{
+   StoreIndexNumber(&contsizemem,compressedsize);
+   largecontnum++;
+}
+
+void BlockIndex::FinishBlock(unsigned long datasize)
+   // Finishes the current block with uncompressed size 'datasize'
+{
+   MemStreamBlock *block=contsizemem.GetFirstBlock();
+
+   indexmem.StoreUInt32(datasize);
+
+   // We append the sizes of the large containers
+   indexmem.StoreUInt32(largecontnum);
+
+   while(block!=NULL)
+   {
+      indexmem.StoreData(block->data,block->cursize);
+      block=block->next;
+   }
+   contsizemem.ReleaseMemory(0);
+   largecontnum=0;
+}
+
+void BlockIndex::CreateDocumentTable()
+   // Starts the document table
+{
+   hasdocuments=1;
+   documentnum=0;
+}
+
+void BlockIndex::StartDocument(unsigned long tokenpos)
+   // Adds a new document that starts in the current block
+{
+   StoreIndexNumber(&documentmem,blocknum-1);
+   StoreIndexNumber(&documentmem,tokenpos);
+   documentnum++;
+}
+
+void BlockIndex::AddSyncPoint(unsigned long record)
+   // Adds a sync point in the current block in front of record 'record'
+{
+   CurPathIterator   it;
+   unsigned long     i,depth=curpath.GetDepth();
+   MemStreamBlock    *block;
+
+   StoreIndexNumber(&syncmem,blocknum-1);
+   StoreIndexNumber(&syncmem,record);
+
+   // As for the blocks, the open labels start with the innermost element
+   syncmem.StoreUInt32(depth);
+
+   curpath.InitIterator(&it);
+   for(i=0;i<depth;i++)
+      syncmem.StoreUInt32(GET_LABELID(it.GotoPrev()));
+
+   // The container positions and states are stored with their size,
+   // so that the index can be loaded without interpreting them
+   compresscontman.StoreSyncState(&syncstatemem);
+
+   StoreIndexNumber(&syncmem,syncstatemem.GetSize());
+
+   for(block=syncstatemem.GetFirstBlock();block!=NULL;block=block->next)
+      syncmem.StoreData(block->data,block->cursize);
+
+   syncstatemem.ReleaseMemory(0);
+   syncnum++;
+
+   syncpointmemory=syncmem.GetSize();
+}
+
+void BlockIndex::Store(Output *output)
+   // Stores the index and the footer at the end of the output file
+{
+   TFilePos       offset=output->GetCurFileSize();
+   unsigned long  uncompressedsize,compressedsize,magic;
+   MemStreamer    mem(1);
+   int            i;
+
+   {
+      Compressor     compressor(output);
+
+      // The index starts with a block header without container blocks,
+      // so that a decompressor that reads the blocks one after the
+      // other stops in front of the index
+      mem.StoreUInt32(0);
+      mem.StoreUInt32(0);
+      mem.StoreUInt32(blocknum);
+      compressor.CompressMemStream(&mem);
+      compressor.CompressMemStream(&indexmem);
+
+      mem.ReleaseMemory(1);
+
+      // The document table is in front of the labels, so that
+      // it can be loaded without the labels
+      if(hasdocuments)
+      {
+         mem.StoreUInt32(documentnum);
+         compressor.CompressMemStream(&mem);
+         compressor.CompressMemStream(&documentmem);
+         mem.ReleaseMemory(1);
+      }
+
+      if(syncnum>0)
+      {
+         StoreIndexNumber(&mem,syncnum);
+         compressor.CompressMemStream(&mem);
+         compressor.CompressMemStream(&syncmem);
+         mem.ReleaseMemory(1);
+      }
+
+      globallabeldict.StoreAll(&mem);
+
+      // The number of records is needed for appending more records
+      StoreIndexNumber(&mem,recordcount);
+      compressor.CompressMemStream(&mem);
+
+      compressor.FinishCompress(&uncompressedsize,&compressedsize);
+   }
+
+   // The footer contains the 64-bit position of the index and the magic key
+   // Both are stored with the least significant byte first
+   for(i=0;i<8;i++)
+      output->StoreChar((char)(offset>>(i*8)));
+   if(syncnum>0)
+      magic=hasdocuments ? BLOCKINDEX_DOCSYNCMAGIC : BLOCKINDEX_SYNCMAGIC;
+   else
+      magic=hasdocuments ? BLOCKINDEX_DOCMAGIC : BLOCKINDEX_MAGIC;
+
+   for(i=0;i<4;i++)
+      output->StoreChar((char)(magic>>(i*8)));
+
+   indexmem.ReleaseMemory(1);
+   blocknum=0;
+   documentmem.ReleaseMemory(0);
+   documentnum=0;
+   hasdocuments=0;
+   syncmem.ReleaseMemory(0);
+   syncnum=0;
+   syncpointmemory=0;
+   if(oldindex!=NULL)
+   {
+      free(oldindex);
+      oldindex=NULL;
+   }
+   oldindexlen=0;
+}
+
+//**************************************************************************
+
+TFilePos ReadIndexFooter(unsigned char *footer,TFilePos filesize,unsigned long *magic)
+   // Reads the footer at 'footer' of a file with 'filesize' bytes
+   // Returns the position of the index or 0, if the footer is not valid
+{
+   TFilePos offset=0;
+   int      i;
+
+   *magic=0;
+   for(i=7;i>=0;i--)
+      offset=(offset<<8)|footer[i];
+   for(i=3;i>=0;i--)
+      *magic=(*magic<<8)|footer[i+8];
+
+   if(((*magic!=BLOCKINDEX_MAGIC)&&(*magic!=BLOCKINDEX_DOCMAGIC)&&
+       (*magic!=BLOCKINDEX_SYNCMAGIC)&&(*magic!=BLOCKINDEX_DOCSYNCMAGIC))||
+      (offset==0)||(offset>=filesize-BLOCKINDEX_FOOTERSIZE))
+      return 0;
+
+   return offset;
+}
+
+TFilePos BlockIndex::FindIndex(Input *input)
+   // Reads the footer of the file and moves to the beginning of the index
+{
+   unsigned char  footer[BLOCKINDEX_FOOTERSIZE];
+   TFilePos       filesize,offset;
+   unsigned long  magic;
+
+   filesize=input->GetFileSize();
+   if((filesize<BLOCKINDEX_FOOTERSIZE)||
+      (input->SetFilePos(filesize-BLOCKINDEX_FOOTERSIZE)==0)||
+      (input->ReadData((char *)footer,BLOCKINDEX_FOOTERSIZE)!=0))
+      return 0;
+
+   offset=ReadIndexFooter(footer,filesize,&magic);
+   if((offset==0)||(input->SetFilePos(offset)==0))
+      return 0;
+
+   hasdocuments=((magic==BLOCKINDEX_DOCMAGIC)||(magic==BLOCKINDEX_DOCSYNCMAGIC)) ? 1 : 0;
+   hassyncpoints=((magic==BLOCKINDEX_SYNCMAGIC)||(magic==BLOCKINDEX_DOCSYNCMAGIC)) ? 1 : 0;
+
+   return offset;
+}
+
+void BlockIndex::LoadEntry(SmallBlockUncompressor *uncompressor,BlockIndexEntry *entry)
+   // Loads the index information of the next block
+{
+   unsigned long j;
+
+   entry->offset=LoadIndexPos(uncompressor);
+   entry->firstrecord=LoadIndexNumber(uncompressor);
+   entry->labelnum=uncompressor->LoadUInt32();
+
+   // The open labels are stored starting with the innermost element
+   entry->depth=uncompressor->LoadUInt32();
+
+   mainmem.WordAlign();
+   entry->openlabels=(TLabelID *)mainmem.GetByteBlock(sizeof(TLabelID)*(entry->depth+1));
+   for(j=entry->depth;j>0;j--)
+      entry->openlabels[j-1]=(TLabelID)uncompressor->LoadUInt32();
+
+   entry->datasize=uncompressor->LoadUInt32();
+
+   entry->largecontnum=uncompressor->LoadUInt32();
+   entry->largecontsizes=(unsigned long *)mainmem.GetByteBlock(sizeof(unsigned long)*(entry->largecontnum+1));
+   for(j=0;j<entry->largecontnum;j++)
+      entry->largecontsizes[j]=LoadIndexNumber(uncompressor);
+}
+
+void BlockIndex::LoadSyncPoint(SmallBlockUncompressor *uncompressor,BlockIndexSyncPoint *syncpoint)
+   // Loads the next sync point
+{
+   unsigned long j;
+
+   syncpoint->block=LoadIndexNumber(uncompressor);
+   syncpoint->record=LoadIndexNumber(uncompressor);
+
+   syncpoint->depth=uncompressor->LoadUInt32();
+   if(syncpoint->depth>MAXLABEL_NUM)
+      ExitCorruptFile();
+
+   mainmem.WordAlign();
+   syncpoint->openlabels=(TLabelID *)mainmem.GetByteBlock(sizeof(TLabelID)*(syncpoint->depth+1));
+   for(j=syncpoint->depth;j>0;j--)
+      syncpoint->openlabels[j-1]=(TLabelID)uncompressor->LoadUInt32();
+
+   // The state is copied, since the data of the uncompressor is overwritten
+   syncpoint->statelen=LoadIndexNumber(uncompressor);
+   syncpoint->state=(unsigned char *)mainmem.GetByteBlock(syncpoint->statelen+1);
+   if(syncpoint->statelen>0)
+      memcpy(syncpoint->state,uncompressor->LoadData(syncpoint->statelen),syncpoint->statelen);
+}
+
+char BlockIndex::Load(char *filename,unsigned long labelblockidx)
+   // Loads the index of file 'filename'
+{
+   Input          input;
+   unsigned long  labelnum,i;
+   BlockIndexEntry *entry;
+   char           isattrib;
+
+   blocknum=0;
+   documentnum=0;
+   hasdocuments=0;
+   syncnum=0;
+   hassyncpoints=0;
+   recordnum=0;
+
+   // A file can have more blocks, documents and sync points than fit
+   // into a single memory block - so the tables are allocated separately
+   if(entries!=NULL)
+   {
+      free(entries);
+      entries=NULL;
+   }
+   if(documents!=NULL)
+   {
+      free(documents);
+      documents=NULL;
+   }
+   if(syncpoints!=NULL)
+   {
+      free(syncpoints);
+      syncpoints=NULL;
+   }
+
+   if(input.OpenFile(filename)==0)
+      return 0;
+
+   if(FindIndex(&input)==0)
+   {
+      input.CloseFile();
+      return 0;
+   }
+
+   {
+      SmallBlockUncompressor uncompressor(&input);
+
+      // We skip the block header in front of the index
+      if((uncompressor.LoadUInt32()!=0)||(uncompressor.LoadUInt32()!=0))
+         ExitCorruptFile();
+
+      blocknum=uncompressor.LoadUInt32();
+      if(blocknum==0)
+         ExitCorruptFile();
+
+      entries=(BlockIndexEntry *)malloc(sizeof(BlockIndexEntry)*blocknum);
+      if(entries==NULL)
+         ExitNoMem();
+
+      for(entry=entries;entry<entries+blocknum;entry++)
+         LoadEntry(&uncompressor,entry);
+
+      if(hasdocuments)
+      {
+         documentnum=uncompressor.LoadUInt32();
+
+         documents=(BlockIndexDocument *)malloc(sizeof(BlockIndexDocument)*(documentnum+1));
+         if(documents==NULL)
+            ExitNoMem();
+         for(i=0;i<documentnum;i++)
+         {
+            documents[i].block=LoadIndexNumber(&uncompressor);
+            documents[i].tokenpos=LoadIndexNumber(&uncompressor);
+            if(documents[i].block>=blocknum)
+               ExitCorruptFile();
+         }
+      }
+
+      if(hassyncpoints)
+      {
+         syncnum=LoadIndexNumber(&uncompressor);
+
+         syncpoints=(BlockIndexSyncPoint *)malloc(sizeof(BlockIndexSyncPoint)*(syncnum+1));
+         if(syncpoints==NULL)
+            ExitNoMem();
+         for(i=0;i<syncnum;i++)
+         {
+            LoadSyncPoint(&uncompressor,syncpoints+i);
+            if((syncpoints[i].block>=blocknum)||
+               ((i>0)&&(syncpoints[i].record<=syncpoints[i-1].record)))
+               ExitCorruptFile();
+         }
+      }
+
+      // The label dictionary follows - we only need the labels that
+      // were defined before block 'labelblockidx'
+      if(labelblockidx>=blocknum)
+      {
+         char tmpstr[100];
+         sprintf(tmpstr,"The file has only %lu blocks!",blocknum);
+         Error(tmpstr);
+         Exit();
+      }
+      labelnum=uncompressor.LoadUInt32();
+      if(labelnum>MAXLABEL_NUM)
+         ExitCorruptFile();
+
+      i=0;
+      if(labelblockidx>0)
+      {
+         i=entries[labelblockidx].labelnum;
+         if(i>labelnum)
+            ExitCorruptFile();
+
+         globallabeldict.LoadLabels(&uncompressor,i);
+      }
+
+      // The other labels are skipped, since the number of records follows
+      for(;i<labelnum;i++)
+         uncompressor.LoadData(uncompressor.LoadSInt32(&isattrib));
+
+      recordnum=LoadIndexNumber(&uncompressor);
+   }
+   input.CloseFile();
+   return 1;
+}
+
+TFilePos BlockIndex::LoadForAppend(char *filename)
+   // Loads the index of file 'filename', so that new blocks can be appended
+{
+   Input          input;
+   TFilePos       offset;
+   unsigned long  i,j;
+   BlockIndexEntry entry;
+
+   indexmem.ReleaseMemory(1);
+   blocknum=0;
+   documentmem.ReleaseMemory(0);
+   documentnum=0;
+   hasdocuments=0;
+   syncmem.ReleaseMemory(0);
+   syncnum=0;
+   syncpointmemory=0;
+   hassyncpoints=0;
+   if(oldindex!=NULL)
+   {
+      free(oldindex);
+      oldindex=NULL;
+   }
+   oldindexlen=0;
+
+   if(input.OpenFile(filename)==0)
+      return 0;
+
+   offset=FindIndex(&input);
+   if(offset==0)
+   {
+      input.CloseFile();
+      return 0;
+   }
+
+   {
+      SmallBlockUncompressor uncompressor(&input);
+
+      // We skip the block header in front of the index
+      if((uncompressor.LoadUInt32()!=0)||(uncompressor.LoadUInt32()!=0))
+         ExitCorruptFile();
+
+      blocknum=uncompressor.LoadUInt32();
+      if(blocknum==0)
+         ExitCorruptFile();
+
+      // The entries of the old blocks are copied into the new index
+      for(i=0;i<blocknum;i++)
+      {
+         LoadEntry(&uncompressor,&entry);
+
+         StoreIndexPos(&indexmem,entry.offset);
+         StoreIndexNumber(&indexmem,entry.firstrecord);
+         indexmem.StoreUInt32(entry.labelnum);
+
+         indexmem.StoreUInt32(entry.depth);
+         for(j=entry.depth;j>0;j--)
+            indexmem.StoreUInt32(entry.openlabels[j-1]);
+
+         indexmem.StoreUInt32(entry.datasize);
+
+         indexmem.StoreUInt32(entry.largecontnum);
+         for(j=0;j<entry.largecontnum;j++)
+            StoreIndexNumber(&indexmem,entry.largecontsizes[j]);
+      }
+
+      // The old documents are kept in the document table
+      if(hasdocuments)
+      {
+         documentnum=uncompressor.LoadUInt32();
+         for(i=0;i<documentnum;i++)
+         {
+            StoreIndexNumber(&documentmem,LoadIndexNumber(&uncompressor));
+            StoreIndexNumber(&documentmem,LoadIndexNumber(&uncompressor));
+         }
+      }
+
+      // The old sync points are kept as well
+      if(hassyncpoints)
+      {
+         BlockIndexSyncPoint syncpoint;
+
+         syncnum=LoadIndexNumber(&uncompressor);
+         for(i=0;i<syncnum;i++)
+         {
+            LoadSyncPoint(&uncompressor,&syncpoint);
+
+            StoreIndexNumber(&syncmem,syncpoint.block);
+            StoreIndexNumber(&syncmem,syncpoint.record);
+
+            syncmem.StoreUInt32(syncpoint.depth);
+            for(j=syncpoint.depth;j>0;j--)
+               syncmem.StoreUInt32(syncpoint.openlabels[j-1]);
+
+            StoreIndexNumber(&syncmem,syncpoint.statelen);
+            syncmem.StoreData((char *)syncpoint.state,syncpoint.statelen);
+         }
+         syncpointmemory=syncmem.GetSize();
+      }
+
+      // The new blocks use the same label dictionary
+      if(globallabeldict.LoadStoredLabels(&uncompressor)==0)
+      {
+         Error("The file was compressed with different path expressions!");
+         Exit();
+      }
+
+      // The new records are counted after the old records
+      recordcount=LoadIndexNumber(&uncompressor);
+   }
+
+   // We keep the old index and the footer, so that we can restore them
+   // if the compression fails
+   oldindexlen=(unsigned long)(input.GetFileSize()-offset);
+   oldindex=(char *)malloc(oldindexlen);
+   if(oldindex==NULL)
+      ExitNoMem();
+
+   if((input.SetFilePos(offset)==0)||
+      (input.ReadData(oldindex,oldindexlen)!=0))
+      ExitCorruptFile();
+
+   input.CloseFile();
+   return offset;
+}
+
+unsigned long BlockIndex::FindRecordBlock(unsigned long record)
+   // Returns the index of the block in which record 'record' starts
+   // This is the last block whose first record is not larger than 'record'
+{
+   unsigned long low=0,high=blocknum;
+
+   while(high-low>1)
+   {
+      unsigned long mid=(low+high)/2;
+      if(entries[mid].firstrecord<=record)
+         low=mid;
+      else
+         high=mid;
+   }
+   return low;
+}
+
+BlockIndexSyncPoint *BlockIndex::FindSyncPoint(unsigned long blockidx,unsigned long record)
+   // Returns the last sync point of block 'blockidx' that is not behind record 'record'
+{
+   unsigned long low=0,high=syncnum;
+
+   // We look for the first sync point behind the record
+   while(low<high)
+   {
+      unsigned long mid=(low+high)/2;
+      if(syncpoints[mid].record<=record)
+         low=mid+1;
+      else
+         high=mid;
+   }
+   if((low==0)||(syncpoints[low-1].block!=blockidx))
+      return NULL;
+
+   return syncpoints+low-1;
+}
+
+unsigned long BlockIndex::FindFirstSyncPoint(unsigned long blockidx)
+   // Returns the index of the first sync point of block 'blockidx'
+{
+   unsigned long low=0,high=syncnum;
+
+   while(low<high)
+   {
+      unsigned long mid=(low+high)/2;
+      if(syncpoints[mid].block<blockidx)
+         low=mid+1;
+      else
+         high=mid;
+   }
+   return low;
+}
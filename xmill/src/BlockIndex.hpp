@@ -0,0 +1,278 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements the block index. An XMill file is a sequence of
+// blocks and normally, the position of a block is only known after
+// all previous blocks have been decompressed. If option '-x' is set, the
+// compressor appends an index behind the last block that contains for each block
+//    - the position of the block in the file
+//    - the uncompressed size of the block
+//    - the number of the first record (i.e. child of the root element)
+//      starting in the block
+//    - the labels of the elements that are still open at the beginning of the block
+//    - the number of labels that were defined in previous blocks
+//    - the compressed size of each large container, so that the
+//      decompressor can skip containers that it does not need
+// The index also contains the complete label dictionary and the number
+// of records in the file.
+// With this information, the decompressor can seek directly to any block and
+// decompress it without looking at the previous blocks.
+//
+// The index is stored as a single zlib block followed by a footer with the
+// 64-bit position of the index and a magic key, so that files larger
+// than 4GB can be indexed. The index starts with a block header without
+// container blocks: a decompressor that reads the blocks one after the other
+// (e.g. from the standard input) stops there.
+//
+// With option '-A', new documents are appended to a file with an index:
+// The old index is loaded, the new blocks overwrite the old index and a
+// new index with the old and new blocks is stored at the end.
+//
+// With option '-M', many documents are compressed into the same blocks.
+// The index then also contains a table of the documents: for each document,
+// the block in which it starts and the number of structure tokens of that
+// block that belong to the previous documents. Such an index has a different
+// magic key, so that files without the table can still be read.
+// If option '-A' appends to a file with a document table, then each
+// appended file becomes a new document.
+//
+// With option '-y', the index also contains sync points: every n-th record,
+// the compressor stores the position of all containers and the state of the
+// user compressors that depend on previous text items. With a sync point,
+// the decompressor can start in the middle of a block at the beginning of
+// the record. The sync points are stored behind the document table and
+// the index again has a different magic key.
+// Since each sync point contains the position of every container, the
+// interval should be large for documents with many different paths.
+
+#ifndef BLOCKINDEX_HPP
+#define BLOCKINDEX_HPP
+
+#include "Types.hpp"
+#include "MemStreamer.hpp"
+
+class Output;
+class Input;
+class SmallBlockUncompressor;
+
+#define BLOCKINDEX_MAGIC      0x58494d58UL   // The magic key at the end of the footer
+#define BLOCKINDEX_DOCMAGIC   0x44494d58UL   // The magic key of an index with a document table
+#define BLOCKINDEX_SYNCMAGIC  0x53494d58UL   // The magic key of an index with sync points
+#define BLOCKINDEX_DOCSYNCMAGIC 0x42494d58UL // The magic key of an index with both
+#define BLOCKINDEX_FOOTERSIZE 12             // The size of the footer
+
+#define BLOCKINDEX_LASTBLOCK  0xFFFFFFFFUL   // Denotes the last block of a file
+
+extern unsigned long recordcount;   // The number of records parsed so far
+extern unsigned long syncpointmemory;  // The memory of the sync points of the compressor
+
+TFilePos ReadIndexFooter(unsigned char *footer,TFilePos filesize,unsigned long *magic);
+   // Reads the footer at 'footer' of a file with 'filesize' bytes
+   // Returns the position of the index or 0, if the footer is not valid
+   // The magic key is stored in '*magic'
+
+struct BlockIndexEntry
+   // The index information for a single block
+{
+   TFilePos       offset;        // The position of the block in the file
+   unsigned long  datasize;      // The uncompressed size of the block
+   unsigned long  firstrecord;   // The number of the first record in the block
+   unsigned long  labelnum;      // The number of labels defined in the previous blocks
+   unsigned long  depth;         // The number of open elements at the beginning of the block
+   TLabelID       *openlabels;   // The labels of the open elements
+   unsigned long  largecontnum;  // The number of large containers
+   unsigned long  *largecontsizes;  // The compressed sizes of the large containers
+};
+
+struct BlockIndexSyncPoint
+   // A position in a block at which the decompressor can start
+{
+   unsigned long  block;         // The index of the block
+   unsigned long  record;        // The number of the record starting at the sync point
+   unsigned long  depth;         // The number of open elements at the sync point
+   TLabelID       *openlabels;   // The labels of the open elements
+   unsigned long  statelen;      // The size of the container positions and states
+   unsigned char  *state;        // The container positions and user compressor states
+                                 // (see CompressContainerMan::StoreSyncState)
+};
+
+struct BlockIndexDocument
+   // The position of a document in a multi-document file
+{
+   unsigned long  block;         // The index of the block in which the document starts
+   unsigned long  tokenpos;      // The number of structure tokens of the block in front of the document
+};
+
+class BlockIndex
+{
+   // For compression, the entries are accumulated in 'indexmem'
+   MemStreamer       indexmem;
+
+   // The compressed sizes of the large containers of the current block
+   MemStreamer       contsizemem;
+   unsigned long     largecontnum;
+
+   // For decompression, the entries are loaded into 'entries'
+   BlockIndexEntry   *entries;
+
+   unsigned long     blocknum;   // The number of blocks
+
+   // The document table - for compression, the entries are accumulated
+   // in 'documentmem' and for decompression, they are loaded into 'documents'
+   char              hasdocuments;
+   MemStreamer       documentmem;
+   BlockIndexDocument *documents;
+   unsigned long     documentnum;
+
+   // The sync points - for compression, they are accumulated in 'syncmem'
+   // and for decompression, they are loaded into 'syncpoints'
+   char              hassyncpoints;
+   MemStreamer       syncmem;
+   MemStreamer       syncstatemem;  // The state of the current sync point
+   BlockIndexSyncPoint *syncpoints;
+   unsigned long     syncnum;
+
+   unsigned long     recordnum;  // The number of records of a loaded file
+
+   // For appending, we keep the old index and footer of the file
+   char              *oldindex;
+   unsigned long     oldindexlen;
+
+   TFilePos FindIndex(Input *input);
+      // Reads the footer of the file and moves to the beginning of the index
+      // Returns the position of the index or 0, if the file has no index
+      // 'hasdocuments' is set, if the index contains a document table
+      // and 'hassyncpoints' is set, if it contains sync points
+
+   void LoadEntry(SmallBlockUncompressor *uncompressor,BlockIndexEntry *entry);
+      // Loads the index information of the next block
+
+   void LoadSyncPoint(SmallBlockUncompressor *uncompressor,BlockIndexSyncPoint *syncpoint);
+      // Loads the next sync point
+
+public:
+   BlockIndex() : indexmem(1), contsizemem(0), documentmem(0), syncmem(0), syncstatemem(0)
+   {
+      entries=NULL;
+      blocknum=0;
+      hasdocuments=0;
+      documents=NULL;
+      documentnum=0;
+      hassyncpoints=0;
+      syncpoints=NULL;
+      syncnum=0;
+      recordnum=0;
+      largecontnum=0;
+      oldindex=NULL;
+      oldindexlen=0;
+   }
+
+// Functions for compression
+
+   void StartBlock(TFilePos offset);
+      // Adds a new block that starts at position 'offset' of the output file
+      // The state at the beginning of the block is taken from
+      // the current path, the label dictionary and the record counter
+
+   void AddLargeContainer(unsigned long compressedsize);
+      // Adds the compressed size of the next large container of the current block
+
+   void FinishBlock(unsigned long datasize);
+      // Finishes the current block with uncompressed size 'datasize'
+      // This must be called after all large containers have been compressed
+
+   void CreateDocumentTable();
+      // Starts the document table for a new file
+
+   void StartDocument(unsigned long tokenpos);
+      // Adds a new document that starts in the current block
+      // behind the first 'tokenpos' structure tokens
+
+   void AddSyncPoint(unsigned long record);
+      // Adds a sync point in the current block in front of record 'record'
+      // The state is taken from the current path and the containers
+
+   void Store(Output *output);
+      // Stores the index and the footer at the end of the output file
+
+   TFilePos LoadForAppend(char *filename);
+      // Loads the index of file 'filename', so that new blocks can be appended.
+      // The entries of the old blocks are kept for the new index and the labels
+      // are loaded into the label dictionary of the compressor.
+      // The function returns the position of the old index, i.e. the position
+      // where the new blocks start. If the file has no index, 0 is returned.
+
+   char *GetOldIndex(unsigned long *len)  {  *len=oldindexlen; return oldindex;  }
+      // Returns the old index and footer loaded with 'LoadForAppend'
+
+// Functions for decompression
+
+   char Load(char *filename,unsigned long labelblockidx);
+      // Loads the index of file 'filename'. The function returns 0, if the
+      // file does not have an index.
+      // If 'labelblockidx' is larger than zero, then the labels defined before
+      // block 'labelblockidx' are loaded into the label dictionary.
+
+   unsigned long GetBlockNum()   {  return blocknum;  }
+      // Returns the number of blocks
+
+   unsigned long GetRecordNum()  {  return recordnum;  }
+      // Returns the number of records
+
+   BlockIndexEntry *GetBlock(unsigned long blockidx)   {  return entries+blockidx; }
+      // Returns the index information of the block with index 'blockidx'
+
+   unsigned long FindRecordBlock(unsigned long record);
+      // Returns the index of the block in which record 'record' starts
+
+   BlockIndexSyncPoint *FindSyncPoint(unsigned long blockidx,unsigned long record);
+      // Returns the last sync point of block 'blockidx' that is not behind
+      // record 'record' - or NULL, if there is no such sync point
+
+   unsigned long FindFirstSyncPoint(unsigned long blockidx);
+      // Returns the index of the first sync point of block 'blockidx' - or the
+      // index of the first sync point behind the block, if it has no sync point
+
+   unsigned long GetSyncPointNum()   {  return syncnum;  }
+      // Returns the number of sync points
+
+   BlockIndexSyncPoint *GetSyncPoint(unsigned long syncidx)   {  return syncpoints+syncidx;   }
+      // Returns the sync point with index 'syncidx'
+
+// Functions for both
+
+   char HasDocuments()   {  return hasdocuments;  }
+      // Returns 1, if the index has a document table
+
+   unsigned long GetDocumentNum()   {  return documentnum;  }
+      // Returns the number of documents
+
+   BlockIndexDocument *GetDocument(unsigned long docidx)   {  return documents+docidx; }
+      // Returns the position of the document with index 'docidx'
+      // This is only available after 'Load'
+};
+
+extern BlockIndex blockindex;
+
+#endif
@@ -96,6 +96,7 @@ public:
 public:
 
    Uncompressor() {  isinitialized=0;  }
+   ~Uncompressor();
 
    char Uncompress(Input *input,unsigned char *dataptr,unsigned long *len);
       // Decompresses the data from 'input' and stores
@@ -104,6 +105,20 @@ public:
       // of bytes uncompressed.
       // The function returns 1, if output buffer is full and
       // there is more data to read. Otherwise, the function returns 0.
+
+   char UncompressData(unsigned char **srcptr,unsigned long *srclen,unsigned char *dataptr,unsigned long *len);
+      // Decompresses the next piece of the data at '*srcptr' with
+      // length '*srclen' and stores the result in 'dataptr'.
+      // It decompresses at most *len bytes. Afterwards, '*len' is set to
+      // the number of bytes decompressed by this call and '*srcptr' and
+      // '*srclen' describe the compressed data that is not consumed yet.
+      // The function returns 0, if the end of the compressed data has been
+      // reached. Otherwise, it returns 1 - either the output buffer is full
+      // or more compressed data is needed.
+
+private:
+   void Init();
+      // Initializes the zlib state
 };
 
 
@@ -38,8 +38,11 @@ History:
 #include "PathDict.hpp"
 #include "VPathExprMan.hpp"
 #include "Types.hpp"
+#include "ParCompress.hpp"
+#include "BlockIndex.hpp"
 
 extern char verbose; // We need to reference the 'verbose' flag
+extern char use_blockindex;
 
 unsigned long structcontsizeorig=0;
 unsigned long structcontsizecompressed=0;
@@ -211,10 +214,24 @@ inline void CompressContainerBlock::CompressLargeContainers(Output *output)
 
       if(GetContainer(i)->GetSize()>=SMALLCONT_THRESHOLD)
       {
+         TFilePos startpos=output->GetCurFileSize();
+
          sumuncompressed+=GetContainer(i)->GetSize();
 
-         compress.CompressMemStream(GetContainer(i));
-         compress.FinishCompress(&uncompressedsize,&compressedsize);
+         // Very large containers are split into chunks that
+         // are compressed in parallel
+         if(UseParallelCompress(GetContainer(i)->GetSize()))
+            ParallelCompressMemStream(GetContainer(i),output,&uncompressedsize,&compressedsize);
+         else
+         {
+            compress.CompressMemStream(GetContainer(i));
+            compress.FinishCompress(&uncompressedsize,&compressedsize);
+         }
+
+         // The block index keeps the number of bytes that were written
+         // for the container, so that the decompressor can skip it
+         if(use_blockindex)
+            blockindex.AddLargeContainer((unsigned long)(output->GetCurFileSize()-startpos));
 
          if(verbose)
             printf("%8lu ==> %8lu (%f%%)\n",uncompressedsize,compressedsize,100.0f*(float)compressedsize/(float)uncompressedsize);
@@ -319,6 +336,35 @@ void CompressContainerMan::StoreMainInfo(MemStreamer *memstream)
 //   compressor->CompressMemStream(memstream);
 }
 
+//*************************************************************************
+
+inline void CompressContainerBlock::StoreSyncState(MemStreamer *output)
+{
+   output->StoreUInt32(contnum);
+
+   for(int i=0;i<contnum;i++)
+      output->StoreUInt32(GetContainer(i)->GetSize());
+}
+
+void CompressContainerMan::StoreSyncState(MemStreamer *memstream)
+{
+   CompressContainerBlock *block;
+
+   // Container blocks created after the sync point start at position 0
+   memstream->StoreUInt32(blocknum);
+
+   for(block=blocklist;block!=NULL;block=block->nextblock)
+      block->StoreSyncState(memstream);
+
+   // The states follow behind all positions, since the decompressor
+   // must move the containers before it restores the states
+   for(block=blocklist;block!=NULL;block=block->nextblock)
+   {
+      if(block->pathexpr!=NULL)
+         block->pathexpr->GetUserCompressor()->StoreSyncState(block->GetUserDataPtr(),memstream);
+   }
+}
+
 //*************************************************************************
 //*************************************************************************
 
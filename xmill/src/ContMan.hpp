@@ -83,6 +83,10 @@ class CompressContainerBlock
       // Stores the structural information about the container block
       // i.e. the number+size of the containers.
 
+   void StoreSyncState(MemStreamer *output);
+      // Stores the current sizes of the containers and the state
+      // of the user compressor for a sync point
+
    unsigned long GetDataSize();
       // Computes the overall size of the container block
 
@@ -165,6 +169,11 @@ public:
    void StoreMainInfo(MemStreamer *memstream);
       // Compresses the structural information of the container blocks
 
+   void StoreSyncState(MemStreamer *memstream);
+      // Stores the current sizes of all containers and the states of the
+      // user compressors, so that the decompressor can start at this point
+      // of the current block (see option '-y')
+
    unsigned long ComputeSmallContainerSize();
       // Determines the overall size of the small containers
 
@@ -34,6 +34,9 @@ History:
 // The current path is stored as a sequence of labels -
 // They are kept stored in blocks of 32 labels in 'CurPathLabelBlock'
 
+#ifndef CURPATH_HPP
+#define CURPATH_HPP
+
 // The number of labels per block
 #define CURPATH_LABELBLOCKSIZE   32
 
@@ -93,9 +96,10 @@ class CurPath
    CurPathLabelBlock *curblock;  // The current (last) block
    TLabelID          *curlabel;  // The current label (within the current block)
                                  // The current label is always the *next free* pointer
+   unsigned long     curdepth;   // The number of labels in the path
 
 #ifdef PROFILE
-   unsigned        curdepth,maxdepth;
+   unsigned        maxdepth;
 #endif
 
 public:
@@ -105,17 +109,30 @@ public:
       firstblock.next=NULL;
       curblock=&firstblock;
       curlabel=curblock->labels;
+      curdepth=0;
 
 #ifdef PROFILE
-     curdepth=maxdepth=0;
+     maxdepth=0;
 #endif
    }
 
+   void Reset()
+      // Removes all labels from the path
+      // (The label blocks are kept for later use)
+   {
+      curblock=&firstblock;
+      curlabel=curblock->labels;
+      curdepth=0;
+   }
+
+   unsigned long GetDepth()   {  return curdepth;  }
+      // Returns the number of labels in the path
+
    void AddLabel(TLabelID labelid)
       // Add a label at the end of the path
    {
-#ifdef PROFILE
       curdepth++;
+#ifdef PROFILE
          if(curdepth>maxdepth)
             maxdepth=curdepth;
 #endif
@@ -143,9 +160,9 @@ public:
    TLabelID RemoveLabel()
       // Removes the last label from the stack
    {
-#ifdef PROFILE
+      if(curdepth==0)   // Nothing to remove?
+         return LABEL_UNDEFINED;
       curdepth--;
-#endif
 
       curlabel--;
       if(curlabel==curblock->labels-1)
@@ -168,6 +185,14 @@ public:
       it->curlabel=curlabel;
    }
 
+   void InitIteratorToStart(CurPathIterator *it)
+      // Initializes an iterator for the path to the first label in the path
+      // The iterator can then be moved forward with 'GotoNext'
+   {
+      it->curblock=&firstblock;
+      it->curlabel=firstblock.labels;
+   }
+
 #ifdef PROFILE
    void PrintProfile()
    {
@@ -178,3 +203,5 @@ public:
 
 // There is one global path
 extern CurPath curpath;
+
+#endif
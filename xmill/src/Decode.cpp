@@ -1,30 +1,54 @@
 
 #include "UnCompCont.hpp"
-#include "XMLOutput.hpp"
+#include "XMLEventSink.hpp"
 #include "LabelDict.hpp"
 #include "CurPath.hpp"
+#include "StructCoder.hpp"
 
 #undef LoadString
 
 extern UncompressContainerMan  uncomprcont;
+extern char use_structcoder;
 
-void DecodeTreeBlock(UncompressContainer *treecont,UncompressContainer *whitespacecont,UncompressContainer *specialcont,XMLOutput *output)
+void DecodeTreeBlock(UncompressContainer *treecont,UncompressContainer *whitespacecont,UncompressContainer *specialcont,XMLEventSink *output)
 {
    char              *strptr;
-   unsigned char     isattrib;
    int               mystrlen;
    static char       tmpstr[20];
 
    unsigned char     *curptr,*endptr;
    long              id;
+   unsigned long     tokenval;
    char              isneg;
 
+   // The labels are looked up directly in the table of the label dictionary
+   // The table doesn't change while the block is decoded
+   UncompressLabelDictItem *labelarray=globallabeldict.GetLabelArray(),*item;
+   unsigned long           labelnum=globallabeldict.GetUncompressLabelNum();
+   TLabelID                labelid;
+
    curptr=treecont->GetDataPtr();
    endptr=curptr+treecont->GetSize();
 
-   while(curptr<endptr)
+   if(use_structcoder)
+      structdecoder.StartBlock(curptr,treecont->GetSize());
+
+   for(;;)
    {
-      id=LoadSInt32(curptr,&isneg);
+      // The tokens are either decoded by the structure coder
+      // or stored as plain integers
+      if(use_structcoder)
+      {
+         if(structdecoder.DecodeToken(&tokenval,&isneg)==0)
+            break;
+         id=(long)tokenval;
+      }
+      else
+      {
+         if(curptr>=endptr)
+            break;
+         id=LoadSInt32(curptr,&isneg);
+      }
 
       if(isneg==0)   // Do we have a label ID ?
       {
@@ -37,12 +61,15 @@ void DecodeTreeBlock(UncompressContainer *treecont,UncompressContainer *whitespa
          switch(id)
          {
          case TREETOKEN_ENDLABEL:  // An end-of-label token (i.e. id==0) ?
-            mystrlen=globallabeldict.LookupLabel(curpath.RemoveLabel(),&strptr,&isattrib);
+            labelid=curpath.RemoveLabel();
+            if(labelid>=labelnum)
+               ExitCorruptFile();
+            item=labelarray+labelid;
 
-            if(isattrib==0)
-               output->endElement(strptr,mystrlen);
+            if(item->isattrib==0)
+               output->endElement(item->strptr,item->len);
             else
-               output->endAttribute(strptr,mystrlen);
+               output->endAttribute(item->strptr,item->len);
             break;
 
          case TREETOKEN_EMPTYENDLABEL:  // An end-of-label token for an empty element
@@ -62,17 +89,19 @@ void DecodeTreeBlock(UncompressContainer *treecont,UncompressContainer *whitespa
 
          case TREETOKEN_SPECIAL:    // A special token
             strptr=(char *)(specialcont->LoadString((unsigned *)&mystrlen));
-            output->characters(strptr,mystrlen);
+            output->special(strptr,mystrlen);
             break;
 
          default: // Do we have a start label token?
             id-=LABELIDX_TOKENOFFS;
-            mystrlen=globallabeldict.LookupLabel((TLabelID)id,&strptr,&isattrib);
+            if((unsigned long)id>=labelnum)
+               ExitCorruptFile();
+            item=labelarray+id;
 
-            if(isattrib==0)
-               output->startElement(strptr,mystrlen);
+            if(item->isattrib==0)
+               output->startElement(item->strptr,item->len);
             else
-               output->startAttribute(strptr,mystrlen);
+               output->startAttribute(item->strptr,item->len);
 
             curpath.AddLabel((TLabelID)id);
          }
@@ -379,6 +379,21 @@ public:
          item=item->next;
       }
    }
+
+   void StoreSyncState(char *dataptr,MemStreamer *mem)
+      // Stores the states of all subcompressors
+   {
+      DivCompressorItem *item=info.subcompressors;
+
+      while(item!=NULL)
+      {
+         item->usercompressor->StoreSyncState(dataptr,mem);
+
+         dataptr+=item->usercompressor->GetUserDataSize();
+
+         item=item->next;
+      }
+   }
 };
 
 
@@ -434,7 +449,21 @@ public:
       }
    }
 
-   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLOutput *output)
+   void LoadSyncState(UncompressContainer *cont,char *dataptr,unsigned char * &ptr)
+      // Restores the states of the subcompressors
+   {
+      DivCompressorItem *item=info.subcompressors;
+
+      while(item!=NULL)
+      {
+         item->useruncompressor->LoadSyncState(cont,dataptr,ptr);
+         cont+=item->useruncompressor->GetUserContNum();
+         dataptr+=item->useruncompressor->GetUserDataSize();
+         item=item->next;
+      }
+   }
+
+   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLEventSink *output)
       // Does the actual decompression of a single text item
       // and prints the text to 'output'
    {
@@ -641,6 +670,21 @@ public:
          item=item->next;
       }
    }
+
+   void StoreSyncState(char *dataptr,MemStreamer *mem)
+      // Stores the states of all subcompressors
+   {
+      DivCompressorItem *item=info.subcompressors;
+
+      while(item!=NULL)
+      {
+         item->usercompressor->StoreSyncState(dataptr,mem);
+
+         dataptr+=item->usercompressor->GetUserDataSize();
+
+         item=item->next;
+      }
+   }
 };
 
 
@@ -698,7 +742,21 @@ public:
       }
    }
 
-   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLOutput *output)
+   void LoadSyncState(UncompressContainer *cont,char *dataptr,unsigned char * &ptr)
+      // Restores the states of the subcompressors - they share the containers
+   {
+      DivCompressorItem *item=info.subcompressors;
+
+      while(item!=NULL)
+      {
+         item->useruncompressor->LoadSyncState(cont,dataptr,ptr);
+
+         dataptr+=item->useruncompressor->GetUserDataSize();
+         item=item->next;
+      }
+   }
+
+   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLEventSink *output)
       // Does the actual decompression of a single text item
       // and prints the text to 'output'
    {
@@ -0,0 +1,198 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements the extraction of single documents (option '-D')
+
+#include "Document.hpp"
+#include "UnCompCont.hpp"
+#include "LabelDict.hpp"
+#include "BlockIndex.hpp"
+
+#undef LoadString
+
+extern MemStreamer            mainmem;
+extern UncompressContainerMan uncomprcont;
+
+DocumentExtractor documentextractor;
+
+void DocumentExtractor::SetDocument(char *filename,unsigned long docidx)
+   // Finds the position of document 'docidx' in the document table of file 'filename'
+{
+   BlockIndexDocument   *doc;
+
+   mainmem.StartNewMemBlock();
+
+   // The standard input and memory data cannot have an index
+   if((filename==NULL)||(blockindex.Load(filename,0)==0)||(blockindex.HasDocuments()==0))
+   {
+      mainmem.RemoveLastMemBlock();
+      Error("Option -D requires a file compressed with option -M!");
+      Exit();
+   }
+   if(docidx>=blockindex.GetDocumentNum())
+   {
+      char tmpstr[100];
+      sprintf(tmpstr,"The file has only %lu documents!",blockindex.GetDocumentNum());
+      mainmem.RemoveLastMemBlock();
+      Error(tmpstr);
+      Exit();
+   }
+
+   doc=blockindex.GetDocument(docidx);
+   startblock=doc->block;
+   starttokenpos=doc->tokenpos;
+
+   if(docidx+1<blockindex.GetDocumentNum())
+      // The document ends where the next document starts
+   {
+      doc++;
+      if((doc->tokenpos==0)&&(doc->block>startblock))
+      {
+         endblock=doc->block-1;
+         endtokenpos=DOCUMENT_ALLTOKENS;
+      }
+      else
+      {
+         endblock=doc->block;
+         endtokenpos=doc->tokenpos;
+      }
+   }
+   else
+   {
+      endblock=blockindex.GetBlockNum()-1;
+      endtokenpos=DOCUMENT_ALLTOKENS;
+   }
+   mainmem.RemoveLastMemBlock();
+}
+
+void DocumentExtractor::StartFile()
+   // Initializes the extraction for the next file
+{
+   SelectiveUncompressor::StartFile();
+   curblock=startblock;
+}
+
+unsigned long DocumentExtractor::GetNeededDepth()
+   // The text items inside the elements that are still open
+   // at the beginning of the block might belong to the document
+{
+   return (curpath.GetDepth()>0) ? 1 : 0;
+}
+
+//**************************************************************************
+
+void DocumentExtractor::DecodeBlock(UncompressContainer *whitespacecont,UncompressContainer *specialcont,XMLEventSink *output)
+   // Prints the tokens of the block that belong to the document
+   // This is the same loop as in 'DecodeTreeBlock', but the
+   // output of the other documents is dropped
+{
+   unsigned long     *curtoken=tokens,*endtoken=tokens+tokennum;
+   unsigned long     *firstdoctoken=tokens,*enddoctoken=endtoken;
+   char              *strptr;
+   unsigned long     mystrlen;
+   unsigned char     isattrib;
+   char              isinside;
+   long              id;
+   UncompressContainerBlock *contblock;
+
+   // The tokens in front of 'firstdoctoken' and behind 'enddoctoken'
+   // belong to other documents
+   if(curblock==startblock)
+      firstdoctoken+=(starttokenpos<tokennum) ? starttokenpos : tokennum;
+   if((curblock==endblock)&&(endtokenpos<tokennum))
+      enddoctoken=tokens+endtokenpos;
+
+   while(curtoken<endtoken)
+   {
+      isinside=(curtoken>=firstdoctoken)&&(curtoken<enddoctoken);
+
+      id=(long)(*curtoken&~PROJECTION_TEXTTOKEN);
+
+      if((*(curtoken++)&PROJECTION_TEXTTOKEN)==0)
+      {
+         switch(id)
+         {
+         case TREETOKEN_ENDLABEL:
+            mystrlen=globallabeldict.LookupLabel(curpath.RemoveLabel(),&strptr,&isattrib);
+            if(isinside)
+            {
+               if(isattrib==0)
+                  output->endElement(strptr,mystrlen);
+               else
+                  output->endAttribute(strptr,mystrlen);
+            }
+            break;
+
+         case TREETOKEN_EMPTYENDLABEL:
+            curpath.RemoveLabel();
+            if(isinside)
+               output->endEmptyElement();
+            break;
+
+         case TREETOKEN_WHITESPACE:
+            mystrlen=whitespacecont->LoadUInt32();
+            strptr=(char *)whitespacecont->GetDataPtr(mystrlen);
+            if(isinside)
+               output->whitespaces(strptr,mystrlen);
+            break;
+
+         case TREETOKEN_ATTRIBWHITESPACE:
+            mystrlen=whitespacecont->LoadUInt32();
+            strptr=(char *)whitespacecont->GetDataPtr(mystrlen);
+            if(isinside)
+               output->attribWhitespaces(strptr,mystrlen);
+            break;
+
+         case TREETOKEN_SPECIAL:
+            strptr=(char *)specialcont->LoadString((unsigned *)&mystrlen);
+            if(isinside)
+               output->special(strptr,mystrlen);
+            break;
+
+         default: // A start label
+            id-=LABELIDX_TOKENOFFS;
+            curpath.AddLabel((TLabelID)id);
+
+            if(isinside)
+            {
+               mystrlen=globallabeldict.LookupLabel((TLabelID)id,&strptr,&isattrib);
+               if(isattrib==0)
+                  output->startElement(strptr,mystrlen);
+               else
+                  output->startAttribute(strptr,mystrlen);
+            }
+         }
+      }
+      else  // A text item
+      {
+         // Text items outside of elements are never needed
+         // (see 'GetNeededDepth'), so their containers might be skipped
+         contblock=uncomprcont.GetContBlock(id);
+         if(contblock->IsSkipped()==0)
+            contblock->UncompressText(isinside ? output : &nulloutput);
+      }
+   }
+   curblock++;
+}
@@ -0,0 +1,84 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements the extraction of a single document from a
+// multi-document file (option '-D'). Such files are compressed with option '-M'
+// and the documents share the same blocks. The document table of the block
+// index contains the block in which each document starts and the number of
+// structure tokens of that block that belong to the previous documents.
+//
+// The decompressor starts with the block of the document and stops after
+// the block of the next document. The tokens of the other documents in these
+// blocks are decoded as well, since they advance the containers, but their
+// output is dropped.
+
+#ifndef DOCUMENT_HPP
+#define DOCUMENT_HPP
+
+#include "Projection.hpp"
+
+// Denotes that the entire file is decompressed (option '-D' is not set)
+#define DOCUMENT_ALLDOCUMENTS 0xFFFFFFFFUL
+
+// Denotes that all tokens of a block belong to the document
+#define DOCUMENT_ALLTOKENS 0xFFFFFFFFUL
+
+class DocumentExtractor : public SelectiveUncompressor
+{
+   unsigned long  startblock,starttokenpos;  // The first token of the document
+   unsigned long  endblock,endtokenpos;      // The token behind the document
+   unsigned long  curblock;                  // The index of the current block
+
+   unsigned char ComputeMatches(CurPath *path)  {  return PROJECTION_NEEDED;  }
+      // All elements can belong to the document
+
+   unsigned long GetNeededDepth();
+      // Returns 1 if the block starts within an element
+
+   void DecodeBlock(UncompressContainer *whitespacecont,UncompressContainer *specialcont,XMLEventSink *output);
+      // Prints the tokens of the block that belong to the document
+
+public:
+   DocumentExtractor()
+   {
+      startblock=starttokenpos=0;
+      endblock=endtokenpos=0;
+      curblock=0;
+   }
+
+   void SetDocument(char *filename,unsigned long docidx);
+      // Finds the position of document 'docidx' in the document table of file 'filename'
+
+   unsigned long GetFirstBlock()  {  return startblock; }
+   unsigned long GetLastBlock()   {  return endblock;   }
+      // Return the range of blocks that contain the document
+
+   void StartFile();
+      // Initializes the extraction for the next file
+};
+
+extern DocumentExtractor documentextractor;
+
+#endif
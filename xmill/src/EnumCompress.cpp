@@ -350,7 +350,7 @@ public:
       *(EnumUncompressState *)dataptr=*GetNextPossibleEnumUnCompressState();
    }
 
-   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLOutput *output)
+   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLEventSink *output)
       // An item is decompressed by looking up the dictionary
    {
       unsigned idx=cont->LoadUInt32();
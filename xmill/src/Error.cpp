@@ -38,8 +38,11 @@ History:
 
 #include "Error.hpp"
 
-#define ERRMSG_MAXLEN   512   // The maximum length of all error
-                              // messages together
+#ifdef WIN32
+#define THREADLOCAL  __declspec(thread)
+#else
+#define THREADLOCAL  __thread
+#endif
 
 struct ErrLine
 {
@@ -47,26 +50,33 @@ struct ErrLine
    char     line[1];
 };
 
-ErrLine  *curerrline=NULL;
+ErrorBuffer globalerrors;
 
-char  errmsg[ERRMSG_MAXLEN+1];
-char  *curptr=errmsg;
-int   errstrlen;
-char  *msgptr=errmsg+ERRMSG_MAXLEN-1;
+// The error messages of a worker thread (see 'SetThreadErrorBuffer')
+// For the main thread, this is NULL
+THREADLOCAL ErrorBuffer *threaderrors=NULL;
+
+inline ErrorBuffer *GetErrorBuffer()
+   // Returns the error messages of the current thread
+{
+   return (threaderrors!=NULL) ? threaderrors : &globalerrors;
+}
 
 void Error(char *str,int len)
    // Starts a new error msg
 {
-   if((curptr-errmsg)+sizeof(ErrLine)+len+1>ERRMSG_MAXLEN)
+   ErrorBuffer *buf=GetErrorBuffer();
+
+   if((buf->curptr-buf->errmsg)+sizeof(ErrLine)+len+1>ERRMSG_MAXLEN)
       return;
 
-   ((ErrLine *)curptr)->next=curerrline;
-   curerrline=(ErrLine *)curptr;
+   ((ErrLine *)buf->curptr)->next=buf->curerrline;
+   buf->curerrline=(ErrLine *)buf->curptr;
 
-   memcpy(curerrline+1,str,len);
-   ((char *)(curerrline+1))[len]=0;
+   memcpy(buf->curerrline+1,str,len);
+   ((char *)(buf->curerrline+1))[len]=0;
 
-   curptr+=sizeof(ErrLine)+len+1;
+   buf->curptr+=sizeof(ErrLine)+len+1;
 }
 
 void Error(char *str)
@@ -78,14 +88,16 @@ void Error(char *str)
 void ErrorCont(char *str,int len)
    // Continues the current error msg
 {
-   curptr--;
-   if((curptr-errmsg)+len+1>ERRMSG_MAXLEN)
+   ErrorBuffer *buf=GetErrorBuffer();
+
+   buf->curptr--;
+   if((buf->curptr-buf->errmsg)+len+1>ERRMSG_MAXLEN)
       return;
 
-   memcpy(curptr,str,len);
-   curptr[len]=0;
+   memcpy(buf->curptr,str,len);
+   buf->curptr[len]=0;
 
-   curptr+=len+1;
+   buf->curptr+=len+1;
 }
 
 void ErrorCont(char *str)
@@ -97,14 +109,42 @@ void ErrorCont(char *str)
 void PrintErrorMsg()
    // Prints the current error messsages
 {
-   while(curerrline!=NULL)
+   ErrorBuffer *buf=GetErrorBuffer();
+
+   while(buf->curerrline!=NULL)
    {
-      printf("%s\n",(char *)(curerrline+1));
-      curerrline=curerrline->next;
+      printf("%s\n",(char *)(buf->curerrline+1));
+      buf->curerrline=buf->curerrline->next;
    }
 
-   curptr=errmsg;
-   msgptr=errmsg+ERRMSG_MAXLEN-1;
+   buf->curptr=buf->errmsg;
+}
+
+void SetThreadErrorBuffer(ErrorBuffer *buf)
+   // The error messages of the current thread are stored in 'buf'
+{
+   threaderrors=buf;
+}
+
+static void AddErrorLines(ErrLine *line)
+   // Adds the error message 'line' and the messages before it
+   // The list starts with the last message, so that the first message
+   // is added first
+{
+   if(line==NULL)
+      return;
+
+   AddErrorLines(line->next);
+   Error((char *)(line+1));
+}
+
+void AddErrorMsg(ErrorBuffer *buf)
+   // Adds the error messages in 'buf' to the current error messages
+{
+   AddErrorLines(buf->curerrline);
+
+   buf->curerrline=NULL;
+   buf->curptr=buf->errmsg;
 }
 
 // A global exception that we use to exit the program
@@ -36,6 +36,21 @@ History:
 #ifndef ERROR_HPP
 #define ERROR_HPP
 
+#define ERRMSG_MAXLEN   512   // The maximum length of all error
+                              // messages together
+
+struct ErrLine;
+
+struct ErrorBuffer
+   // Keeps the error messages until they are printed
+{
+   ErrLine  *curerrline;   // The last error message
+   char     *curptr;       // The end of the messages in 'errmsg'
+   char     errmsg[ERRMSG_MAXLEN+1];
+
+   ErrorBuffer()  {  curerrline=NULL;curptr=errmsg;   }
+};
+
 void Error(char *str,int len);   // Starts a new error msg
 void Error(char *str);           // Starts a new error msg (with '\0' at the end)
 
@@ -44,6 +59,15 @@ void ErrorCont(char *str);          // Continues the current error msg
 
 void PrintErrorMsg();   // Prints the current error messsages
 
+void SetThreadErrorBuffer(ErrorBuffer *buf);
+   // The error messages of the current thread are stored in 'buf'
+   // instead of the global error messages. This is used by worker threads,
+   // whose messages are passed on by the main thread with 'AddErrorMsg'.
+   // If 'buf' is NULL, the global error messages are used again.
+
+void AddErrorMsg(ErrorBuffer *buf);
+   // Adds the error messages in 'buf' to the current error messages
+
 void Exit();   // Exits the program
 
 inline void ExitNoMem()
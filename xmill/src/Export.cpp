@@ -0,0 +1,332 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements the export of compressed files into tables (option '-E')
+
+#include "Export.hpp"
+#include "VPathExprMan.hpp"
+#include "UnCompCont.hpp"
+#include "LabelDict.hpp"
+
+extern MemStreamer            mainmem;
+extern UncompressContainerMan uncomprcont;
+
+ColumnExporter columnexporter;
+
+//**************************************************************************
+
+void ColumnExporter::AddColumn(char * &str,char *endptr)
+   // Adds the column for the path between 'str' and 'endptr'
+{
+   ExportColumn *column;
+
+   if(columnnum==EXPORT_MAXCOLUMNS)
+   {
+      Error("Too many columns for option -E!");
+      Exit();
+   }
+   column=columns+columnnum;
+
+   // We keep a copy of the path for the first line
+   column->pathstr=mainmem.GetByteBlock(endptr-str+1);
+   memcpy(column->pathstr,str,endptr-str);
+   column->pathstr[endptr-str]=0;
+
+   column->pathexpr=new(&mainmem) VPathExpr();
+   column->pathexpr->CreateProjectionFromString(str,endptr);
+
+   columnnum++;
+
+   selectiveuncompressor=this;
+}
+
+void ColumnExporter::SetRecordPath(char * &str,char *endptr)
+   // Sets the path of the records between 'str' and 'endptr'
+{
+   recordpath=new(&mainmem) VPathExpr();
+   recordpath->CreateProjectionFromString(str,endptr);
+}
+
+void ColumnExporter::StartFile()
+   // Initializes the export for the next file
+{
+   SelectiveUncompressor::StartFile();
+
+   recorddepth=coldepth=0;
+   curcolumn=NULL;
+   inattrib=0;
+   isheaderprinted=0;
+
+   for(unsigned long i=0;i<columnnum;i++)
+   {
+      columns[i].valuenum=0;
+      columns[i].valueoutput.CreateMemoryOutput(1024);
+   }
+   rowoutput.CreateMemoryOutput();
+}
+
+void ColumnExporter::FinishFile(XMLEventSink *output)
+   // Prints the record that is still open
+{
+   unsigned long i;
+
+   if(recorddepth>0)
+      PrintRow(output);
+   else
+   {
+      if(isheaderprinted==0)
+         PrintHeader(output);
+   }
+
+   for(i=0;i<columnnum;i++)
+      columns[i].valueoutput.CloseFile();
+   rowoutput.CloseFile();
+
+   SelectiveUncompressor::FinishFile(output);
+}
+
+//**************************************************************************
+
+void ColumnExporter::StoreField(char *str,unsigned long len)
+   // Stores the field 'str' in the current row
+   // In CSV format, fields with separators, quotes or new lines are
+   // enclosed in quotes and the quotes are doubled. In TSV format,
+   // tabs and new lines cannot be quoted and are replaced by spaces.
+{
+   char           *endptr=str+len,*ptr;
+
+   if(format==EXPORT_CSV)
+   {
+      for(ptr=str;ptr<endptr;ptr++)
+      {
+         if((*ptr==',')||(*ptr=='"')||(*ptr=='\r')||(*ptr=='\n'))
+            break;
+      }
+      if(ptr==endptr)
+      {
+         rowoutput.StoreData(str,len);
+         return;
+      }
+      rowoutput.StoreChar('"');
+      for(ptr=str;ptr<endptr;ptr++)
+      {
+         if(*ptr=='"')
+            rowoutput.StoreChar('"');
+         rowoutput.StoreChar(*ptr);
+      }
+      rowoutput.StoreChar('"');
+   }
+   else
+   {
+      for(ptr=str;ptr<endptr;ptr++)
+      {
+         if((*ptr=='\t')||(*ptr=='\r')||(*ptr=='\n'))
+            rowoutput.StoreChar(' ');
+         else
+            rowoutput.StoreChar(*ptr);
+      }
+   }
+}
+
+void ColumnExporter::PrintHeader(XMLEventSink *output)
+   // Prints the first line with the paths of the columns
+{
+   char  *ptr;
+   int   len;
+
+   for(unsigned long i=0;i<columnnum;i++)
+   {
+      if(i>0)
+         rowoutput.StoreChar((format==EXPORT_CSV) ? ',' : '\t');
+      StoreField(columns[i].pathstr,strlen(columns[i].pathstr));
+   }
+   rowoutput.StoreNewline();
+
+   ptr=rowoutput.GetMemoryData(&len);
+   output->characters(ptr,len);
+   rowoutput.SetMemoryDataSize(0);
+
+   isheaderprinted=1;
+}
+
+void ColumnExporter::PrintRow(XMLEventSink *output)
+   // Prints the fields of the current record and resets them
+{
+   char  *ptr;
+   int   len;
+
+   if(isheaderprinted==0)
+      PrintHeader(output);
+
+   for(unsigned long i=0;i<columnnum;i++)
+   {
+      if(i>0)
+         rowoutput.StoreChar((format==EXPORT_CSV) ? ',' : '\t');
+
+      ptr=columns[i].valueoutput.GetMemoryData(&len);
+      StoreField(ptr,len);
+
+      columns[i].valueoutput.SetMemoryDataSize(0);
+      columns[i].valuenum=0;
+   }
+   rowoutput.StoreNewline();
+
+   ptr=rowoutput.GetMemoryData(&len);
+   output->characters(ptr,len);
+   rowoutput.SetMemoryDataSize(0);
+}
+
+//**************************************************************************
+
+unsigned char ColumnExporter::ComputeMatches(CurPath *path)
+   // Checks whether the element or attribute at the end of 'path' matches a column
+   // The index of the first matching column is stored behind the flags
+{
+   unsigned char     matches=0;
+   CurPathIterator   it;
+
+   if(recordpath!=NULL)
+   {
+      // Only elements can be records
+      path->InitIterator(&it);
+      if((ISATTRIB(MapLabel(it.GotoPrev()))==0)&&MatchesPath(recordpath,path))
+         matches|=EXPORT_RECORD;
+   }
+   for(unsigned long i=0;i<columnnum;i++)
+   {
+      if(MatchesPath(columns[i].pathexpr,path))
+         return (unsigned char)(matches|PROJECTION_NEEDED|(i<<EXPORT_COLUMNSHIFT));
+   }
+   return matches;
+}
+
+void ColumnExporter::DecodeBlock(UncompressContainer *whitespacecont,UncompressContainer *specialcont,XMLEventSink *output)
+   // Collects the fields for the tokens of the current block
+   // A row is printed at the end of each record. White spaces and
+   // special sections are not part of the fields.
+{
+   unsigned long     *curtoken=tokens,*endtoken=tokens+tokennum;
+   unsigned long     depth;
+   long              id;
+   ProjectionPathNode   *node;
+   UncompressContainerBlock *contblock;
+   char              *ptr;
+   int               len,startlen;
+
+   while(curtoken<endtoken)
+   {
+      id=(long)(*curtoken&~PROJECTION_TEXTTOKEN);
+
+      if((*(curtoken++)&PROJECTION_TEXTTOKEN)==0)
+      {
+         switch(id)
+         {
+         case TREETOKEN_ENDLABEL:
+         case TREETOKEN_EMPTYENDLABEL:
+            depth=curpath.GetDepth();
+
+            if(depth==coldepth)
+            {
+               coldepth=0;
+               curcolumn=NULL;
+            }
+            if(depth==recorddepth)
+            {
+               PrintRow(output);
+               recorddepth=0;
+            }
+
+            inattrib=0;
+            curpath.RemoveLabel();
+            RemovePathNode();
+            break;
+
+         case TREETOKEN_WHITESPACE:
+         case TREETOKEN_ATTRIBWHITESPACE:
+         case TREETOKEN_SPECIAL:
+            break;
+
+         default: // A start label
+            id-=LABELIDX_TOKENOFFS;
+            curpath.AddLabel((TLabelID)id);
+            depth=curpath.GetDepth();
+
+            node=AddPathNode((TLabelID)id);
+            if(node->isattrib)
+               inattrib=1;
+
+            if(recorddepth==0)
+            {
+               if(recordpath!=NULL)
+               {
+                  if(node->matches&EXPORT_RECORD)
+                     recorddepth=depth;
+               }
+               else
+               {
+                  if((depth==EXPORT_RECORDDEPTH)&&(node->isattrib==0))
+                     recorddepth=depth;
+               }
+               // Outside of the records, there are no fields
+               if(recorddepth==0)
+                  break;
+            }
+
+            // Matching elements inside of a matching element
+            // only contribute their text
+            if((coldepth==0)&&(node->matches&PROJECTION_NEEDED))
+            {
+               coldepth=depth;
+               curcolumn=columns+(node->matches>>EXPORT_COLUMNSHIFT);
+
+               if(curcolumn->valuenum>0)
+                  curcolumn->valueoutput.StoreChar('|');
+               curcolumn->valuenum++;
+            }
+         }
+      }
+      else  // A text item
+      {
+         contblock=uncomprcont.GetContBlock(id);
+
+         // The values of attributes only belong to the attribute itself
+         // The fields contain the text without the XML escapes
+         if((coldepth>0)&&((inattrib==0)||(curpath.GetDepth()==coldepth)))
+         {
+            curcolumn->valueoutput.GetMemoryData(&startlen);
+            contblock->UncompressText(&curcolumn->valueoutput);
+            ptr=curcolumn->valueoutput.GetMemoryData(&len);
+            curcolumn->valueoutput.SetMemoryDataSize(startlen+UnescapeXMLText(ptr+startlen,len-startlen));
+         }
+         else
+         {
+            // Text items of needed container blocks must still
+            // be decompressed to advance the containers
+            if(contblock->IsSkipped()==0)
+               contblock->UncompressText(&nulloutput);
+         }
+      }
+   }
+}
@@ -0,0 +1,136 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements the export of compressed files into tables (option '-E').
+// Each path given with option '-E' is a column and each record is a row of the
+// table. The records are the elements matching the path of option '-Er' - or the
+// children of the root element, if the option is missing. The field of a column
+// contains the text of the element or attribute inside the record that matches
+// the path - if several elements match, then their texts are separated by '|'.
+// Elements inside a matching element only contribute their text.
+//
+// The table is printed as tab separated values (option '-Et', the default) or
+// as comma separated values (option '-Ec'). The first line contains the paths.
+//
+// The export is evaluated by the selective decompression: No XML is produced
+// and only the container blocks with text items inside the columns are
+// decompressed. The structure is only used to find the records and the
+// matching elements.
+
+#ifndef EXPORT_HPP
+#define EXPORT_HPP
+
+#include "Projection.hpp"
+
+// The formats of the table
+#define EXPORT_TSV   0  // Tab separated values
+#define EXPORT_CSV   1  // Comma separated values
+
+// The depth of the records, if there is no record path
+// - i.e. the children of the root element
+#define EXPORT_RECORDDEPTH 2
+
+// The match flag for the record elements (in addition to PROJECTION_NEEDED)
+#define EXPORT_RECORD      2
+
+// The column index of a path node is stored in the match flags
+// behind the flags above. Hence, the number of columns is limited.
+#define EXPORT_COLUMNSHIFT 2
+#define EXPORT_MAXCOLUMNS  63
+
+struct ExportColumn
+   // A single column of the table
+{
+   VPathExpr      *pathexpr;  // The path expression of the column
+   char           *pathstr;   // The path string (for the first line)
+   unsigned long  valuenum;   // The number of values in the current record
+   XMLOutput      valueoutput;// Keeps the field of the current record
+};
+
+class ColumnExporter : public SelectiveUncompressor
+{
+   ExportColumn   columns[EXPORT_MAXCOLUMNS];  // The columns
+   unsigned long  columnnum;
+
+   VPathExpr      *recordpath;   // The path of the records - or NULL
+
+   char           format;        // The format of the table (EXPORT_TSV or EXPORT_CSV)
+   char           isheaderprinted; // Is 1, if the first line has been printed
+
+   unsigned long  recorddepth;   // The depth of the record that is currently open - or 0
+   unsigned long  coldepth;      // The depth of the matching element or attribute that is
+                                 // currently open - or 0, if there is none
+   ExportColumn   *curcolumn;    // The column of that element or attribute
+   char           inattrib;      // Is 1, if we are inside of an attribute
+
+   XMLOutput      rowoutput;     // Keeps the current row
+
+   void StoreField(char *str,unsigned long len);
+      // Stores the field 'str' in the current row and quotes it, if necessary
+
+   void PrintHeader(XMLEventSink *output);
+      // Prints the first line with the paths of the columns
+
+   void PrintRow(XMLEventSink *output);
+      // Prints the fields of the current record and resets them
+
+   unsigned char ComputeMatches(CurPath *path);
+      // Checks whether the element or attribute at the end of 'path' matches a column
+
+   unsigned long GetNeededDepth()   {  return coldepth;  }
+
+   void DecodeBlock(UncompressContainer *whitespacecont,UncompressContainer *specialcont,XMLEventSink *output);
+      // Collects the fields for the tokens of the current block
+
+public:
+   ColumnExporter()
+   {
+      columnnum=0;
+      recordpath=NULL;
+      format=EXPORT_TSV;
+      coldepth=0;
+      curcolumn=NULL;
+   }
+
+   void AddColumn(char * &str,char *endptr);
+      // Adds the column for the path between 'str' and 'endptr'
+
+   void SetRecordPath(char * &str,char *endptr);
+      // Sets the path of the records between 'str' and 'endptr'
+
+   void SetFormat(char myformat)  {  format=myformat;  }
+      // Sets the format of the table
+
+   void StartFile();
+      // Initializes the export for the next file
+
+   void FinishFile(XMLEventSink *output);
+      // Prints the record that is still open
+      // (This can only happen if not all blocks were decompressed)
+};
+
+extern ColumnExporter columnexporter;
+
+#endif
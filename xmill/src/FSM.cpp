@@ -1804,11 +1804,18 @@ void FSMEdge::Store(MemStreamer *mem)
    }
 }
 
-void FSMEdge::Load(unsigned char * &ptr,FSMState *statearray,MemStreamer *fsmmem)
+char FSMEdge::Load(unsigned char * &ptr,unsigned char *endptr,FSMState *statearray,unsigned long statenum,MemStreamer *fsmmem)
 {
+   unsigned long stateidx;
+
    type=LoadUInt32(ptr);
 
-   nextstate=statearray+LoadUInt32(ptr);
+   // The index of the next state must be valid
+   stateidx=LoadUInt32(ptr);
+   if((type>EDGETYPE_EMPTY)||(stateidx>=statenum)||(ptr>endptr))
+      return 0;
+
+   nextstate=statearray+stateidx;
 
    switch(type)
    {
@@ -1823,6 +1830,10 @@ void FSMEdge::Load(unsigned char * &ptr,FSMState *statearray,MemStreamer *fsmmem
       
       labelcount=LoadUInt32(ptr);
 
+      // Each label needs at least one byte
+      if((ptr>endptr)||(labelcount>(unsigned long)(endptr-ptr)))
+         return 0;
+
       while(labelcount--)
       {
          *labelref=new(fsmmem) FSMLabel((unsigned short)LoadUInt32(ptr));
@@ -1831,6 +1842,7 @@ void FSMEdge::Load(unsigned char * &ptr,FSMState *statearray,MemStreamer *fsmmem
       *labelref=NULL;
    }
    }
+   return (ptr<=endptr) ? 1 : 0;
 }
 
 //*********************************************************************
@@ -1838,8 +1850,9 @@ void FSMEdge::Load(unsigned char * &ptr,FSMState *statearray,MemStreamer *fsmmem
 
 void FSMState::Store(MemStreamer *mem)
 {
-   // We store whether the state is final
-   mem->StoreUInt32(isfinal);
+   // We store whether the state is final, accepting, out-complete,
+   // and has pounds ahead
+   mem->StoreUInt32(isfinal|(isaccepting<<1)|(isoutcomplete<<2)|(haspoundsahead<<3));
 
    // Let's count the number of outgoing edges
 
@@ -1864,12 +1877,17 @@ void FSMState::Store(MemStreamer *mem)
    }
 }
 
-void FSMState::Load(unsigned char * &ptr,FSMState *statearray,MemStreamer *fsmmem)
+char FSMState::Load(unsigned char * &ptr,unsigned char *endptr,FSMState *statearray,unsigned long statenum,MemStreamer *fsmmem)
 {
    unsigned long edgecount;
 
-   // We load the status bit
-   isfinal=LoadUInt32(ptr);
+   // We load the status bits
+   unsigned long flags=LoadUInt32(ptr);
+
+   isfinal=flags&1;
+   isaccepting=(flags>>1)&1;
+   isoutcomplete=(flags>>2)&1;
+   haspoundsahead=(flags>>3)&1;
 
    FSMEdge  **edgeref =&outedges;
 
@@ -1877,15 +1895,21 @@ void FSMState::Load(unsigned char * &ptr,FSMState *statearray,MemStreamer *fsmme
 
    edgecount=LoadUInt32(ptr);
 
+   // Each edge needs at least two bytes
+   if((ptr>endptr)||(edgecount>(unsigned long)(endptr-ptr)/2))
+      return 0;
+
    // We load all edges
    while(edgecount--)
    {
       *edgeref=new(fsmmem) FSMEdge();
 
-      (*edgeref)->Load(ptr,statearray,fsmmem);
+      if((*edgeref)->Load(ptr,endptr,statearray,statenum,fsmmem)==0)
+         return 0;
       edgeref=&((*edgeref)->next);
    }
    *edgeref=NULL;
+   return 1;
 }
 
 //*********************************************************************
@@ -1909,7 +1933,7 @@ void FSM::Store(MemStreamer *mem)
    }
 }
 
-void FSM::Load(unsigned char * &ptr,MemStreamer *fsmmem)
+char FSM::Load(unsigned char * &ptr,unsigned char *endptr,MemStreamer *fsmmem)
 {
    // We load the number of states
    curidx=LoadUInt32(ptr);
@@ -1918,6 +1942,11 @@ void FSM::Load(unsigned char * &ptr,MemStreamer *fsmmem)
 
    startstateidx=LoadUInt32(ptr);
 
+   // The start state must exist and each state needs at least two bytes
+   if((ptr>endptr)||(startstateidx>=curidx)||
+      (curidx>(unsigned long)(endptr-ptr)/2))
+      return 0;
+
    FSMState **stateref=&statelist;
    FSMState *statearray=new(fsmmem) FSMState[curidx];
 
@@ -1928,13 +1957,17 @@ void FSM::Load(unsigned char * &ptr,MemStreamer *fsmmem)
       (*stateref)->next=NULL;
       (*stateref)->origstateset=NULL;
 
-      (*stateref)->Load(ptr,statearray,fsmmem);
+      if((*stateref)->Load(ptr,endptr,statearray,curidx,fsmmem)==0)
+         return 0;
 
       stateref=&((*stateref)->next);
    }
    *stateref=NULL;
+   laststatelistref=stateref;
 
    startstate=statearray+startstateidx;
+   isdeterministic=1;
+   return 1;
 }
 
 #endif // FSM_STORE
@@ -38,7 +38,7 @@ History:
 
 #define FSM_NEGATE    // Enables Negation of FSMs
 //#define FSM_PRINT     // Enables Print-functions for FSMs
-//#define FSM_STORE     // Enables Store/Load functions for FSMs
+#define FSM_STORE     // Enables Store/Load functions for FSMs
 
 // We distinguish three types of edges:
 
@@ -167,8 +167,9 @@ public:
    void Store(MemStreamer *mem); // Stores the state and the outgoing edges
                                  // in memstreamer 'mem'
 
-   void Load(unsigned char * &ptr,FSMState *statearray,MemStreamer *fsmmem);
+   char Load(unsigned char * &ptr,unsigned char *endptr,FSMState *statearray,unsigned long statenum,MemStreamer *fsmmem);
       // Initializes the state and loads the outgoing edges from the data in 'ptr'
+      // Returns 0, if the data is corrupt
 #endif
 };
 
@@ -219,8 +220,10 @@ public:
 #endif
 #ifdef FSM_STORE
    void Store(MemStreamer *mem); // Stores the edge in memstreamer 'mem'
-   void Load(unsigned char * &ptr,FSMState *statearray,MemStreamer *fsmmem);
+   char Load(unsigned char * &ptr,unsigned char *endptr,FSMState *statearray,unsigned long statenum,MemStreamer *fsmmem);
       // Loads the edge information from the data in 'ptr'
+      // The target state must be one of the 'statenum' states in 'statearray'
+      // Returns 0, if the data is corrupt
 #endif
 };
 
@@ -324,7 +327,9 @@ public:
 #endif
 #ifdef FSM_STORE
    void Store(MemStreamer *mem);
-   void Load(unsigned char * &ptr,MemStreamer *fsmmem);
+   char Load(unsigned char * &ptr,unsigned char *endptr,MemStreamer *fsmmem);
+      // Loads the FSM from the data between 'ptr' and 'endptr'
+      // Returns 0, if the data is corrupt
 #endif
 //************
 /*
@@ -37,18 +37,54 @@ History:
 #ifdef WIN32
 #include <fcntl.h>
 #include <io.h>
+#else
+#include <unistd.h>
+#include <poll.h>
 #endif
 
 #include "Error.hpp"
+#include "Types.hpp"
 extern int errno;
 
+inline int SeekFile(FILE *file,TFilePos pos)
+   // Moves to position 'pos' of 'file' - returns 0, if okay
+   // The position can be larger than 2GB
+{
+#ifdef WIN32
+   return _fseeki64(file,pos,SEEK_SET);
+#else
+   return fseeko(file,pos,SEEK_SET);
+#endif
+}
+
+inline TFilePos TellFile(FILE *file)
+   // Returns the current position in 'file' or -1, if an error occurred
+{
+#ifdef WIN32
+   return _ftelli64(file);
+#else
+   return ftello(file);
+#endif
+}
+
+class InputSource
+   // A source of input data other than a file - for example
+   // the data chunks that are pushed into the parser (see PushParse.hpp)
+{
+public:
+   virtual unsigned ReadData(char *dest,unsigned bytecount)=0;
+      // Copies at most 'bytecount' bytes into 'dest' and returns the number
+      // of bytes. The function returns 0 only at the end of the data.
+};
+
 class CFile
 {
    FILE  *file;         // The file handle
    char  *savefilename; // We save the file name
+   InputSource *source; // The data source, if the data is not read from a file
 
 protected:
-   unsigned filepos;    // Current file position
+   TFilePos filepos;    // Current file position
    char     iseof;      // Did we reach the end of the file?
 
 
@@ -57,6 +93,7 @@ public:
    CFile()
    {
       file=NULL;
+      source=NULL;
    }
   
    char OpenFile(char *filename)
@@ -82,14 +119,50 @@ public:
       }
       filepos=0;
       iseof=0;
+      source=NULL;
 
       savefilename=filename;
       return 1;
    }
 
-   unsigned GetFilePos()  { return filepos;}
+   char OpenSource(InputSource *mysource)
+      // Reads the data from 'mysource' instead of a file
+   {
+      file=NULL;
+      source=mysource;
+      filepos=0;
+      iseof=0;
+
+      savefilename=NULL;
+      return 1;
+   }
+
+   TFilePos GetFilePos()  { return filepos;}
       // Returns the current position in the file
 
+   char SetFilePos(TFilePos pos)
+      // Moves to position 'pos' in the file
+      // Returns 1, if okay, otherwise 0 (e.g. for the standard input)
+   {
+      if(SeekFile(file,pos)!=0)
+         return 0;
+      filepos=pos;
+      iseof=0;
+      return 1;
+   }
+
+   TFilePos GetFileSize()
+      // Returns the size of the file
+      // The current position is not changed
+   {
+      TFilePos savepos=TellFile(file),size;
+
+      fseek(file,0,SEEK_END);
+      size=TellFile(file);
+      SeekFile(file,savepos);
+      return (size>0) ? size : 0;
+   }
+
    unsigned ReadBlock(char *dest,unsigned bytecount)
       // Reads a data block into the memory at 'dest'. The maximum size is 'bytecount'
       // The function returns the number of bytes read or -1, if something fails
@@ -99,6 +172,25 @@ public:
       if(iseof)
          return 0;
 
+      if(source!=NULL)
+         // We read from the source until we have 'bytecount' bytes
+      {
+         unsigned bytesread=0,len;
+
+         while(bytesread<bytecount)
+         {
+            len=source->ReadData(dest+bytesread,bytecount-bytesread);
+            if(len==0)
+            {
+               iseof=1;
+               break;
+            }
+            bytesread+=len;
+         }
+         filepos+=bytesread;
+         return bytesread;
+      }
+
       // let's try to reach 'bytecount' bytes
       unsigned bytesread=(unsigned)fread(dest,1,bytecount,file);
 
@@ -125,9 +217,80 @@ public:
       return bytesread;
    }
 
+   unsigned ReadAvailableBlock(char *dest,unsigned bytecount)
+      // Reads a data block of at most 'bytecount' bytes into the memory at 'dest'.
+      // For the standard input, the function does not wait until 'bytecount'
+      // bytes have arrived, but returns the data that is available. This is needed
+      // for live data streams (see option '-F'). The end of the file is only reached
+      // if no more data can be read.
+   {
+      if(source!=NULL)
+         // A source also returns the data that is available
+      {
+         unsigned bytesread;
+
+         if(iseof)
+            return 0;
+
+         bytesread=source->ReadData(dest,bytecount);
+         if(bytesread==0)
+            iseof=1;
+
+         filepos+=bytesread;
+         return bytesread;
+      }
+#ifndef WIN32
+      if(file==stdin)
+      {
+         int bytesread;
+
+         if(iseof)
+            return 0;
+
+         bytesread=read(fileno(file),dest,bytecount);
+         if(bytesread<0)
+         {
+            char tmpstr[100];
+            sprintf(tmpstr,"Could not read from standard input (Error %lu)!",errno);
+            Error(tmpstr);
+            Exit();
+         }
+         if(bytesread==0)
+            iseof=1;
+
+         filepos+=bytesread;
+         return (unsigned)bytesread;
+      }
+#endif
+      return ReadBlock(dest,bytecount);
+   }
+
+   char WaitForInput(unsigned long millisec)
+      // Waits at most 'millisec' milliseconds until more data of the standard
+      // input can be read. Returns 0, if no data arrived in time.
+      // For files and sources, the function returns 1 immediately.
+   {
+#ifndef WIN32
+      if((source==NULL)&&(file==stdin)&&(iseof==0))
+      {
+         struct pollfd  pfd;
+
+         pfd.fd=fileno(file);
+         pfd.events=POLLIN;
+         pfd.revents=0;
+
+         if(poll(&pfd,1,(int)millisec)==0)
+            return 0;
+      }
+#endif
+      return 1;
+   }
+
    void CloseFile()
       // Closes the file
    {
+      source=NULL;
+
       if((file==NULL)||(file==stdout))
          return;
 
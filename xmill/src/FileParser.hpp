@@ -47,6 +47,14 @@ public:
       return Input::OpenFile(filename);
    }
 
+   char OpenSource(InputSource *mysource)
+      // Reads the data from 'mysource' and fills the buffer
+   {
+      curlineno=1;
+
+      return Input::OpenSource(mysource);
+   }
+
    unsigned GetCurLineNo() {  return curlineno; }
 
    char ReadStringUntil(char **destptr,int *destlen,char stopatwspace,char c1,char c2)
@@ -61,7 +69,7 @@ public:
    // and returns 0.
    {
       char *curptr,*ptr;
-      int  len,i;
+      int  len,i,scannedlen;
 
       // Let's get as much as possible from the input buffer
       len=GetCurBlockPtr(&ptr);
@@ -96,41 +104,50 @@ public:
       }
 
       // We couldn't find characters --> Try to refill
+      // The standard input or a data source (see PushParse.hpp) might deliver
+      // only small pieces of data. Since labels should not be split, we refill
+      // until we find the character or the buffer is full.
 
-      RefillAndGetCurBlockPtr(&ptr,&len);
-
-      curptr=ptr;
+      scannedlen=len;
 
-      i=len;
+      do
+      {
+         RefillAndGetCurBlockPtr(&ptr,&len);
 
-      // Now we try the same thing again:
+         // Now we try the same thing again for the new data:
+         curptr=ptr+scannedlen;
 
-      // We search for characters 'c1', 'c2', ' ', '\t' ...
-      // If we find such a character, then we store the pointer in 'destptr'
-      // and the length in 'destlen' and exit.
-      while(i!=0)
-      {
-         if(*curptr=='\n')
-            curlineno++;
+         i=len-scannedlen;
 
-         if((*curptr==c1)||(*curptr==c2))
+         // We search for characters 'c1', 'c2', ' ', '\t' ...
+         // If we find such a character, then we store the pointer in 'destptr'
+         // and the length in 'destlen' and exit.
+         while(i!=0)
          {
+            if(*curptr=='\n')
+               curlineno++;
+
+            if((*curptr==c1)||(*curptr==c2))
+            {
+               curptr++;
+               *destptr=ptr;
+               *destlen=curptr-ptr;
+               FastSkipData(*destlen);
+               return 1;
+            }
+            if((stopatwspace)&&((*curptr==' ')||(*curptr=='\t')||(*curptr=='\r')||(*curptr=='\n')))
+            {
+               *destptr=ptr;
+               *destlen=curptr-ptr;
+               FastSkipData(*destlen);
+               return 1;
+            }
             curptr++;
-            *destptr=ptr;
-            *destlen=curptr-ptr;
-            FastSkipData(*destlen);
-            return 1;
-         }
-         if((stopatwspace)&&((*curptr==' ')||(*curptr=='\t')||(*curptr=='\r')||(*curptr=='\n')))
-         {
-            *destptr=ptr;
-            *destlen=curptr-ptr;
-            FastSkipData(*destlen);
-            return 1;
+            i--;
          }
-         curptr++;
-         i--;
+         scannedlen=len;
       }
+      while((len<FILEBUF_SIZE)&&(iseof==0));
 
       *destptr=ptr;
       *destlen=len;
@@ -148,7 +165,7 @@ public:
       // and returns 0.
    {
       char *curptr,*ptr;
-      int  len,i;
+      int  len,i,scannedlen;
 
       len=GetCurBlockPtr(&ptr);
       curptr=ptr;
@@ -175,32 +192,41 @@ public:
       }
 
       // We couldn't find characters --> Try to refill
+      // As for labels, we refill until we find the character or the buffer
+      // is full, so that texts arriving in small pieces are not split up.
 
-      RefillAndGetCurBlockPtr(&ptr,&len);
-      curptr=ptr;
+      scannedlen=len;
 
-      i=len;
+      do
+      {
+         RefillAndGetCurBlockPtr(&ptr,&len);
 
-      // Now we try the same thing again:
+         // Now we try the same thing again for the new data:
+         curptr=ptr+scannedlen;
 
-      // We search for character 'c1'.
-      // If we find such a character, then we store the pointer in 'destptr'
-      // and the length in 'destlen' and exit.
-      while(i!=0)
-      {
-         if(*curptr==c1)
+         i=len-scannedlen;
+
+         // We search for character 'c1'.
+         // If we find such a character, then we store the pointer in 'destptr'
+         // and the length in 'destlen' and exit.
+         while(i!=0)
          {
+            if(*curptr==c1)
+            {
+               curptr++;
+               *destptr=ptr;
+               *destlen=curptr-ptr;
+               FastSkipData(*destlen);
+               return 1;
+            }
+            if(*curptr=='\n')
+               curlineno++;
             curptr++;
-            *destptr=ptr;
-            *destlen=curptr-ptr;
-            FastSkipData(*destlen);
-            return 1;
+            i--;
          }
-         if(*curptr=='\n')
-            curlineno++;
-         curptr++;
-         i--;
+         scannedlen=len;
       }
+      while((len<FILEBUF_SIZE)&&(iseof==0));
 
       *destptr=ptr;
       *destlen=len;
@@ -218,7 +244,7 @@ public:
       // and returns 1. Otherwise, 
    {
       char *curptr,*ptr;
-      int  len,i;
+      int  len,i,scannedlen;
 
       len=GetCurBlockPtr(&ptr);
       curptr=ptr;
@@ -245,32 +271,40 @@ public:
       }
 
       // We couldn't find characters --> Try to refill
+      // We refill until we find a non-white-space or the buffer is full
 
-      RefillAndGetCurBlockPtr(&ptr,&len);
-      curptr=ptr;
+      scannedlen=len;
 
-      i=len;
+      do
+      {
+         RefillAndGetCurBlockPtr(&ptr,&len);
 
-      // Now we try the same thing again:
+         // Now we try the same thing again for the new data:
+         curptr=ptr+scannedlen;
 
-      // We search for non-white-space characters
-      // If we find such a character, then we store the pointer in 'destptr'
-      // and the length in 'destlen' and exit.
-      while(i!=0)
-      {
-         if((*curptr!=' ')&&(*curptr!='\t')&&(*curptr!='\r')&&(*curptr!='\n'))
-            // No white space?
+         i=len-scannedlen;
+
+         // We search for non-white-space characters
+         // If we find such a character, then we store the pointer in 'destptr'
+         // and the length in 'destlen' and exit.
+         while(i!=0)
          {
-            *destptr=ptr;
-            *destlen=curptr-ptr;
-            FastSkipData(*destlen);
-            return 1;
+            if((*curptr!=' ')&&(*curptr!='\t')&&(*curptr!='\r')&&(*curptr!='\n'))
+               // No white space?
+            {
+               *destptr=ptr;
+               *destlen=curptr-ptr;
+               FastSkipData(*destlen);
+               return 1;
+            }
+            if(*curptr=='\n')
+               curlineno++;
+            curptr++;
+            i--;
          }
-         if(*curptr=='\n')
-            curlineno++;
-         curptr++;
-         i--;
+         scannedlen=len;
       }
+      while((len<FILEBUF_SIZE)&&(iseof==0));
 
       // We look through the entire buffer and couldn't find a non-white-space
       // character?
@@ -50,7 +50,7 @@ History:
 
 // A macro for refilling the buffer to *at least* 'mylen' characters
 // If there are not enough characters in the file, then the program exits
-#define FillBufLen(mylen)  if(endptr-curptr<(mylen))  { FillBuf(); if(endptr-curptr<(mylen)) {Error("Unexpected end of file!");Exit();}}
+#define FillBufLen(mylen)  if(endptr-curptr<(mylen))  { do FillBuf(); while((endptr-curptr<(mylen))&&(iseof==0)); if(endptr-curptr<(mylen)) {Error("Unexpected end of file!");Exit();}}
 
 class Input : public CFile
 {
@@ -82,7 +82,7 @@ public:
          curptr=endptr=databuf;
 
       // We try to fill the rest of the buffer
-      bytesread=ReadBlock(endptr,databuf+FILEBUF_SIZE-endptr);
+      bytesread=ReadAvailableBlock(endptr,databuf+FILEBUF_SIZE-endptr);
 
       endptr+=bytesread;
    }
@@ -102,6 +102,33 @@ public:
       return 1;
    }
 
+   char OpenSource(InputSource *mysource)
+      // Reads the data from 'mysource' and fills the buffer
+   {
+      CFile::OpenSource(mysource);
+
+      curptr=endptr=databuf;
+
+      FillBuf();
+
+      curlineno=1;
+
+      return 1;
+   }
+
+   char SetFilePos(TFilePos pos)
+      // Moves to position 'pos' in the file and refills the buffer
+      // Returns 1, if okay, otherwise 0
+   {
+      if(CFile::SetFilePos(pos)==0)
+         return 0;
+
+      curptr=endptr=databuf;
+
+      FillBuf();
+      return 1;
+   }
+
    char ReadData(char *dest,int len)
       // Reads 'len' characters into the buffer 'dest'
       // If the data is already in memory, we simply copy
@@ -229,6 +256,25 @@ public:
       curptr+=len;
    }
 
+   char SeekData(unsigned long len)
+      // Skips 'len' characters. If the data is not in the buffer,
+      // then we move the file position instead of reading the data
+      // Returns 1, if okay, otherwise 0 (e.g. for the standard input)
+   {
+      if((unsigned long)(endptr-curptr)>=len)
+      {
+         curptr+=len;
+         return 1;
+      }
+      return SetFilePos(GetFilePos()+len-(endptr-curptr));
+   }
+
+   TFilePos GetDataPos()
+      // Returns the file position of the next character to be read
+   {
+      return GetFilePos()-(endptr-curptr);
+   }
+
    void FastSkipData(int len)
       // Does a fast skip - the data is already expected to be in the buffer
    {
@@ -250,6 +296,31 @@ public:
       return (curptr+len==endptr)&&(iseof);
    }
 
+   char IsEndOfData()
+      // Checks whether we reached the end of the file
+      // If the buffer is empty, we first try to read more data, since
+      // the data of the standard input might simply not have arrived yet
+   {
+      if((curptr==endptr)&&(iseof==0))
+         FillBuf();
+      return (curptr==endptr)&&(iseof);
+   }
+
+   char WaitForData(unsigned long millisec)
+      // Waits at most 'millisec' milliseconds until more than white spaces
+      // can be read. Returns 0, if no data arrived in time.
+      // The data is not read, so that the buffer is not changed.
+   {
+      char *ptr;
+
+      for(ptr=curptr;ptr<endptr;ptr++)
+      {
+         if((*ptr!=' ')&&(*ptr!='\t')&&(*ptr!='\r')&&(*ptr!='\n'))
+            return 1;
+      }
+      return WaitForInput(millisec);
+   }
+
    int GetCurBlockPtr(char **ptr)
       // Returns the length of rest of data in the buffer and
       // stores the data pointer in *ptr
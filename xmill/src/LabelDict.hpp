@@ -90,7 +90,9 @@ struct CompressLabelDictItem
 
 
 // For the decompressor, the label dictionary is implemented through a
-// lookup table. New entries can be added through the decompressor runs
+// lookup table. New entries can be added through the decompressor runs.
+// The label ID is the index into the table, so that the decoder
+// can find the name of a label without any search.
 
 struct UncompressLabelDictItem
    // Each label is represented in this structure
@@ -100,22 +102,6 @@ struct UncompressLabelDictItem
    char              *strptr;    // The pointer to the actual string
 };
 
-struct UncompressLabelDict
-   // Represents a sequence of labels.
-   // The labels are stored in 'UncompressLabelDictItem'-objects directly
-   // after the 'UncompressLabelDict'-object.
-{
-   TLabelID                labelnum;   // The number of labels in this sequence 
-   UncompressLabelDict     *next;      // The next label sequence
-
-   UncompressLabelDictItem* GetArrayPtr()
-      // Returns the pointer to the UncompressLabelDictItem
-   {
-      return (UncompressLabelDictItem *)(this+1);
-   }
-};
-
-
 //******************************************************************************
 
 class LabelDict
@@ -138,8 +124,9 @@ class LabelDict
 
 
 
-   UncompressLabelDict        *labeldictlist;      // The list of label groups
-   UncompressLabelDict        *lastlabeldict;      // The last label group
+   UncompressLabelDictItem    *labelarray;         // The lookup table of the decompressor
+   TLabelID                   uncompresslabelnum;  // The number of labels in the table
+   unsigned long              maxuncompresslabelnum;
 
 
 public:
@@ -177,8 +164,10 @@ public:
 
 
       // No labels until now
-      labeldictlist=NULL;
-      lastlabeldict=NULL;
+      // The lookup table is allocated with the first labels
+      labelarray=NULL;
+      uncompresslabelnum=0;
+      maxuncompresslabelnum=0;
 
    }
 
@@ -196,8 +185,9 @@ public:
          hashtableref=hashtable+i;
          while(*hashtableref!=NULL)
          {
-            if((*hashtableref)->labelid>=predefinedlabelnum)
+            if(((*hashtableref)->labelid&(ATTRIBLABEL_STARTIDX-1))>=predefinedlabelnum)
                // Not a predefined label ID?
+               // (Attribute labels have the attribute bit set)
                // ==> Delete
                *hashtableref=(*hashtableref)->nextsamehash;
             else
@@ -210,8 +200,8 @@ public:
       // We keep the first 'predefinedlabelnum' predefined labels.
       CompressLabelDictItem **curlabelref=&labels;
 
-      //for(labelid=0;labelid<predefinedlabelnum;labelid++)//--commented by wujun 2013.5.6 
-      //   curlabelref=&((*curlabelref)->next);
+      for(labelid=0;(labelid<predefinedlabelnum)&&(*curlabelref!=NULL);labelid++)
+         curlabelref=&((*curlabelref)->next);
 
       *curlabelref=NULL;
 
@@ -222,11 +212,9 @@ public:
       savedlabelnum=0;
       savedlabelref=&labels;
 
-
-      // No labels until now
-      labelnum=0;
-      labeldictlist=NULL;
-      lastlabeldict=NULL;
+      // No labels for the uncompressor until now
+      // We keep the memory of the lookup table for the next file
+      uncompresslabelnum=0;
 
    }
 
@@ -349,6 +337,61 @@ public:
       savedlabelnum=labelnum;
    }
 
+   TLabelID GetSavedLabelNum()   {  return savedlabelnum;   }
+      // Returns the number of labels that have already been stored
+
+   void StoreAll(MemStreamer *mem)
+      // Stores all labels in 'mem' - the format is the same as for 'Store'
+   {
+      CompressLabelDictItem *item=labels;
+
+      mem->StoreUInt32(labelnum);
+
+      while(item!=NULL)
+      {
+         mem->StoreSInt32((item->labelid&ATTRIBLABEL_STARTIDX)?1:0,item->GetLabelLen());
+         mem->StoreData(item->GetLabelPtr(),item->GetLabelLen());
+         item=item->next;
+      }
+   }
+
+   char LoadStoredLabels(SmallBlockUncompressor *uncompress)
+      // Loads the labels stored with 'StoreAll' into the dictionary
+      // of the compressor. This is used for appending to an existing file.
+      // The predefined labels must be the first labels of the stored
+      // dictionary - otherwise, 0 is returned.
+      // The loaded labels count as already stored.
+   {
+      unsigned long  mylabelnum=uncompress->LoadUInt32(),i;
+      unsigned       len;
+      char           isattrib,*ptr;
+
+      if(mylabelnum>MAXLABEL_NUM)
+         ExitCorruptFile();
+
+      if(mylabelnum<labelnum)
+         return 0;
+
+      for(i=0;i<mylabelnum;i++)
+      {
+         len=uncompress->LoadSInt32(&isattrib);
+         ptr=(char *)uncompress->LoadData(len);
+
+         if(i<labelnum)
+            // A predefined label must have the same ID
+         {
+            if((FindLabelOrAttrib(ptr,len,isattrib)&(ATTRIBLABEL_STARTIDX-1))!=i)
+               return 0;
+         }
+         else
+            CreateLabelOrAttrib(ptr,len,isattrib);
+      }
+
+      savedlabelnum=labelnum;
+      savedlabelref=labelref;
+      return 1;
+   }
+
 
 //**********************************************************************************
 //**********************************************************************************
@@ -356,7 +399,7 @@ public:
 
 
 
-#define LABELDICT_MINLABELNUM 32
+#define LABELDICT_MINLABELNUM 64
 
 // ************** These are functions for the uncompressor ****************************
 
@@ -364,82 +407,52 @@ public:
       // Loads the next block of labels and appends the block to the
       // already existing blocks in the dictionary
    {
-      UncompressLabelDictItem *dictitemptr;
-      char                    isattrib;
-      unsigned                dictlabelnum;
-
       // Let's get the number of labels first
       unsigned mylabelnum=uncompress->LoadUInt32();
       if(mylabelnum>MAXLABEL_NUM)
          ExitCorruptFile();
 
+      LoadLabels(uncompress,mylabelnum);
+   }
+
+   void LoadLabels(SmallBlockUncompressor *uncompress,unsigned mylabelnum)
+      // Loads 'mylabelnum' labels and appends them to the
+      // lookup table of the labels
+   {
+      UncompressLabelDictItem *dictitemptr;
+      char                    isattrib;
+
       // No new labels?
       if(mylabelnum==0)
          return;
 
-      if(lastlabeldict!=NULL)
-         // We already have some labels in the dictionary?
-      {
-         if(lastlabeldict->labelnum<LABELDICT_MINLABELNUM)
-            // Is there some space for more labels in the current block?
-            // We copy as many labels as we can
-         {
-            dictlabelnum=LABELDICT_MINLABELNUM-lastlabeldict->labelnum;
-            if(dictlabelnum>mylabelnum)
-               dictlabelnum=mylabelnum;
-
-            mylabelnum-=dictlabelnum;
-
-            dictitemptr=lastlabeldict->GetArrayPtr()+lastlabeldict->labelnum;
-
-            lastlabeldict->labelnum+=dictlabelnum;
-            labelnum+=dictlabelnum;
-
-            // We copy the actual labels now
-            // Each label is represented by the length and the attribute-flag
-            // Then, the actual name follows
-            while(dictlabelnum--)
-            {
-               dictitemptr->len=(unsigned short)uncompress->LoadSInt32(&isattrib);
-               dictitemptr->isattrib=isattrib;
-
-               dictitemptr->strptr=mainmem.GetByteBlock(dictitemptr->len);
-
-               mymemcpy(dictitemptr->strptr,
-                        uncompress->LoadData(dictitemptr->len),
-                        dictitemptr->len);
+      if(uncompresslabelnum+mylabelnum>MAXLABEL_NUM)
+         ExitCorruptFile();
 
-               dictitemptr++;
-            }
-            if(mylabelnum==0)
-               return;
-         }
-         // We create a new label block for the new labels
-         lastlabeldict->next=(UncompressLabelDict *)mainmem.GetByteBlock(
-                                 sizeof(UncompressLabelDict)+
-                                 ((mylabelnum>LABELDICT_MINLABELNUM)? mylabelnum : LABELDICT_MINLABELNUM)*sizeof(UncompressLabelDictItem));
-         lastlabeldict=lastlabeldict->next;
+      if(uncompresslabelnum+mylabelnum>maxuncompresslabelnum)
+         // We enlarge the lookup table
+      {
+         maxuncompresslabelnum=maxuncompresslabelnum*2;
+         if(maxuncompresslabelnum<uncompresslabelnum+mylabelnum)
+            maxuncompresslabelnum=uncompresslabelnum+mylabelnum;
+         if(maxuncompresslabelnum<LABELDICT_MINLABELNUM)
+            maxuncompresslabelnum=LABELDICT_MINLABELNUM;
+
+         dictitemptr=(UncompressLabelDictItem *)realloc(labelarray,maxuncompresslabelnum*sizeof(UncompressLabelDictItem));
+         if(dictitemptr==NULL)
+            ExitNoMem();
+         labelarray=dictitemptr;
       }
-      else
-         labeldictlist=lastlabeldict=(UncompressLabelDict *)mainmem.GetByteBlock(
-                                       sizeof(UncompressLabelDict)+
-                                       ((mylabelnum>LABELDICT_MINLABELNUM)? mylabelnum : LABELDICT_MINLABELNUM)*sizeof(UncompressLabelDictItem));
 
-      lastlabeldict->next=NULL;
+      dictitemptr=labelarray+uncompresslabelnum;
 
-//******
-
-      lastlabeldict->labelnum=mylabelnum;
+      uncompresslabelnum+=mylabelnum;
       labelnum+=mylabelnum;
 
-      dictlabelnum=mylabelnum;
-
-      dictitemptr=lastlabeldict->GetArrayPtr();
-
       // We copy the actual labels now
       // Each label is represented by the length and the attribute-flag
       // Then, the actual name follows
-      while(dictlabelnum--)
+      while(mylabelnum--)
       {
          dictitemptr->len=(unsigned short)uncompress->LoadSInt32(&isattrib);
          dictitemptr->isattrib=isattrib;
@@ -458,21 +471,22 @@ public:
    unsigned long LookupLabel(TLabelID labelid,char **ptr,unsigned char *isattrib)
       // Find the name of the label with a given ID
    {
-      UncompressLabelDict *labeldict=labeldictlist;
+      if(labelid>=uncompresslabelnum)
+         ExitCorruptFile();
 
-      // We look through all the blocks
-      while(labelid>=labeldict->labelnum)
-      {
-         labelid-=labeldict->labelnum;
-         labeldict=labeldict->next;
-      }
-      UncompressLabelDictItem *item=labeldict->GetArrayPtr()+labelid;
+      UncompressLabelDictItem *item=labelarray+labelid;
 
       *isattrib=item->isattrib;
       *ptr=item->strptr;
       return item->len;
    }
 
+   UncompressLabelDictItem *GetLabelArray()  {  return labelarray;  }
+      // Returns the lookup table of the decompressor
+
+   TLabelID GetUncompressLabelNum()  {  return uncompresslabelnum;   }
+      // Returns the number of labels in the lookup table
+
 
 //**********************************************************************************
 //**********************************************************************************
@@ -59,12 +59,28 @@ History:
 #include "XMLOutput.hpp"
 #include "SmallUncompress.hpp"
 #include "UnCompCont.hpp"
+#include "StructCoder.hpp"
+#include "BlockIndex.hpp"
+#include "Projection.hpp"
+#include "Document.hpp"
+#include "Record.hpp"
+#include "ParDecode.hpp"
+#include "Server.hpp"
 
 
 #define MAGIC_KEY 0x5e3d29e
    // The uncompressed first block of an XMill file 
    // must start with these bytes
 
+#define MAGIC_KEY_EXT 0x5e3d29f
+   // Files that use one of the extensions below start with
+   // this key instead. The key is followed by the file flags.
+
+#define FILEFLAG_STRUCTCODER  1  // The structure is encoded with the structure coder
+#define FILEFLAG_BITPACK      2  // The integer compressors use bit-packed frames
+#define FILEFLAG_BLOCKINDEX   4  // The file has a block index at the end
+#define FILEFLAG_ALL          (FILEFLAG_STRUCTCODER|FILEFLAG_BITPACK|FILEFLAG_BLOCKINDEX)
+
 CurPath           curpath;          // The current path in the XML document
 LabelDict         globallabeldict;  // The label dictionary
 
@@ -125,6 +141,18 @@ extern char verbose;
 extern char output_initialized;
 extern char delete_inputfiles;
 extern unsigned long memory_cutoff;
+extern char use_structcoder;
+extern char use_bitpack;
+extern char use_blockindex;
+extern char *append_archive;
+extern char *fsmcache_file;
+extern unsigned long decode_firstblock,decode_lastblock;
+extern unsigned long decode_document;
+extern char lowmemory_decode;
+extern unsigned long flush_interval,flush_records;
+extern unsigned long syncpoint_interval;
+extern unsigned long decode_firstrecord,decode_lastrecord;
+extern char *multidoc_archive;
 
 //**********************************
 
@@ -146,6 +174,8 @@ void InitSpecialContainerSizeSum(); // Resets the accumulate size for special co
 void PrintSpecialContainerSizeSum();// Prints the accumulate size for special containers
 
 void Compress(char *srcfile,char *destfile);
+void AddDocumentFile(char *srcfile);
+void CompressDocumentFiles();
 
 
 
@@ -167,6 +197,23 @@ void HandleSingleFile(char *file,int handleType)
    // Most importantly, the name of the destination file is
    // determines by modifying/adding/removing extensions '.xml', '.xmi', '.xm'
 {
+   if(strcmp(file,"-")==0)
+      // The standard input is (de)compressed to the standard output
+   {
+      try{
+         if(handleType==0)
+            Compress(NULL,NULL);
+         else
+            Uncompress(NULL,NULL);
+      }
+      catch(XMillException *)
+      {
+         Error("Error in the standard input:");
+         PrintErrorMsg();
+      }
+      return;
+   }
+
    int len=strlen(file);
    char  *outfilename= new char[len+5];
       // We use the space after the input file 
@@ -186,7 +233,22 @@ void HandleSingleFile(char *file,int handleType)
 		   else
 			  strcat(outfilename,".xm");
 
-		   Compress(file,usestdout ? NULL : outfilename);
+		   if(multidoc_archive!=NULL)
+			  // All files are compressed together after the last file
+			  AddDocumentFile(file);
+		   else if(append_archive!=NULL)
+			  // All files are appended to the same file
+			  Compress(file,append_archive);
+#ifndef WIN32
+		   else if(server_clientsocket!=NULL)
+		   {
+			  // The file is compressed by the compression server
+			  if(CompressWithServer(server_clientsocket,file,usestdout ? NULL : outfilename)==0)
+				 PrintErrorMsg();
+		   }
+#endif
+		   else
+			  Compress(file,usestdout ? NULL : outfilename);
 
 		#ifdef PROFILE
 		   if(verbose)
@@ -262,33 +324,89 @@ void HandleSingleFile(char *file,int handleType)
 //************************************************************************
 
 
+int InitXMill(char **options,int optionnum)
+   // Initializes the label dictionary, the FSMs and the path expressions
+   // The options 'options[0]' ... 'options[optionnum-1]' are handled
+   // before the path expressions are compiled.
+   // Returns the index of the first non-option string or -1, if an error occurred
+{
+   int optidx=0;
+
+   try
+   {
+      globallabeldict.Init(); // Initialized the label dictionary
+      FSMInit();
+      if(optionnum>0)
+         optidx=HandleAllOptions(options,optionnum);
+
+      char *pathptr="//#";
+      pathexprman.AddNewVPathExpr(pathptr,pathptr+strlen(pathptr));
+      pathptr="/";
+      pathexprman.AddNewVPathExpr(pathptr,pathptr+strlen(pathptr));
+      pathexprman.CreateFSMs(fsmcache_file);
+      globallabeldict.FinishedPredefinedLabels();
+      pathexprman.InitWhitespaceHandling();
+   }
+   catch(XMillException *)
+      // An error occurred
+   {
+      PrintErrorMsg();
+      return -1;
+   }
+   return optidx;
+}
+
 int main(int argc,char **argv)
 {
+   int   fileidx,handletype;
 
-   // Now we start the heavy work!
+#if defined(XDEMILL)&&!defined(XMILL)
+   handletype=1;
+#else
+   // If the program is called as 'xdemill', the files are decompressed
+   handletype=(strstr(argv[0],"xdemill")!=NULL) ? 1 : 0;
+#endif
 
-   try
+   if((argc==1)||(strcmp(argv[1],"-h")==0))
    {
+      PrintUsage(argc>1);
+      return 0;
+   }
 
-		globallabeldict.Init(); // Initialized the label dictionary
-		FSMInit();
-		char *pathptr="//#";
-		pathexprman.AddNewVPathExpr(pathptr,pathptr+strlen(pathptr));
-		pathptr="/";
-		pathexprman.AddNewVPathExpr(pathptr,pathptr+strlen(pathptr));
-		globallabeldict.FinishedPredefinedLabels();
-		pathexprman.InitWhitespaceHandling();
-	
+   // Now we start the heavy work!
 
+   fileidx=InitXMill(argv+1,argc-1);
+   if(fileidx<0)
+      return -1;
+
+   // The file names follow the options
+   fileidx++;
+
+#ifndef WIN32
+   if(server_socket!=NULL)
+      // In server mode, we wait for requests
+   {
+      RunServer(server_socket);
+      PrintErrorMsg();
+      return -1;
    }
-   catch(XMillException *)
-      // An error occurred
+#endif
+
+   if(fileidx>=argc)
    {
+      PrintUsage(0);
       return -1;
    }
 
-   HandleSingleFile("sprot1_2.xml",0);//0:ѹ
-   //HandleSingleFile("f:\\sprot1_1.xmi",1);//1:ѹ
+   while(fileidx<argc)
+   {
+      HandleSingleFile(argv[fileidx],handletype);
+      fileidx++;
+   }
+
+   if(multidoc_archive!=NULL)
+      // All files are compressed as documents of the same file
+      CompressDocumentFiles();
 
    return 0;
 }
@@ -302,13 +420,33 @@ int main(int argc,char **argv)
 
 
 
+inline unsigned long GetFileFlags()
+   // Determines the extensions used for the current file
+{
+   unsigned long fileflags=0;
+
+   if(use_structcoder)
+      fileflags|=FILEFLAG_STRUCTCODER;
+   if(use_bitpack)
+      fileflags|=FILEFLAG_BITPACK;
+   if(use_blockindex)
+      fileflags|=FILEFLAG_BLOCKINDEX;
+
+   return fileflags;
+}
+
 inline void StoreFileHeader(Compressor *compressor)
 {
-   MemStreamer tmpoutputstream(1);
+   MemStreamer    tmpoutputstream(1);
+   unsigned long  fileflags=GetFileFlags();
 
+   // Files without extensions keep the original header
    tmpoutputstream.StoreSInt32(
       (globalfullwhitespacescompress==WHITESPACE_IGNORE) ? 1 : 0,
-      MAGIC_KEY);
+      (fileflags!=0) ? MAGIC_KEY_EXT : MAGIC_KEY);
+
+   if(fileflags!=0)
+      tmpoutputstream.StoreUInt32(fileflags);
 
    pathexprman.Store(&tmpoutputstream);
 
@@ -337,6 +475,121 @@ inline void CompressBlockHeader(Compressor *compressor,unsigned long totaldatasi
 
 char fileheader_iswritten=0;
 
+// If this is not NULL, the compressed data is kept in memory and
+// passed to the function instead of writing it into a file.
+// This is used by the compression server
+void (*compress_memoryhandler)(char *data,int len)=NULL;
+
+// If 'compress_source' is set, the compressor reads the data from
+// this source instead of the input file (see PushParse.hpp)
+InputSource *compress_source=NULL;
+
+// If 'compress_membuf' is set, the compressed data is written
+// into this memory buffer instead of the output file (see MemCompress.hpp)
+MemoryBuffer *compress_membuf=NULL;
+
+TFilePos LoadArchiveForAppend(char *archive)
+   // Prepares the compressor for appending new blocks to the existing
+   // file 'archive'. The file header must match the current path expressions
+   // and the extensions of the file are taken over. Then, the block index
+   // and the label dictionary are loaded.
+   // The function returns the position where the new blocks start.
+   // If the file cannot be appended, 0 is returned and an error message is set.
+{
+   Input          input;
+   char           iswhitespaceignore;
+   unsigned long  fileflags;
+   TFilePos       indexoffset;
+
+   if(input.OpenFile(archive)==0)
+   {
+      Error("Could not open file '");
+      ErrorCont(archive);
+      ErrorCont("'!");
+      return 0;
+   }
+
+   {
+      SmallBlockUncompressor  uncompressor(&input);
+      MemStreamer             mem(1);
+      MemStreamBlock          *block;
+
+      // Only files with a block index can be appended
+      if((uncompressor.LoadSInt32(&iswhitespaceignore)!=MAGIC_KEY_EXT)||
+         (((fileflags=uncompressor.LoadUInt32())&FILEFLAG_BLOCKINDEX)==0))
+      {
+         Error("File '");
+         ErrorCont(archive);
+         ErrorCont("' has no block index and cannot be appended!");
+         input.CloseFile();
+         return 0;
+      }
+      if(fileflags&~FILEFLAG_ALL)
+      {
+         Error("The file uses features unknown to this version of XMill!");
+         input.CloseFile();
+         return 0;
+      }
+
+      // The path expressions are stored in the same way as for the
+      // new file header
+      pathexprman.Store(&mem);
+
+      block=mem.GetFirstBlock();
+      while(block!=NULL)
+      {
+         if(mymemcmp((char *)uncompressor.LoadData(block->cursize),block->data,block->cursize)!=0)
+            break;
+         block=block->next;
+      }
+
+      if((block!=NULL)||
+         (iswhitespaceignore!=((globalfullwhitespacescompress==WHITESPACE_IGNORE) ? 1 : 0)))
+      {
+         Error("File '");
+         ErrorCont(archive);
+         ErrorCont("' was compressed with different path expressions or white space options!");
+         input.CloseFile();
+         return 0;
+      }
+   }
+   input.CloseFile();
+
+   use_structcoder=(fileflags&FILEFLAG_STRUCTCODER) ? 1 : 0;
+   use_bitpack=(fileflags&FILEFLAG_BITPACK) ? 1 : 0;
+
+   indexoffset=blockindex.LoadForAppend(archive);
+   if(indexoffset==0)
+   {
+      Error("Could not find the block index of file '");
+      ErrorCont(archive);
+      ErrorCont("'!");
+   }
+   return indexoffset;
+}
+
+inline void OpenNextDocument(XMLParse *xmlparse,char *curfile,char *nextfile)
+   // Closes the document 'curfile' and continues parsing with document 'nextfile'
+{
+   if(curpath.GetDepth()>0)
+   {
+      Error("File '");
+      ErrorCont(curfile);
+      ErrorCont("' ends within an element!");
+      Exit();
+   }
+
+   xmlparse->CloseFile();
+
+   if(xmlparse->OpenFile(nextfile)==0)
+   {
+      Error("Could not find file '");
+      ErrorCont(nextfile);
+      ErrorCont("'!");
+      Exit();
+   }
+}
+
 inline void CompressCurrentBlock(Output *output,unsigned long totaldatasize)
 {
    {
@@ -361,7 +614,10 @@ inline void CompressCurrentBlock(Output *output,unsigned long totaldatasize)
    compresscontman.CompressLargeContainers(output);
 }
 
-void Compress(char *srcfile,char *destfile)
+void CompressFiles(char **srcfiles,unsigned long srcfilenum,char *destfile)
+   // Compresses the files 'srcfiles[0]' ... 'srcfiles[srcfilenum-1]' into 'destfile'
+   // The files are parsed one after the other into the same blocks. If the block
+   // index has a document table, then each file is a separate document.
 {
    SAXClient      saxclient;
    XMLParse       xmlparse;
@@ -370,8 +626,10 @@ void Compress(char *srcfile,char *destfile)
    clock_t        c1,c2,c3;
 #endif
    int            parsetime=0,compresstime=0;
-   char           isend;
+   char           isend,isnewdocument;
    unsigned long  totaldatasize;
+   TFilePos       appendpos=0;
+   unsigned long  cursrcfile=0,i;
 
    // We count the overal sizes of the compressed/uncompressed
    // structure, white space, and special (DTD...) containers
@@ -380,33 +638,102 @@ void Compress(char *srcfile,char *destfile)
 
    fileheader_iswritten=0;
 
+   recordcount=0;
 
-
-   if(xmlparse.OpenFile(srcfile)==0)
+   if(((compress_source!=NULL) ? xmlparse.OpenSource(compress_source) : xmlparse.OpenFile(srcfiles[0]))==0)
    {
       Error("Could not find file '");
-      ErrorCont(srcfile);
+      ErrorCont(srcfiles[0]);
       ErrorCont("'!");
       PrintErrorMsg();
       return;
    }
 
-   if(output.CreateFile((no_output==0) ? destfile : "")==0)
+   if((append_archive!=NULL)||(multidoc_archive!=NULL))
+      // Appended files and multi-document files always have a block index
+      use_blockindex=1;
+
+   // The sync points are stored in the block index and contain positions
+   // in the containers, which the structure coder and the bit-packed
+   // frames don't have
+   if((syncpoint_interval>0)&&((use_blockindex==0)||use_structcoder||use_bitpack))
    {
-      Error("Could not create output file '");
-      ErrorCont(destfile);
+      if(use_blockindex==0)
+         Error("Option -y requires option -x!");
+      else
+         Error("Option -y cannot be combined with options -s and -b!");
       PrintErrorMsg();
       xmlparse.CloseFile();
       return;
    }
 
-   mainmem.StartNewMemBlock();
+   if(compress_memoryhandler!=NULL)
+   {
+      output.CreateMemoryOutput();
+      mainmem.StartNewMemBlock();
+   }
+   else if(compress_membuf!=NULL)
+   {
+      output.CreateMemoryOutput(compress_membuf);
+      mainmem.StartNewMemBlock();
+   }
+   else if((append_archive!=NULL)&&FileExists(destfile))
+   {
+      // The label dictionary of the existing file is loaded into 'mainmem'
+      mainmem.StartNewMemBlock();
+
+      try{
+         appendpos=LoadArchiveForAppend(destfile);
+      }
+      catch(XMillException *)
+      {
+         appendpos=0;
+      }
+
+      if((appendpos!=0)&&(output.AppendToFile(destfile,appendpos)==0))
+      {
+         Error("Could not open file '");
+         ErrorCont(destfile);
+         ErrorCont("' for writing!");
+         appendpos=0;
+      }
+      if(appendpos==0)
+      {
+         PrintErrorMsg();
+         globallabeldict.Reset();
+         mainmem.RemoveLastMemBlock();
+         xmlparse.CloseFile();
+         return;
+      }
+
+      // The file header is already in the file
+      fileheader_iswritten=1;
+   }
+   else
+   {
+      if(output.CreateFile((no_output==0) ? destfile : "")==0)
+      {
+         Error("Could not create output file '");
+         ErrorCont(destfile);
+         PrintErrorMsg();
+         xmlparse.CloseFile();
+         return;
+      }
+
+      mainmem.StartNewMemBlock();
+   }
 
 #ifdef USE_FORWARD_DATAGUIDE
    pathdict.Init();
    pathtree.CreateRootNode();
 #endif
 
+   if(multidoc_archive!=NULL)
+      blockindex.CreateDocumentTable();
+
+   // If the file has a document table, then the position of
+   // each new document is stored in the table
+   isnewdocument=blockindex.HasDocuments();
 
    try{
       do
@@ -418,16 +745,42 @@ void Compress(char *srcfile,char *destfile)
          pathdict.ResetContBlockPtrs();
 #endif
 
+         // The block starts at the current position of the output
+         if(use_blockindex)
+            blockindex.StartBlock(output.GetCurFileSize());
+
+         treetokencount=0;
+         StartBlockFlush();
+
          globalcontblock      =compresscontman.CreateNewContainerBlock(3,0,NULL,NULL);
          globaltreecont       =globalcontblock->GetContainer(0);
          globalwhitespacecont =globalcontblock->GetContainer(1);
          globalspecialcont    =globalcontblock->GetContainer(2);
+
+         if(use_structcoder)
+            structencoder.StartBlock(globaltreecont);
 #ifdef TIMING
          if(timing)
             c1=clock();
 #endif
 
-         isend=xmlparse.DoParsing(&saxclient);
+         for(;;)
+         {
+            if(isnewdocument)
+            {
+               blockindex.StartDocument(treetokencount);
+               isnewdocument=0;
+            }
+
+            isend=xmlparse.DoParsing(&saxclient);
+            if((isend==0)||(cursrcfile+1>=srcfilenum))
+               break;
+
+            // The next file is parsed into the same block
+            OpenNextDocument(&xmlparse,srcfiles[cursrcfile],srcfiles[cursrcfile+1]);
+            cursrcfile++;
+            isnewdocument=blockindex.HasDocuments();
+         }
          if(isend)
             isend=1;
 
@@ -436,12 +789,22 @@ void Compress(char *srcfile,char *destfile)
             c2=clock();
 #endif
 
+         if(use_structcoder)
+            structencoder.FinishBlock();
+
          compresscontman.FinishCompress();
 
          totaldatasize= compresscontman.GetDataSize()+
                         compressman.GetDataSize();
 
          CompressCurrentBlock(&output,totaldatasize);
+
+         if(use_blockindex)
+            blockindex.FinishBlock(totaldatasize);
+
+         if((flush_interval>0)||(flush_records>0))
+            // The block is passed on immediately
+            output.FlushToFile();
 #ifdef TIMING
          if(timing)
          {
@@ -476,11 +839,31 @@ static int count=0;
 */
       }
       while(isend==0);
+
+      if(use_blockindex)
+         blockindex.Store(&output);
    }
    catch(XMillException *)
    {
-      output.CloseAndDeleteFile();
+      if(appendpos!=0)
+         // We restore the old index, so that the existing file stays valid
+      {
+         char           *oldindex;
+         unsigned long  oldindexlen;
+
+         oldindex=blockindex.GetOldIndex(&oldindexlen);
+         output.CloseAndRestoreFile(appendpos,oldindex,oldindexlen);
+      }
+      else
+         output.CloseAndDeleteFile();
       xmlparse.CloseFile();
+
+      // We clean up, so that the next file can be compressed
+      // The path tree refers to the labels of this file
+      pathtree.ReleaseMemory();
+      compresscontman.ReleaseMemory();
+      globallabeldict.Reset();
+      mainmem.RemoveLastMemBlock();
       Exit();
    }
 #ifdef TIMING
@@ -498,14 +881,72 @@ static int count=0;
 #endif
 
    xmlparse.CloseFile();
+
+   if(compress_memoryhandler!=NULL)
+   {
+      int   len;
+      char  *data=output.GetMemoryData(&len);
+
+      compress_memoryhandler(data,len);
+   }
    output.CloseFile();
 
    globallabeldict.Reset();
 
    mainmem.RemoveLastMemBlock();
 
-   if(delete_inputfiles)
-      RemoveFile(srcfile);
+   if(delete_inputfiles&&(srcfiles[0]!=NULL))
+   {
+      for(i=0;i<srcfilenum;i++)
+         RemoveFile(srcfiles[i]);
+   }
+}
+
+void Compress(char *srcfile,char *destfile)
+   // Compresses the file 'srcfile' into 'destfile'
+{
+   CompressFiles(&srcfile,1,destfile);
+}
+
+// The files that are compressed into the multi-document file (option '-M')
+static char          **documentfiles=NULL;
+static unsigned long documentfilenum=0,maxdocumentfilenum=0;
+
+void AddDocumentFile(char *srcfile)
+   // Adds 'srcfile' to the files of the multi-document file
+{
+   if(documentfilenum==maxdocumentfilenum)
+   {
+      maxdocumentfilenum=(maxdocumentfilenum==0) ? 64 : maxdocumentfilenum*2;
+      documentfiles=(char **)realloc(documentfiles,sizeof(char *)*maxdocumentfilenum);
+      if(documentfiles==NULL)
+         ExitNoMem();
+   }
+   documentfiles[documentfilenum++]=srcfile;
+}
+
+void CompressDocumentFiles()
+   // Compresses all files added with 'AddDocumentFile' into
+   // the multi-document file
+{
+   if(documentfilenum==0)
+      return;
+
+   try{
+      CompressFiles(documentfiles,documentfilenum,multidoc_archive);
+   }
+   catch(XMillException *)
+      // An error occurred
+   {
+      Error("Error in file '");
+      ErrorCont(multidoc_archive);
+      ErrorCont("':");
+      PrintErrorMsg();
+   }
+
+   free(documentfiles);
+   documentfiles=NULL;
+   documentfilenum=maxdocumentfilenum=0;
 }
 
 
@@ -518,19 +959,37 @@ static int count=0;
 
 
 
-void DecodeTreeBlock(UncompressContainer *treecont,UncompressContainer *whitespacecont,UncompressContainer *specialcont,XMLOutput *output);
+void DecodeTreeBlock(UncompressContainer *treecont,UncompressContainer *whitespacecont,UncompressContainer *specialcont,XMLEventSink *output);
 //****************************************************************************
 //****************************************************************************
 
 void UncompressFileHeader(SmallBlockUncompressor *uncompressor)
 {
-   char iswhitespaceignore;
-   
-   if(uncompressor->LoadSInt32(&iswhitespaceignore)!=MAGIC_KEY)
+   char           iswhitespaceignore;
+   unsigned long  fileflags=0;
+   unsigned long  magickey=uncompressor->LoadSInt32(&iswhitespaceignore);
+
+   if(magickey==MAGIC_KEY_EXT)
    {
-      Error("The file is not a compressed XMill file!");
-      Exit();
+      fileflags=uncompressor->LoadUInt32();
+      if(fileflags&~FILEFLAG_ALL)
+      {
+         Error("The file uses features unknown to this version of XMill!");
+         Exit();
+      }
    }
+   else
+   {
+      if(magickey!=MAGIC_KEY)
+      {
+         Error("The file is not a compressed XMill file!");
+         Exit();
+      }
+   }
+
+   use_structcoder=(fileflags&FILEFLAG_STRUCTCODER) ? 1 : 0;
+   use_bitpack=(fileflags&FILEFLAG_BITPACK) ? 1 : 0;
+   use_blockindex=(fileflags&FILEFLAG_BLOCKINDEX) ? 1 : 0;
 
    if(iswhitespaceignore)
    {
@@ -552,6 +1011,7 @@ static char fileheader_isread=0;
 char UncompressBlockHeader(Input *input)
 {
    SmallBlockUncompressor  uncompressor(input);
+   unsigned long           datasize;
 
    if(fileheader_isread==0)
    {
@@ -560,15 +1020,29 @@ char UncompressBlockHeader(Input *input)
    }
    else
    {
-      if(input->IsEndOfFile())
+      if(input->IsEndOfData())
          return 1;
    }
 
-   memory_cutoff=uncompressor.LoadUInt32();
+   datasize=uncompressor.LoadUInt32();
 
-   SetMemoryAllocationSize(memory_cutoff);
+   // The block index of a file compressed with '-x' starts like
+   // a block without container blocks, so that we stop in front of it
+   if(uncomprcont.Load(&uncompressor)==0)
+      return 1;
 
-   uncomprcont.Load(&uncompressor);
+   memory_cutoff=datasize;
+
+   if(uncomprcont.IsStreaming())
+      // The streamed containers do not need space in the block memory
+   {
+      unsigned long streamedsize=uncomprcont.SetStreamed();
+      if(streamedsize>memory_cutoff)
+         ExitCorruptFile();
+      SetMemoryAllocationSize(memory_cutoff-streamedsize);
+   }
+   else
+      SetMemoryAllocationSize(memory_cutoff);
 
    globallabeldict.Load(&uncompressor);
 
@@ -583,8 +1057,21 @@ char UncompressBlockHeader(Input *input)
 
 #undef CreateFile
 
-void Uncompress(char *sourcefile,char *destfile)
-   // The main compres function
+// If 'uncompress_source' is set, the decompressor reads the data
+// from this source instead of the input file (see MemCompress.hpp)
+InputSource *uncompress_source=NULL;
+
+// If 'uncompress_membuf' is set, the decompressed data is written
+// into this memory buffer instead of the output file
+MemoryBuffer *uncompress_membuf=NULL;
+
+// If 'uncompress_sink' is set, the decompressed document is passed
+// to this sink instead of being printed (see XMLEventSink.hpp)
+XMLEventSink *uncompress_sink=NULL;
+
+void UncompressBlocks(char *sourcefile,char *destfile,unsigned long firstblock,unsigned long lastblock)
+   // Decompresses the blocks 'firstblock' ... 'lastblock' of 'sourcefile'
+   // If 'firstblock' is larger than zero, then the file must have a block index
 {
    Input                input;
 #ifdef TIMING
@@ -595,9 +1082,13 @@ void Uncompress(char *sourcefile,char *destfile)
    UncompressContainer  *uncomprwhitespacecont;
    UncompressContainer  *uncomprspecialcont;
 
+   char                 hasindex;
+   unsigned long        i;
 
+   // The sink receives the decompressed document
+   XMLEventSink         *sink=(uncompress_sink!=NULL) ? uncompress_sink : &output;
 
-   if(input.OpenFile(sourcefile)==0)
+   if(((uncompress_source!=NULL) ? input.OpenSource(uncompress_source) : input.OpenFile(sourcefile))==0)
    {
       Error("Could not find file '");
       ErrorCont(sourcefile);
@@ -605,9 +1096,16 @@ void Uncompress(char *sourcefile,char *destfile)
       return;
    }
 
-   globallabeldict.Init();
-
-   if(output.CreateFile((no_output==0) ? destfile : "")==0)
+   // We keep the predefined labels, since the projection and query paths refer to them
+   globallabeldict.Reset();
+   curpath.Reset();
+
+   if(uncompress_sink!=NULL)
+      // No output is written at all
+      output.CreateFile("");
+   else if(uncompress_membuf!=NULL)
+      output.CreateMemoryOutput(uncompress_membuf);
+   else if(output.CreateFile((no_output==0) ? destfile : "")==0)
    {
       Error("Could not create output file '");
       ErrorCont(destfile);
@@ -615,63 +1113,212 @@ void Uncompress(char *sourcefile,char *destfile)
       input.CloseFile();
       return;
    }
+
+   mainmem.StartNewMemBlock();
+
+   try{
+      // In the low-memory mode, the streamed containers are read
+      // directly from the file. Other data is kept in memory.
+      // A range of records needs containers that can be moved to a sync point.
+      if(lowmemory_decode&&(selectiveuncompressor==NULL)&&(recordextractor.IsActive()==0))
+         uncomprcont.StartStreaming(((sourcefile!=NULL)&&(uncompress_source==NULL)) ? sourcefile : (char *)NULL);
+
+      // We load the block index - if there is one
+      // For the first block, we don't need the labels of previous blocks
+      // The index of the standard input cannot be loaded, since we cannot
+      // move in it. The blocks are decompressed until the start of the index.
+      hasindex=(sourcefile!=NULL) ? blockindex.Load(sourcefile,firstblock) : 0;
+
+      if(firstblock>0)
+      {
+         if(hasindex==0)
+         {
+            Error("Option -B requires a file compressed with option -x!");
+            Exit();
+         }
+         // We read the file header from the first block
+         // and then jump directly to the first block
+         {
+            SmallBlockUncompressor  uncompressor(&input);
+            UncompressFileHeader(&uncompressor);
+            fileheader_isread=1;
+         }
+         if(use_blockindex==0)
+         {
+            Error("Option -B requires a file compressed with option -x!");
+            Exit();
+         }
+         BlockIndexEntry   *entry=blockindex.GetBlock(firstblock);
+         char              *strptr;
+         unsigned long     mystrlen;
+         unsigned char     isattrib;
+
+         if(input.SetFilePos(entry->offset)==0)
+            ExitCorruptFile();
+
+         // We open all elements that enclose the block
+         // Their attributes are part of previous blocks and are therefore lost
+         // For a range of records, they are opened at the first record
+         for(i=0;i<entry->depth;i++)
+         {
+            if(entry->openlabels[i]>=entry->labelnum)
+               ExitCorruptFile();
+
+            if((selectiveuncompressor==NULL)&&(recordextractor.IsActive()==0))
+            {
+               mystrlen=globallabeldict.LookupLabel(entry->openlabels[i],&strptr,&isattrib);
+               sink->startElement(strptr,mystrlen);
+            }
+            curpath.AddLabel(entry->openlabels[i]);
+         }
+      }
 #ifdef TIMING
-   c1=clock();
+      c1=clock();
 #endif
 
-   unsigned long blockidx=0;
+      unsigned long blockidx=firstblock;
 
-   mainmem.StartNewMemBlock();
+      if(selectiveuncompressor!=NULL)
+         selectiveuncompressor->StartFile();
 
-   while(UncompressBlockHeader(&input)==0)
-   {
-      compressman.UncompressLargeGlobalData(&input);
-      uncomprcont.UncompressLargeContainers(&input);
+      while((blockidx<=lastblock)&&
+            ((hasindex==0)||(blockidx<blockindex.GetBlockNum()))&&
+            (UncompressBlockHeader(&input)==0))
+      {
+         // Only files compressed with '-x' have an index
+         if(use_blockindex==0)
+            hasindex=0;
+         else
+         {
+            // A data source and the standard input are read without the index
+            if((hasindex==0)&&(sourcefile!=NULL)&&(uncompress_source==NULL))
+               ExitCorruptFile();
+         }
 
-      uncomprcont.Init();
+         compressman.UncompressLargeGlobalData(&input);
 
-      uncomprtreecont      =uncomprcont.GetContBlock(0)->GetContainer(0);
-      uncomprwhitespacecont=uncomprcont.GetContBlock(0)->GetContainer(1);
-      uncomprspecialcont   =uncomprcont.GetContBlock(0)->GetContainer(2);
+         if(selectiveuncompressor!=NULL)
+         {
+#ifdef TIMING
+            c2=clock();
+#endif
+            // Only the needed elements are decoded and
+            // containers that are not needed are skipped
+            selectiveuncompressor->UncompressBlock(&input,(hasindex ? blockindex.GetBlock(blockidx) : NULL),sink);
+         }
+         else
+         {
+            // With the index, the streamed containers are not
+            // decompressed in order to find the next container
+            if(hasindex&&uncomprcont.IsStreaming())
+            {
+               BlockIndexEntry *entry=blockindex.GetBlock(blockidx);
+
+               if(entry->largecontnum!=uncomprcont.GetLargeContNum())
+                  ExitCorruptFile();
+               uncomprcont.UncompressLargeContainers(&input,entry->largecontsizes);
+            }
+            else
+               uncomprcont.UncompressLargeContainers(&input);
+
+            uncomprcont.Init();
+
+            uncomprtreecont      =uncomprcont.GetContBlock(0)->GetContainer(0);
+            uncomprwhitespacecont=uncomprcont.GetContBlock(0)->GetContainer(1);
+            uncomprspecialcont   =uncomprcont.GetContBlock(0)->GetContainer(2);
 #ifdef TIMING
-      c2=clock();
+            c2=clock();
 #endif
 
-      DecodeTreeBlock(uncomprtreecont,uncomprwhitespacecont,uncomprspecialcont,&output);
+            if(recordextractor.IsActive())
+            {
+               // We stop after the block with the last record
+               recordextractor.StartBlock(blockidx);
+               if(recordextractor.DecodeBlock(uncomprtreecont,uncomprwhitespacecont,uncomprspecialcont,sink))
+                  lastblock=blockidx;
+            }
+            else if(hasindex&&(sink==&output)&&UseParallelDecode(blockidx))
+               // The records are decoded in parallel starting at the sync points
+               ParallelDecodeTreeBlock(blockidx,&output);
+            else
+               DecodeTreeBlock(uncomprtreecont,uncomprwhitespacecont,uncomprspecialcont,sink);
+         }
 #ifdef TIMING
-      c3=clock();
+         c3=clock();
 #endif
-/*
-      if(verbose)
-         printf("#%3lu  => Uncompress: %f sec   Decode: %f sec\n",
-            blockidx,
-            (float)(c2-c1)/(float)CLOCKS_PER_SEC,
-            (float)(c3-c2)/(float)CLOCKS_PER_SEC);
-*/
+   /*
+         if(verbose)
+            printf("#%3lu  => Uncompress: %f sec   Decode: %f sec\n",
+               blockidx,
+               (float)(c2-c1)/(float)CLOCKS_PER_SEC,
+               (float)(c3-c2)/(float)CLOCKS_PER_SEC);
+   */
 #ifdef TIMING
-      ct1+=c2-c1;
-      ct2+=c3-c2;
+         ct1+=c2-c1;
+         ct2+=c3-c2;
 #endif
 
-      uncomprcont.FinishUncompress();
-      uncomprcont.ReleaseContMem();
-      compressman.FinishUncompress();
-      blockmem.ReleaseMemory(1000);
+         // The output might still refer to text in the containers
+         output.FlushReferences();
+
+         uncomprcont.FinishUncompress();
+         uncomprcont.ReleaseContMem();
+         compressman.FinishUncompress();
+         blockmem.ReleaseMemory(1000);
+
+         // For a data stream from the standard input, each block is passed on immediately
+         if(sourcefile==NULL)
+            output.FlushToFile();
 #ifdef TIMING
-      c1=clock();
+         c1=clock();
 #endif
-      blockidx++;
-   }
+         blockidx++;
+      }
+
+      if(selectiveuncompressor!=NULL)
+         selectiveuncompressor->FinishFile(sink);
+      if(recordextractor.IsActive())
+         recordextractor.FinishFile();
+
+      // If we stopped before the last block, then we close
+      // all elements that are still open
+      while(curpath.GetDepth()>0)
+      {
+         char              *strptr;
+         unsigned long     mystrlen;
+         unsigned char     isattrib;
+
+         mystrlen=globallabeldict.LookupLabel(curpath.RemoveLabel(),&strptr,&isattrib);
+         if(selectiveuncompressor==NULL)
+            sink->endElement(strptr,mystrlen);
+      }
 #ifdef TIMING
-   if(verbose)
-      printf("%fs + %fs = %fs\n",(float)ct1/(float)CLOCKS_PER_SEC,
-                                 (float)ct2/(float)CLOCKS_PER_SEC,
-                                 (float)(ct1+ct2)/(float)CLOCKS_PER_SEC);
+      if(verbose)
+         printf("%fs + %fs = %fs\n",(float)ct1/(float)CLOCKS_PER_SEC,
+                                    (float)ct2/(float)CLOCKS_PER_SEC,
+                                    (float)(ct1+ct2)/(float)CLOCKS_PER_SEC);
 #endif
+   }
+   catch(XMillException *)
+      // We clean up, so that the next file can be decompressed
+   {
+      input.CloseFile();
+      output.CloseAndDeleteFile();
+      uncomprcont.FinishStreaming();
+      if(recordextractor.IsActive())
+         recordextractor.FinishFile();
+      globallabeldict.Reset();
+      fileheader_isread=0;
+      mainmem.RemoveLastMemBlock();
+      Exit();
+   }
    input.CloseFile();
    output.CloseFile();
+   uncomprcont.FinishStreaming();
 
-   if(delete_inputfiles)
+   // We only remove the input file, if we decompressed all blocks
+   if(delete_inputfiles&&(sourcefile!=NULL)&&(firstblock==0)&&(lastblock==BLOCKINDEX_LASTBLOCK)&&
+      (recordextractor.IsActive()==0))
       RemoveFile(sourcefile);
 
    globallabeldict.Reset();
@@ -681,5 +1328,31 @@ void Uncompress(char *sourcefile,char *destfile)
    mainmem.RemoveLastMemBlock();
 }
 
+void Uncompress(char *sourcefile,char *destfile)
+   // The main decompress function
+{
+   if((decode_firstrecord!=RECORD_ALLRECORDS)&&
+      ((selectiveuncompressor!=NULL)||(decode_firstblock!=0)||(decode_lastblock!=BLOCKINDEX_LASTBLOCK)))
+   {
+      Error("Option -R cannot be combined with options -B, -D, -P, -q or -E!");
+      Exit();
+   }
+
+   if(decode_document!=DOCUMENT_ALLDOCUMENTS)
+      // We only decompress the blocks of a single document
+   {
+      documentextractor.SetDocument(sourcefile,decode_document);
+      UncompressBlocks(sourcefile,destfile,documentextractor.GetFirstBlock(),documentextractor.GetLastBlock());
+   }
+   else if(decode_firstrecord!=RECORD_ALLRECORDS)
+      // We only decompress a range of records
+   {
+      recordextractor.SetRecords(sourcefile,decode_firstrecord,decode_lastrecord);
+      UncompressBlocks(sourcefile,destfile,recordextractor.GetFirstBlock(),BLOCKINDEX_LASTBLOCK);
+   }
+   else
+      UncompressBlocks(sourcefile,destfile,decode_firstblock,decode_lastblock);
+}
+
 
 
@@ -0,0 +1,191 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module contains the library interface for compressing and
+// decompressing documents that are kept in memory
+
+#include "MemCompress.hpp"
+#include "Error.hpp"
+#include "VPathExprMan.hpp"
+#include "BlockIndex.hpp"
+
+// Defined in Main.cpp
+void Compress(char *srcfile,char *destfile);
+void Uncompress(char *sourcefile,char *destfile);
+
+extern InputSource   *compress_source;
+extern MemoryBuffer  *compress_membuf;
+extern InputSource   *uncompress_source;
+extern MemoryBuffer  *uncompress_membuf;
+extern XMLEventSink  *uncompress_sink;
+
+extern char *append_archive;
+extern char *multidoc_archive;
+
+extern VPathExprMan  pathexprman;
+extern char          use_structcoder;
+extern char          use_bitpack;
+extern char          use_blockindex;
+extern char          globalfullwhitespacescompress;
+extern unsigned long memory_cutoff;
+
+//**************************************************************************
+
+char CompressSource(InputSource *source,MemoryBuffer *dest)
+   // Compresses the XML document read from 'source' into buffer 'dest'
+{
+   char  *saveappendarchive=append_archive;
+   char  *savemultidocarchive=multidoc_archive;
+   char  result=1;
+
+   // The document is neither appended nor collected with others
+   append_archive=NULL;
+   multidoc_archive=NULL;
+
+   compress_source=source;
+   compress_membuf=dest;
+
+   try{
+      Compress(NULL,NULL);
+   }
+   catch(XMillException *)
+   {
+      result=0;
+   }
+
+   compress_source=NULL;
+   compress_membuf=NULL;
+
+   append_archive=saveappendarchive;
+   multidoc_archive=savemultidocarchive;
+   return result;
+}
+
+char CompressMemory(char *data,unsigned long len,MemoryBuffer *dest)
+   // Compresses the XML document at 'data' into buffer 'dest'
+{
+   MemoryInputSource source(data,len);
+
+   return CompressSource(&source,dest);
+}
+
+//**************************************************************************
+
+static char RunUncompress(char *sourcefile)
+   // Runs the decompressor for file 'sourcefile' or for the data source
+   // Returns 0, if the decompression failed
+{
+   char  result=1;
+
+   // The decompressor replaces the path expressions and the options
+   // with those of the compressed file. We keep the ones of the compressor,
+   // since the application might compress more documents afterwards.
+   VPathExprMan   savepathexprman=pathexprman;
+   char           saveusestructcoder=use_structcoder;
+   char           saveusebitpack=use_bitpack;
+   char           saveuseblockindex=use_blockindex;
+   char           savewhitespacescompress=globalfullwhitespacescompress;
+   unsigned long  savememorycutoff=memory_cutoff;
+
+   try{
+      Uncompress(sourcefile,NULL);
+   }
+   catch(XMillException *)
+   {
+      result=0;
+   }
+
+   uncompress_source=NULL;
+   uncompress_membuf=NULL;
+   uncompress_sink=NULL;
+
+   pathexprman=savepathexprman;
+   use_structcoder=saveusestructcoder;
+   use_bitpack=saveusebitpack;
+   use_blockindex=saveuseblockindex;
+   globalfullwhitespacescompress=savewhitespacescompress;
+   memory_cutoff=savememorycutoff;
+   return result;
+}
+
+static unsigned long GetLenWithoutIndex(char *data,unsigned long len)
+   // If the data has a block index (option '-x'), then we cut it off,
+   // since the blocks are decompressed one after the other anyway
+{
+   if(len>=BLOCKINDEX_FOOTERSIZE)
+   {
+      unsigned long  magic;
+      TFilePos       offset=ReadIndexFooter((unsigned char *)data+len-BLOCKINDEX_FOOTERSIZE,len,&magic);
+
+      if(offset!=0)
+         return (unsigned long)offset;
+   }
+   return len;
+}
+
+char UncompressSource(InputSource *source,MemoryBuffer *dest)
+   // Decompresses the compressed document read from 'source' into buffer 'dest'
+{
+   uncompress_source=source;
+   uncompress_membuf=dest;
+
+   return RunUncompress(NULL);
+}
+
+char UncompressMemory(char *data,unsigned long len,MemoryBuffer *dest)
+   // Decompresses the compressed document at 'data' into buffer 'dest'
+{
+   MemoryInputSource source(data,GetLenWithoutIndex(data,len));
+
+   return UncompressSource(&source,dest);
+}
+
+//**************************************************************************
+
+char UncompressSourceToSink(InputSource *source,XMLEventSink *sink)
+   // Decompresses the compressed document read from 'source' and
+   // passes the document to 'sink'
+{
+   uncompress_source=source;
+   uncompress_sink=sink;
+
+   return RunUncompress(NULL);
+}
+
+char UncompressMemoryToSink(char *data,unsigned long len,XMLEventSink *sink)
+   // Decompresses the compressed document at 'data' and passes it to 'sink'
+{
+   MemoryInputSource source(data,GetLenWithoutIndex(data,len));
+
+   return UncompressSourceToSink(&source,sink);
+}
+
+char UncompressFileToSink(char *filename,XMLEventSink *sink)
+   // Decompresses file 'filename' and passes the document to 'sink'
+{
+   uncompress_sink=sink;
+
+   return RunUncompress(filename);
+}
@@ -0,0 +1,119 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module contains the library interface for compressing and
+// decompressing documents that are kept in memory.
+// The data is read from a memory buffer or from a data source that
+// implements 'InputSource' (e.g. a callback of the application) and
+// the result is written directly into a memory buffer of the caller.
+// Hence, no temporary files are needed.
+// Instead of the XML text, the decompressor can also pass the document
+// as a sequence of events to an 'XMLEventSink' of the application.
+//
+// The buffer of the caller is enlarged with 'realloc', if necessary - hence
+// it must be allocated with 'malloc' or it must be empty. The caller
+// frees the buffer with 'free' and can reuse it for the next document.
+// Example:
+//
+//    MemoryBuffer membuf={NULL,0,0};
+//
+//    InitXMill(options,optionnum);
+//    if(CompressMemory(xmldata,xmllen,&membuf)==0)
+//       PrintErrorMsg();
+//    ...   // The compressed data is in 'membuf.data' ... 'membuf.data+membuf.len-1'
+//    free(membuf.data);
+//
+// Since the compressor uses global state, only one document
+// can be (de)compressed at a time.
+
+#ifndef MEMCOMPRESS_HPP
+#define MEMCOMPRESS_HPP
+
+#include "File.hpp"
+#include "Output.hpp"
+#include "XMLEventSink.hpp"
+
+class MemoryInputSource : public InputSource
+   // A data source that reads the data from a memory buffer
+{
+   char           *curptr;    // The rest of the data
+   unsigned long  curlen;
+
+public:
+   MemoryInputSource(char *data,unsigned long len)
+   {
+      curptr=data;
+      curlen=len;
+   }
+
+   unsigned ReadData(char *dest,unsigned bytecount)
+      // Copies the next data into 'dest'
+   {
+      if(bytecount>curlen)
+         bytecount=curlen;
+
+      mymemcpy(dest,curptr,bytecount);
+      curptr+=bytecount;
+      curlen-=bytecount;
+      return bytecount;
+   }
+};
+
+int InitXMill(char **options,int optionnum);
+   // Initializes the compressor - this must be called once before any
+   // other function. The options 'options[0]' ... 'options[optionnum-1]'
+   // are the same as for the command line (e.g. path expressions).
+   // Returns the index of the first non-option string or -1, if an error occurred
+
+char CompressSource(InputSource *source,MemoryBuffer *dest);
+   // Compresses the XML document read from 'source' into buffer 'dest'
+   // The function returns 0 and sets an error message, if the compression fails
+
+char CompressMemory(char *data,unsigned long len,MemoryBuffer *dest);
+   // Compresses the XML document at 'data' into buffer 'dest'
+
+char UncompressSource(InputSource *source,MemoryBuffer *dest);
+   // Decompresses the compressed document read from 'source' into buffer 'dest'
+   // The function returns 0 and sets an error message, if the decompression fails
+   // Options '-B' and '-D' cannot be used, since they require a file.
+   // The block index of a file compressed with option '-x' must be cut off.
+
+char UncompressMemory(char *data,unsigned long len,MemoryBuffer *dest);
+   // Decompresses the compressed document at 'data' into buffer 'dest'
+   // A block index at the end of the data is ignored.
+
+char UncompressSourceToSink(InputSource *source,XMLEventSink *sink);
+   // Decompresses the compressed document read from 'source' and passes
+   // the elements, attributes and texts to 'sink' instead of printing them.
+   // The function returns 0 and sets an error message, if the decompression fails
+
+char UncompressMemoryToSink(char *data,unsigned long len,XMLEventSink *sink);
+   // Decompresses the compressed document at 'data' and passes it to 'sink'
+
+char UncompressFileToSink(char *filename,XMLEventSink *sink);
+   // Decompresses file 'filename' and passes the document to 'sink'
+   // The options for the selective decompression (e.g. '-P') can be used.
+
+#endif
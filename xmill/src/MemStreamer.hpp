@@ -181,6 +181,11 @@ public:
          return;
 
       int addsize=3-((curblock->cursize+3)&3);
+
+      // At the end of the block, the next allocation starts a new block anyway
+      if(curblock->cursize+addsize>curblock->blocksize)
+         addsize=curblock->blocksize-curblock->cursize;
+
       if(addsize>0)
       {
          curblock->cursize+=addsize;
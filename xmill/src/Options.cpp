@@ -39,6 +39,12 @@ History:
 
 
 #include "XMLOutput.hpp"
+#include "Projection.hpp"
+#include "Query.hpp"
+#include "Document.hpp"
+#include "Record.hpp"
+#include "Export.hpp"
+#include "Server.hpp"
 
 
 // Determines whether CR/LF (dos) or just LF (unix) should be used
@@ -53,6 +59,7 @@ char usedosnewline=0;
 char globalfullwhitespacescompress     =WHITESPACE_IGNORE;
 
 extern VPathExprMan pathexprman;   // The path manager
+extern MemStreamer mainmem;
 
 // The memory limit for the compressor
 // For the decompressor, it contains a size of the buffer needed to decompress
@@ -81,6 +88,50 @@ char ignore_pi=0;
 // The compression ratio index for the zlib library
 unsigned char zlib_compressidx=6;
 
+// The number of threads for compressing large containers
+// and for decoding the records of a block
+unsigned threadnum=1;
+
+// Determines whether the structure is encoded with the structure coder
+// For the decompressor, the flag is taken from the file header
+char use_structcoder=0;
+
+// Determines whether the integer compressors use bit-packed frames
+// For the decompressor, the flag is taken from the file header
+char use_bitpack=0;
+
+// Determines whether a block index is appended to the compressed file
+// For the decompressor, the flag is taken from the file header
+char use_blockindex=0;
+
+// The file to which all input files are appended (option '-A')
+char *append_archive=NULL;
+
+// The file in which the FSMs of the path expressions are cached (option '-C')
+char *fsmcache_file=NULL;
+
+// The file into which all input files are compressed as separate documents (option '-M')
+char *multidoc_archive=NULL;
+
+// The range of blocks that are decompressed (option '-B')
+unsigned long decode_firstblock=0,decode_lastblock=0xFFFFFFFFUL;
+
+// The compressor finishes a block after 'flush_interval' milliseconds
+// or after 'flush_records' records (options '-F' and '-N')
+unsigned long flush_interval=0,flush_records=0;
+
+// The document that is decompressed (option '-D')
+unsigned long decode_document=DOCUMENT_ALLDOCUMENTS;
+
+// The large containers are decompressed incrementally (option '-L')
+char lowmemory_decode=0;
+
+// The compressor stores a sync point every 'syncpoint_interval' records (option '-y')
+unsigned long syncpoint_interval=0;
+
+// The range of records that are decompressed (option '-R')
+unsigned long decode_firstrecord=RECORD_ALLRECORDS,decode_lastrecord=RECORD_ALLRECORDS;
+
 
 
 
@@ -268,6 +319,19 @@ void InterpretOptionString(char *option)
    case 'T':   timing=1;SkipArgumentString(1);return; 
 #endif
 
+      // Sets the number of threads for compressing large containers
+      // and for decoding the records of a block
+   case 'j':SkipArgumentString(1);
+            option=GetNextArgument(&len);
+            SkipArgumentString(len);
+            if(atoi(option)<1)
+            {
+               Error("Option '-j' must be followed be a number >=1");
+               Exit();
+            }
+            threadnum=atoi(option);
+            return;
+
 #ifdef XMILL
       // Sets the memory window size
    case 'm':SkipArgumentString(1);
@@ -282,6 +346,159 @@ void InterpretOptionString(char *option)
             memory_cutoff*=1024L*1024L;
             return;
 
+      // Finishes a block after some milliseconds
+   case 'F':SkipArgumentString(1);
+            option=GetNextArgument(&len);
+            if((option==NULL)||(atoi(option)<1))
+            {
+               Error("Option '-F' must be followed be a number >=1");
+               Exit();
+            }
+            SkipArgumentString(len);
+            flush_interval=(unsigned long)atoi(option);
+            return;
+
+      // Finishes a block after some records
+   case 'N':SkipArgumentString(1);
+            option=GetNextArgument(&len);
+            if((option==NULL)||(atoi(option)<1))
+            {
+               Error("Option '-N' must be followed be a number >=1");
+               Exit();
+            }
+            SkipArgumentString(len);
+            flush_records=(unsigned long)atoi(option);
+            return;
+
+      // Enables the structure coder
+   case 's':   use_structcoder=1;SkipArgumentString(1);return;
+
+      // Enables the bit-packed integer encoding
+   case 'b':   use_bitpack=1;SkipArgumentString(1);return;
+
+      // Appends a block index
+   case 'x':   use_blockindex=1;SkipArgumentString(1);return;
+
+      // Stores a sync point every num records in the block index
+   case 'y':SkipArgumentString(1);
+            option=GetNextArgument(&len);
+            if((option==NULL)||(atoi(option)<1))
+            {
+               Error("Option '-y' must be followed be a number >=1");
+               Exit();
+            }
+            SkipArgumentString(len);
+            syncpoint_interval=(unsigned long)atoi(option);
+            return;
+
+      // Appends the input files to an existing file
+   case 'A':SkipArgumentString(1);
+            option=GetNextArgument(&len);
+            if(option==NULL)
+            {
+               Error("Option '-A' must be followed by a file name");
+               Exit();
+            }
+            if(multidoc_archive!=NULL)
+            {
+               Error("Options -M and -A cannot be combined!");
+               Exit();
+            }
+            SkipArgumentString(len);
+            append_archive=mainmem.GetByteBlock(len+1);
+            mymemcpy(append_archive,option,len);
+            append_archive[len]=0;
+            return;
+
+      // Loads the FSMs from a cache file or stores them in the file
+   case 'C':SkipArgumentString(1);
+            option=GetNextArgument(&len);
+            if(option==NULL)
+            {
+               Error("Option '-C' must be followed by a file name");
+               Exit();
+            }
+            SkipArgumentString(len);
+            fsmcache_file=mainmem.GetByteBlock(len+1);
+            mymemcpy(fsmcache_file,option,len);
+            fsmcache_file[len]=0;
+            return;
+
+      // Compresses all input files into a single multi-document file
+   case 'M':SkipArgumentString(1);
+            option=GetNextArgument(&len);
+            if(option==NULL)
+            {
+               Error("Option '-M' must be followed by a file name");
+               Exit();
+            }
+            if(append_archive!=NULL)
+            {
+               Error("Options -M and -A cannot be combined!");
+               Exit();
+            }
+            SkipArgumentString(len);
+            multidoc_archive=mainmem.GetByteBlock(len+1);
+            mymemcpy(multidoc_archive,option,len);
+            multidoc_archive[len]=0;
+            return;
+
+#ifndef WIN32
+      // Options for the compression server
+   case 'S':   option++;
+               switch(*option)
+               {
+               case 's':   // Runs the server on the given socket
+               case 'c':   // Sends the files to the server on the given socket
+               {
+                  char optionchar=*option;
+                  char *socketpath;
+
+                  SkipArgumentString(2);
+                  option=GetNextArgument(&len);
+                  if(option==NULL)
+                  {
+                     Error("Options '-Ss' and '-Sc' must be followed by a socket name");
+                     Exit();
+                  }
+                  SkipArgumentString(len);
+                  socketpath=mainmem.GetByteBlock(len+1);
+                  mymemcpy(socketpath,option,len);
+                  socketpath[len]=0;
+
+                  if(optionchar=='s')
+                     server_socket=socketpath;
+                  else
+                     server_clientsocket=socketpath;
+                  return;
+               }
+               case 'n':   // Sets the maximal number of concurrent requests
+                  SkipArgumentString(2);
+                  option=GetNextArgument(&len);
+                  if((option==NULL)||(atoi(option)<1))
+                  {
+                     Error("Option '-Sn' must be followed be a number >=1");
+                     Exit();
+                  }
+                  SkipArgumentString(len);
+                  server_maxrequests=atoi(option);
+                  return;
+
+               case 'm':   // Sets the memory limit of a request
+                  SkipArgumentString(2);
+                  option=GetNextArgument(&len);
+                  if((option==NULL)||(atoi(option)<1))
+                  {
+                     Error("Option '-Sm' must be followed be a number >=1");
+                     Exit();
+                  }
+                  SkipArgumentString(len);
+                  server_memorylimit=(unsigned long)atoi(option)*1024L*1024L;
+                  return;
+               }
+               break;
+#endif
+
       // Reads a path expression
    case 'p':   SkipArgumentString(1);
                option=GetNextArgument(&len);
@@ -351,6 +568,200 @@ void InterpretOptionString(char *option)
                break;
 #endif
 #ifdef XDEMILL
+      // Reads a projection path
+   case 'P':   SkipArgumentString(1);
+               option=GetNextArgument(&len);
+               {
+               char *ptr=option;
+               if(selectiveuncompressor==&queryman)
+               {
+                  Error("Options -P and -q cannot be combined!");
+                  Exit();
+               }
+               if(selectiveuncompressor==&documentextractor)
+               {
+                  Error("Options -P and -D cannot be combined!");
+                  Exit();
+               }
+               if(selectiveuncompressor==&columnexporter)
+               {
+                  Error("Options -P and -E cannot be combined!");
+                  Exit();
+               }
+               projectionman.AddPath(ptr,option+strlen(option));
+               SkipArgumentString(ptr-option);
+               }
+               return;
+
+      // Reads a query
+   case 'q':   SkipArgumentString(1);
+               option=GetNextArgument(&len);
+               {
+               char *ptr=option;
+               if(selectiveuncompressor!=NULL)
+               {
+                  Error("Option -q can only be given once and cannot be combined with options -P, -D or -E!");
+                  Exit();
+               }
+               queryman.SetQuery(ptr);
+               SkipArgumentString(ptr-option);
+               }
+               return;
+
+      // Reads an export column or sets the format of the table
+   case 'E':   option++;
+               switch(*option)
+               {
+               case 'c':   columnexporter.SetFormat(EXPORT_CSV);SkipArgumentString(2);return;
+               case 't':   columnexporter.SetFormat(EXPORT_TSV);SkipArgumentString(2);return;
+               case 'r':   SkipArgumentString(2);
+                           option=GetNextArgument(&len);
+                           if(option==NULL)
+                           {
+                              Error("Option '-Er' must be followed by a path");
+                              Exit();
+                           }
+                           {
+                           char *ptr=option;
+                           columnexporter.SetRecordPath(ptr,option+strlen(option));
+                           SkipArgumentString(ptr-option);
+                           }
+                           return;
+               }
+               SkipArgumentString(1);
+               option=GetNextArgument(&len);
+               if(option==NULL)
+               {
+                  Error("Option '-E' must be followed by a path");
+                  Exit();
+               }
+               {
+               char *ptr=option;
+               if((selectiveuncompressor!=NULL)&&(selectiveuncompressor!=&columnexporter))
+               {
+                  Error("Option -E cannot be combined with options -P, -q or -D!");
+                  Exit();
+               }
+               columnexporter.AddColumn(ptr,option+strlen(option));
+               SkipArgumentString(ptr-option);
+               }
+               return;
+
+      // Sets the range of blocks that are decompressed
+   case 'B':SkipArgumentString(1);
+            option=GetNextArgument(&len);
+            SkipArgumentString(len);
+            {
+            char *ptr=option;
+
+            if((*ptr<'0')||(*ptr>'9'))
+            {
+               Error("Option '-B' must be followed by a block number or a range 'n-m'");
+               Exit();
+            }
+            decode_firstblock=strtoul(ptr,&ptr,10);
+            decode_lastblock=decode_firstblock;
+            if(*ptr=='-')
+            {
+               ptr++;
+               if((*ptr<'0')||(*ptr>'9'))
+               {
+                  Error("Option '-B' must be followed by a block number or a range 'n-m'");
+                  Exit();
+               }
+               decode_lastblock=strtoul(ptr,&ptr,10);
+            }
+            if((*ptr!=0)||(decode_lastblock<decode_firstblock))
+            {
+               Error("Option '-B' must be followed by a block number or a range 'n-m'");
+               Exit();
+            }
+            if(decode_document!=DOCUMENT_ALLDOCUMENTS)
+            {
+               Error("Options -B and -D cannot be combined!");
+               Exit();
+            }
+            }
+            return;
+
+      // Sets the range of records that are decompressed
+   case 'R':SkipArgumentString(1);
+            option=GetNextArgument(&len);
+            if(option==NULL)
+            {
+               Error("Option '-R' must be followed by a record number or a range 'n-m'");
+               Exit();
+            }
+            SkipArgumentString(len);
+            {
+            char *ptr=option;
+
+            if((*ptr<'0')||(*ptr>'9'))
+            {
+               Error("Option '-R' must be followed by a record number or a range 'n-m'");
+               Exit();
+            }
+            decode_firstrecord=strtoul(ptr,&ptr,10);
+            decode_lastrecord=decode_firstrecord;
+            if(*ptr=='-')
+            {
+               ptr++;
+               if((*ptr<'0')||(*ptr>'9'))
+               {
+                  Error("Option '-R' must be followed by a record number or a range 'n-m'");
+                  Exit();
+               }
+               decode_lastrecord=strtoul(ptr,&ptr,10);
+            }
+            if((*ptr!=0)||(decode_lastrecord<decode_firstrecord)||
+               (decode_lastrecord==RECORD_ALLRECORDS))
+            {
+               Error("Option '-R' must be followed by a record number or a range 'n-m'");
+               Exit();
+            }
+            }
+            return;
+
+      // Decompresses the large containers incrementally with little memory
+   case 'L':   lowmemory_decode=1;SkipArgumentString(1);return;
+
+      // Selects a single document of a multi-document file
+   case 'D':SkipArgumentString(1);
+            option=GetNextArgument(&len);
+            if(option==NULL)
+            {
+               Error("Option '-D' must be followed by a document number");
+               Exit();
+            }
+            SkipArgumentString(len);
+            {
+            char *ptr=option;
+
+            if((*ptr<'0')||(*ptr>'9'))
+            {
+               Error("Option '-D' must be followed by a document number");
+               Exit();
+            }
+            decode_document=strtoul(ptr,&ptr,10);
+            if((*ptr!=0)||(decode_document==DOCUMENT_ALLDOCUMENTS))
+            {
+               Error("Option '-D' must be followed by a document number");
+               Exit();
+            }
+            if((decode_firstblock!=0)||(decode_lastblock!=0xFFFFFFFFUL))
+            {
+               Error("Options -B and -D cannot be combined!");
+               Exit();
+            }
+            if(selectiveuncompressor!=NULL)
+            {
+               Error("Option -D cannot be combined with options -P, -q or -E!");
+               Exit();
+            }
+            selectiveuncompressor=&documentextractor;
+            }
+            return;
+
       // All options for output formatting
    case 'o':   option++;
                switch(*option)
@@ -430,7 +841,7 @@ void InterpretOptionString(char *option)
 int HandleAllOptions(char **argv,int argc)
    // Reads all the options from 'argv'.
    // It returns the index of the first non-option string
-   // i.e. the string not starting with '-'
+   // i.e. the string not starting with '-' or the string '-' for the standard input
 {
    char  *option;
    int   len;
@@ -439,7 +850,7 @@ int HandleAllOptions(char **argv,int argc)
 
    while((option=GetNextArgument(&len))!=NULL)
    {
-      if(*option!='-')
+      if((*option!='-')||(len==1))
          break;
 
       SkipArgumentString(1);
@@ -462,10 +873,11 @@ void PrintUsage(char showmoreoptions)
 #ifdef XMILL
 
    if(showmoreoptions==0)
-      printf("\nUsage:\n\n  xmill [-i file] [-v] [-p path] [-m num] [-1..9] [-c] [-d] [-r] [-w] [-h] file ...\n\n");
+      printf("\nUsage:\n\n  xmill [-i file] [-v] [-p path] [-m num] [-F ms] [-N num] [-j num] [-s] [-b] [-x] [-y num] [-A file] [-C file] [-M file] [-1..9] [-c] [-d] [-r] [-w] [-h] file ...\n\n");
    else
    {
-      printf("\nUsage:\n\n  xmill [-i file] [-v] [-p path] [-m num] [-1..9] [-c] [-d] [-r] [-w] [-h]\n");
+      printf("\nUsage:\n\n  xmill [-i file] [-v] [-p path] [-m num] [-F ms] [-N num] [-j num] [-s] [-b] [-x] [-y num] [-A file] [-C file] [-M file] [-1..9] [-c] [-d] [-r] [-w] [-h]\n");
+      printf("        [-Ss socket] [-Sc socket] [-Sn num] [-Sm num]\n");
       printf("        [-w(i|g|t)] [-l(i|g|t)] [-r(i|g|t)] [-a(i|g)] [-n(c|t|p|d)]  file ...\n\n");
    }
 
@@ -473,9 +885,20 @@ void PrintUsage(char showmoreoptions)
    printf(" -v       - verbose mode\n");
    printf(" -p path  - define path expression\n");
    printf(" -m num   - set memory limit\n");
+   printf(" -F ms    - finish a block after ms milliseconds (at the end of a record)\n");
+   printf(" -N num   - finish a block after num records\n");
+   printf(" -j num   - compress large containers with num threads\n");
+   printf(" -s       - encode the structure with the context-modeled structure coder\n");
+   printf(" -b       - store integers in bit-packed frames\n");
+   printf(" -x       - append a block index for random access\n");
+   printf(" -y num   - store a sync point every num records in the index (requires -x)\n");
+   printf(" -A file  - append all files to the compressed file (created with -x)\n");
+   printf(" -C file  - cache the automata of the path expressions in file\n");
+   printf(" -M file  - compress all files as separate documents into file\n");
    printf(" -1..9    - set the compression factor of zlib (default=6)\n");
 //   printf(" -t       - test mode (no output)\n");
    printf(" -c       - write on standard output\n");
+   printf(" -        - read from standard input and write on standard output\n");
 //   printf(" -k       - keep original files unchanged (default)\n");
    printf(" -d       - delete input files\n");
    printf(" -f       - force overwrite of output files\n");
@@ -502,16 +925,39 @@ void PrintUsage(char showmoreoptions)
       printf("    -np      - ignore PI sections\n");
       printf("    -nd      - ignore CDATA sections\n");
       printf("\n");
+#ifndef WIN32
+      printf("    -Ss sock - run as compression server on Unix domain socket sock\n");
+      printf("    -Sc sock - compress the files with the server on socket sock\n");
+      printf("    -Sn num  - let the server compress at most num files at a time (default=4)\n");
+      printf("    -Sm num  - limit the memory of each request of the server to num MB\n");
+      printf("\n");
+#endif
       printf("\n  User compressors:\n\n");
       compressman.PrintCompressorInfo();
    }
 #endif
 
 #ifdef XDEMILL
-   printf("Usage:\n\n\t xdemill [-i file] [-v] [-c] [-d] [-r] [-os num] [-ot] [-oz] [-od] [-ou] file ...\n\n");
+   printf("Usage:\n\n\t xdemill [-i file] [-v] [-P path] [-q query] [-E path] [-Er path] [-Ec] [-Et] [-B n[-m]] [-R n[-m]] [-D n] [-L] [-j num] [-c] [-d] [-r] [-os num] [-ot] [-oz] [-od] [-ou] file ...\n\n");
    printf(" -i file  - include options from file\n");
    printf(" -v       - verbose mode\n");
+   printf(" -P path  - output only the elements matching the path\n");
+   printf(" -q query - output the text of the elements selected by the query\n");
+   printf("            (e.g. -q '//entry[organism=\"Human\"]/name')\n");
+   printf(" -E path  - output a table with a column for the path and a row for each\n");
+   printf("            record (can be given several times)\n");
+   printf(" -Er path - the records are the elements matching the path\n");
+   printf("            (default: the children of the root element)\n");
+   printf(" -Ec      - output the table as comma separated values\n");
+   printf(" -Et      - output the table as tab separated values (default)\n");
+   printf(" -B n[-m] - decompress only blocks n to m (requires option -x)\n");
+   printf(" -R n[-m] - decompress only records n to m (requires option -x)\n");
+   printf(" -D n     - decompress only document n (requires option -M)\n");
+   printf(" -L       - decompress large containers incrementally with little memory\n");
+   printf(" -j num   - decode the records of a block with num threads (requires -y)\n");
+   printf("            (the output of each block is kept in memory)\n");
    printf(" -c       - write on standard output\n");
+   printf(" -        - read from standard input and write on standard output\n");
 //   printf(" -k       - keep original files unchanged\n");
    printf(" -d       - delete input files\n");
    printf(" -f       - force overwrite of output files\n");
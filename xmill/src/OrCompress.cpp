@@ -258,6 +258,20 @@ public:
       }
    }
 
+   void StoreSyncState(char *dataptr,MemStreamer *mem)
+      // Stores the states of all subcompressors
+   {
+      OrCompressorItem *item=info.subcompressors;
+
+      while(item!=NULL)
+      {
+         item->usercompressor->StoreSyncState(dataptr,mem);
+
+         dataptr+=item->usercompressor->GetUserDataSize();
+         item=item->next;
+      }
+   }
+
 };
 
 
@@ -308,7 +322,24 @@ class OrSepUncompressor : public UserUncompressor
       }
    }
 
-   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLOutput *output)
+   void LoadSyncState(UncompressContainer *cont,char *dataptr,unsigned char * &ptr)
+      // Restores the states of all subcompressors
+   {
+      OrCompressorItem *item=info.subcompressors;
+
+      cont++;
+
+      while(item!=NULL)
+      {
+         item->useruncompressor->LoadSyncState(cont,dataptr,ptr);
+
+         cont+=item->useruncompressor->GetUserContNum();
+         dataptr+=item->useruncompressor->GetUserDataSize();
+         item=item->next;
+      }
+   }
+
+   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLEventSink *output)
       // Does the actual decompression of a single text item
       // and prints the text to 'output'
    {
@@ -39,6 +39,9 @@ History:
 
 #ifndef WIN32
 #include <unistd.h>
+#include <sys/uio.h>
+#include <sys/stat.h>
+#include <fcntl.h>
 #else
 #include <stdio.h>
 #include <fcntl.h>
@@ -47,6 +50,7 @@ History:
 
 #include "Types.hpp"
 #include "Error.hpp"
+#include "OutputWriter.hpp"
 
 extern char usedosnewline;
 
@@ -59,16 +63,232 @@ extern char usedosnewline;
 #define OUTPUT_STATIC
 #endif
 
+#ifndef WIN32
+// Large strings that stay valid until the end of the current block are not copied
+// into the buffer - instead, the output keeps references to them and writes the
+// buffer together with the strings with a single 'writev' (see 'StoreDataRef')
+#define OUTPUT_MINREFLEN   64    // The minimal length of a string that is not copied
+#define OUTPUT_MAXIOVECS   512   // The maximal number of pieces that are written at once
+#endif
+
+// The default size of the output buffer - the buffer is written to the file at once
+#define OUTPUT_BUFSIZE     262144
+
+#if defined(__linux__)&&defined(FALLOC_FL_KEEP_SIZE)
+// The space of an output file is reserved in steps of OUTPUT_PREALLOCSIZE bytes,
+// so that the file system can allocate large extents instead of growing the
+// file with each write. The size of the file is not changed, i.e. a reader of
+// a file that is still written never sees the reserved space. The reserved
+// space behind the data is released when the file is closed.
+#define OUTPUT_PREALLOCSIZE   (16L*1024L*1024L)
+#endif
+
+struct MemoryBuffer
+   // A memory buffer owned by the caller (see MemCompress.hpp)
+   // The output writes directly into the buffer and enlarges it
+   // with 'realloc', if necessary. Field 'data' and 'size' always
+   // describe the current buffer - even if the output is aborted.
+{
+   char  *data;   // The buffer - allocated with 'malloc' or NULL
+   int   size;    // The size of the buffer
+   int   len;     // The length of the data in the buffer
+};
+
 class Output
 {
    OUTPUT_STATIC FILE  *output;        // The output file handler
    OUTPUT_STATIC char  *buf;           // the output buffer
    OUTPUT_STATIC char  *savefilename;  // the name of the output file
    OUTPUT_STATIC int   bufsize,curpos; // buffer size and current position
-   OUTPUT_STATIC int   overallsize;    // the accumulated size of the output data
+   OUTPUT_STATIC TFilePos overallsize; // the accumulated size of the output data
+   OUTPUT_STATIC char  inmemory;       // Is 1, if the data is kept in memory
+   OUTPUT_STATIC char  isappend;       // Is 1, if the data is written into an existing file
+   OUTPUT_STATIC MemoryBuffer *membuf; // The buffer of the caller, if the data is kept in memory
+   OUTPUT_STATIC TFilePos preallocsize;// The size of the file including the reserved space
+                                       // or -1, if no space is reserved
+#ifndef WIN32
+   OUTPUT_STATIC struct iovec *iovecs; // The pieces of the output that are not written yet
+                                       // or NULL, if the output doesn't keep references
+   OUTPUT_STATIC int   iovecnum;       // The number of pieces
+   OUTPUT_STATIC int   gatherpos;      // The start of the data in the buffer that is not in a piece yet
+   OUTPUT_STATIC int   gatherlen;      // The length of the referenced data outside of the buffer
+
+   OUTPUT_STATIC OutputWriter *writer; // The writer thread of the file
+                                       // or NULL, if the output writes the buffers itself
+   OUTPUT_STATIC char  refspending;    // Is 1, if the writer thread might still write referenced data
+
+   void OUTPUT_STATIC WriteBuffer(int len,int piecenum)
+      // Writes the first 'len' bytes of the buffer or the first 'piecenum' pieces
+      // If there is a writer thread, the buffer is only passed on and
+      // the output continues with the next free buffer
+   {
+      OutputWriterJob *job;
+
+      // The data written by 'fwrite' must come first
+      fflush(output);
+
+      if((len==0)&&(piecenum==0))
+         return;
+
+      if(writer!=NULL)
+      {
+         job=writer->PassBuffer(len,piecenum);
+         if(job!=NULL)
+         {
+            buf=job->buf;
+            iovecs=job->iovecs;
+            return;
+         }
+      }
+      else
+      {
+         if(piecenum>0)
+         {
+            if(OutputWriter::WriteVectors(output,iovecs,piecenum))
+               return;
+         }
+         else
+         {
+            if(OutputWriter::WriteData(output,buf,len))
+               return;
+         }
+      }
+      Error("Could not write output file!");
+      Exit();
+   }
+
+   void OUTPUT_STATIC WriteVectors()
+      // Writes the pieces and the rest of the buffer with 'writev'
+   {
+      if(curpos>gatherpos)
+      {
+         iovecs[iovecnum].iov_base=buf+gatherpos;
+         iovecs[iovecnum].iov_len=curpos-gatherpos;
+         iovecnum++;
+      }
+      overallsize+=gatherlen;
+      Preallocate(overallsize);
+
+      WriteBuffer(curpos,iovecnum);
+      if(writer!=NULL)
+         refspending=1;
+
+      curpos=gatherpos=gatherlen=0;
+      iovecnum=0;
+   }
+
+   char OUTPUT_STATIC StopWriter()
+      // Waits until the writer thread has written all buffers and stops it
+      // The output keeps its current buffer and writes the following buffers itself
+      // Returns 0, if a buffer could not be written
+   {
+      char isok;
+
+      if(writer==NULL)
+         return 1;
+
+      isok=writer->Finish();
+      delete writer;
+      writer=NULL;
+      refspending=0;
+      return isok;
+   }
+#endif
+
+   void OUTPUT_STATIC InitReferences(char usereferences)
+      // Initializes the references to the data outside of the buffer
+      // The references are only used for files on POSIX systems
+   {
+#ifndef WIN32
+      iovecs=NULL;
+      iovecnum=gatherpos=gatherlen=0;
+
+      if(usereferences)
+      {
+         iovecs=(struct iovec *)malloc(OUTPUT_MAXIOVECS*sizeof(struct iovec));
+         if(iovecs==NULL)
+            ExitNoMem();
+      }
+#endif
+   }
+
+   void OUTPUT_STATIC InitWriter(char usewriter)
+      // Starts the writer thread, if 'usewriter' is 1
+      // The thread is only used for named files - the data on the standard
+      // output must stay in order with the messages printed with 'printf'
+   {
+#ifndef WIN32
+      writer=NULL;
+      refspending=0;
+
+      if(usewriter)
+      {
+         writer=new OutputWriter();
+         if(writer->Start(output,buf,bufsize,iovecs,OUTPUT_MAXIOVECS)==0)
+            // Without the thread, the output writes the buffers itself
+         {
+            delete writer;
+            writer=NULL;
+         }
+      }
+#endif
+   }
+
+   void OUTPUT_STATIC InitPreallocation()
+      // Starts reserving the space of the output file, if it is a regular file
+      // The standard output is never extended, since it might be shared
+   {
+      preallocsize=-1;
+#ifdef OUTPUT_PREALLOCSIZE
+      struct stat filestat;
+
+      if((savefilename!=NULL)&&(output!=NULL)&&
+         (fstat(fileno(output),&filestat)==0)&&S_ISREG(filestat.st_mode))
+         preallocsize=(TFilePos)filestat.st_size;
+#endif
+   }
+
+   void OUTPUT_STATIC Preallocate(TFilePos size)
+      // Makes sure that the space for the first 'size' bytes of the file is reserved
+   {
+#ifdef OUTPUT_PREALLOCSIZE
+      if((preallocsize<0)||(size<=preallocsize))
+         return;
+
+      // If the space cannot be reserved, the file simply grows with each write
+      if(fallocate(fileno(output),FALLOC_FL_KEEP_SIZE,preallocsize,size+OUTPUT_PREALLOCSIZE-preallocsize)!=0)
+         preallocsize=-1;
+      else
+         preallocsize=size+OUTPUT_PREALLOCSIZE;
+#endif
+   }
+
+   void OUTPUT_STATIC ReleasePreallocation()
+      // Releases the space reserved behind the end of the file
+      // The file is truncated to its own size, so the data is never changed
+   {
+#ifdef OUTPUT_PREALLOCSIZE
+      struct stat filestat;
+
+      if((preallocsize>=0)&&(fstat(fileno(output),&filestat)==0))
+         ftruncate(fileno(output),filestat.st_size);
+#endif
+   }
+
+   void OUTPUT_STATIC ReleaseReferences()
+      // Releases the memory for the references
+   {
+#ifndef WIN32
+      if(iovecs!=NULL)
+      {
+         free(iovecs);
+         iovecs=NULL;
+      }
+#endif
+   }
 
 public:
-   char OUTPUT_STATIC CreateFile(char *filename,int mybufsize=65536)
+   char OUTPUT_STATIC CreateFile(char *filename,int mybufsize=OUTPUT_BUFSIZE)
       // Creates the output file. If 'filename==NULL', then the standard
       // output is used.
    {
@@ -88,12 +308,13 @@ public:
       }
       else
       {
-         // We allocate the output buffer memory and a little more for the filename
-         buf=(char *)malloc(mybufsize+strlen(filename)+1);
-         if(buf==NULL)
+         // The filename is kept separately, since the writer thread
+         // exchanges the buffer
+         buf=(char *)malloc(mybufsize);
+         savefilename=(char *)malloc(strlen(filename)+1);
+         if((buf==NULL)||(savefilename==NULL))
             ExitNoMem();
 
-         savefilename=buf+mybufsize;
          strcpy(savefilename,filename);
 
          // We only open the output file, if strlen(filename)>0.
@@ -111,38 +332,238 @@ public:
       bufsize=mybufsize;
       curpos=0;
       overallsize=0;
+      inmemory=0;
+      isappend=0;
+      membuf=NULL;
+      InitReferences(output!=NULL);
+      InitPreallocation();
+      InitWriter((savefilename!=NULL)&&(output!=NULL));
       return 1;
    }
 
+   char OUTPUT_STATIC AppendToFile(char *filename,TFilePos pos,int mybufsize=OUTPUT_BUFSIZE)
+      // Opens the existing file 'filename' and writes the output starting
+      // at position 'pos'. The data in front of 'pos' is kept and the
+      // data behind 'pos' is cut off when the file is closed.
+   {
+      buf=(char *)malloc(mybufsize);
+      savefilename=(char *)malloc(strlen(filename)+1);
+      if((buf==NULL)||(savefilename==NULL))
+         ExitNoMem();
+
+      strcpy(savefilename,filename);
+
+      output=fopen(filename,"r+b");
+      if(output==NULL)
+         return 0;
+
+      if(SeekFile(pos)==0)
+      {
+         fclose(output);
+         output=NULL;
+         return 0;
+      }
+      bufsize=mybufsize;
+      curpos=0;
+      overallsize=pos;
+      inmemory=0;
+      isappend=1;
+      membuf=NULL;
+      InitReferences(0);
+      InitPreallocation();
+      InitWriter(1);
+      return 1;
+   }
+
+   void OUTPUT_STATIC CreateMemoryOutput(int mybufsize=65536)
+      // Creates an output that keeps the data in memory instead of writing it
+      // to a file. The buffer grows if necessary.
+   {
+      buf=(char *)malloc(mybufsize);
+      if(buf==NULL)
+         ExitNoMem();
+
+      savefilename=NULL;
+      output=NULL;
+      bufsize=mybufsize;
+      curpos=0;
+      overallsize=0;
+      inmemory=1;
+      isappend=0;
+      membuf=NULL;
+      preallocsize=-1;
+      InitReferences(0);
+      InitWriter(0);
+   }
+
+   void OUTPUT_STATIC CreateMemoryOutput(MemoryBuffer *mymembuf)
+      // Creates an output that writes the data into the buffer 'mymembuf'
+      // of the caller. If the buffer is empty, a new buffer is allocated.
+   {
+      if((mymembuf->data==NULL)||(mymembuf->size<=0))
+      {
+         mymembuf->data=(char *)realloc(mymembuf->data,65536);
+         if(mymembuf->data==NULL)
+            ExitNoMem();
+         mymembuf->size=65536;
+      }
+      mymembuf->len=0;
+
+      buf=mymembuf->data;
+      savefilename=NULL;
+      output=NULL;
+      bufsize=mymembuf->size;
+      curpos=0;
+      overallsize=0;
+      inmemory=1;
+      isappend=0;
+      membuf=mymembuf;
+      preallocsize=-1;
+      InitReferences(0);
+      InitWriter(0);
+   }
+
+   char OUTPUT_STATIC *GetMemoryData(int *len)
+      // Returns the data of a memory output
+   {
+      *len=curpos;
+      return buf;
+   }
+
+   void OUTPUT_STATIC SetMemoryDataSize(int len)
+      // Truncates the data of a memory output to 'len' bytes
+   {
+      curpos=len;
+   }
+
    void OUTPUT_STATIC CloseFile()
       // Writes the remaining output to the file and closes the file
    {
-      Flush();
+      if(inmemory==0)
+         Flush();
+#ifndef WIN32
+      if(StopWriter()==0)
+      {
+         Error("Could not write output file!");
+         Exit();
+      }
+#endif
+      ReleaseReferences();
+      // The old data behind the appended data is cut off
+      if(isappend)
+         TruncateFile();
+      else
+         ReleasePreallocation();
       if(savefilename!=NULL)
       {
          if(output!=NULL)
             fclose(output);
+         free(savefilename);
       }
-      free(buf);
+      if(membuf!=NULL)
+         // The buffer belongs to the caller
+         membuf->len=curpos;
+      else
+         free(buf);
    }
 
    void OUTPUT_STATIC CloseAndDeleteFile()
-      // Writes the remaining data and closes the file and removes it
+      // Closes the file and removes it
+      // The buffered and the referenced data is dropped, so that
+      // the function cannot fail - it is called after errors
    {
-      Flush();
+#ifndef WIN32
+      iovecnum=gatherpos=gatherlen=0;
+      // The file is removed anyway, so write errors don't matter
+      StopWriter();
+#endif
+      ReleaseReferences();
+      curpos=0;
       if(savefilename!=NULL)
       {
          if(output!=NULL)
             fclose(output);
          unlink(savefilename);
+         free(savefilename);
       }
-      free(buf);
+      if(membuf!=NULL)
+         // The buffer of the caller is kept, but the data is discarded
+         membuf->len=0;
+      else
+         free(buf);
       return;
    }
 
+   void OUTPUT_STATIC CloseAndRestoreFile(TFilePos pos,char *data,int len)
+      // Discards the data appended to an existing file, writes the 'len'
+      // bytes at 'data' back at position 'pos' and closes the file
+   {
+#ifndef WIN32
+      // The old data is restored by the output itself
+      StopWriter();
+#endif
+      curpos=0;
+      if(SeekFile(pos))
+      {
+         overallsize=pos;
+         // The function is called after errors and must not fail again
+         try{
+            StoreData(data,len);
+            Flush();
+            TruncateFile();
+         }
+         catch(XMillException *)
+         {
+         }
+         curpos=0;
+      }
+      fclose(output);
+      free(savefilename);
+      free(buf);
+   }
+
+   char OUTPUT_STATIC SeekFile(TFilePos pos)
+      // Moves to position 'pos' of the file - returns 0, if this fails
+   {
+#ifdef WIN32
+      return (_fseeki64(output,pos,SEEK_SET)==0) ? 1 : 0;
+#else
+      return (fseeko(output,pos,SEEK_SET)==0) ? 1 : 0;
+#endif
+   }
+
+   void OUTPUT_STATIC TruncateFile()
+      // Cuts off the file behind the data written so far
+      // The output must have been flushed before
+   {
+      fflush(output);
+#ifdef WIN32
+      _chsize_s(_fileno(output),overallsize);
+#else
+      ftruncate(fileno(output),overallsize);
+#endif
+   }
+
    void OUTPUT_STATIC Flush()
       // Flushes the output file
    {
+      if(inmemory)
+         // The buffer of a memory output is simply enlarged
+      {
+         char *newbuf=(char *)realloc(buf,bufsize*2);
+         if(newbuf==NULL)
+            ExitNoMem();
+         buf=newbuf;
+         bufsize*=2;
+
+         if(membuf!=NULL)
+         {
+            membuf->data=buf;
+            membuf->size=bufsize;
+         }
+         return;
+      }
+
       overallsize+=curpos;
 
       if(output==NULL)
@@ -150,7 +571,18 @@ public:
          curpos=0;
          return;
       }
+#ifndef WIN32
+      if(iovecnum>0)
+      {
+         WriteVectors();
+         return;
+      }
 
+      // The buffer is written at once without the extra copy of 'fwrite'
+      Preallocate(overallsize);
+      WriteBuffer(curpos,0);
+      curpos=0;
+#else
       char  *ptr=buf;
       int   byteswritten;
 
@@ -169,6 +601,26 @@ public:
          curpos-=byteswritten;
          ptr+=byteswritten;
       }
+#endif
+   }
+
+   void OUTPUT_STATIC FlushToFile()
+      // Writes the buffered data and flushes the file handler, so that
+      // the data is passed on immediately - e.g. to the next program in a pipe
+   {
+      if(inmemory)
+         return;
+
+      Flush();
+#ifndef WIN32
+      if((writer!=NULL)&&(writer->WaitForBuffers()==0))
+      {
+         Error("Could not write output file!");
+         Exit();
+      }
+#endif
+      if(output!=NULL)
+         fflush(output);
    }
 
    char OUTPUT_STATIC *GetBufPtr(int *len)
@@ -185,9 +637,34 @@ public:
       curpos+=bytecount;
    }
 
-   int OUTPUT_STATIC GetCurFileSize() {  return overallsize+curpos; }
+#ifndef WIN32
+   TFilePos OUTPUT_STATIC GetCurFileSize() {  return overallsize+curpos+gatherlen; }
+#else
+   TFilePos OUTPUT_STATIC GetCurFileSize() {  return overallsize+curpos; }
+#endif
       // Returns the current file size
 
+   void OUTPUT_STATIC FlushReferences()
+      // Writes the data referenced with 'StoreDataRef'
+      // This must happen before the referenced memory is released
+   {
+#ifndef WIN32
+      if(iovecnum>0)
+         Flush();
+
+      // The writer thread might still write the referenced data
+      if(refspending)
+      {
+         if(writer->WaitForBuffers()==0)
+         {
+            Error("Could not write output file!");
+            Exit();
+         }
+         refspending=0;
+      }
+#endif
+   }
+
 //********************************************
 
    void OUTPUT_STATIC StoreData(char *ptr,int len)
@@ -205,6 +682,35 @@ public:
       curpos+=len;
    }
 
+   void OUTPUT_STATIC StoreDataRef(char *ptr,int len)
+      // Stores the data at position 'ptr' of length 'len'
+      // If the data is large, then only a reference is kept - the data
+      // must stay valid until 'FlushReferences' is called
+   {
+#ifndef WIN32
+      if((iovecs!=NULL)&&(len>=OUTPUT_MINREFLEN))
+      {
+         // We need space for the data in front, the reference and the rest of the buffer
+         if(iovecnum>OUTPUT_MAXIOVECS-3)
+            Flush();
+
+         if(curpos>gatherpos)
+         {
+            iovecs[iovecnum].iov_base=buf+gatherpos;
+            iovecs[iovecnum].iov_len=curpos-gatherpos;
+            iovecnum++;
+            gatherpos=curpos;
+         }
+         iovecs[iovecnum].iov_base=ptr;
+         iovecs[iovecnum].iov_len=len;
+         iovecnum++;
+         gatherlen+=len;
+         return;
+      }
+#endif
+      StoreData(ptr,len);
+   }
+
    void OUTPUT_STATIC StoreInt32(int val)
       // Stores a simple uncompressed integer
    {
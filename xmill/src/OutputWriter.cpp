@@ -0,0 +1,244 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements the writer thread of an output file
+
+#ifndef WIN32
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "OutputWriter.hpp"
+#include "Error.hpp"
+
+char OutputWriter::WriteData(FILE *file,char *data,int len)
+   // Writes the 'len' bytes at 'data' with 'write' - returns 0, if an error occurred
+{
+   int byteswritten;
+
+   while(len>0)
+   {
+      byteswritten=write(fileno(file),data,len);
+      if(byteswritten<=0)
+      {
+         if((byteswritten<0)&&(errno==EINTR))
+            continue;
+         return 0;
+      }
+      len-=byteswritten;
+      data+=byteswritten;
+   }
+   return 1;
+}
+
+char OutputWriter::WriteVectors(FILE *file,struct iovec *iovecs,int iovecnum)
+   // Writes the pieces 'iovecs' with 'writev' - returns 0, if an error occurred
+{
+   struct iovec   *curvec=iovecs,*endvec=iovecs+iovecnum;
+   int            byteswritten;
+
+   while(curvec<endvec)
+   {
+      byteswritten=writev(fileno(file),curvec,endvec-curvec);
+      if(byteswritten<=0)
+      {
+         if((byteswritten<0)&&(errno==EINTR))
+            continue;
+         return 0;
+      }
+      // We skip the pieces that have been written completely
+      while((curvec<endvec)&&((size_t)byteswritten>=curvec->iov_len))
+      {
+         byteswritten-=curvec->iov_len;
+         curvec++;
+      }
+      if(curvec<endvec)
+      {
+         curvec->iov_base=(char *)curvec->iov_base+byteswritten;
+         curvec->iov_len-=byteswritten;
+      }
+   }
+   return 1;
+}
+
+//**************************************************************************
+
+void OutputWriter::WriterMain(void *mywriter)
+   // The main function of the writer thread
+   // The buffers are written in the order in which they were passed on
+{
+   OutputWriter      *writer=(OutputWriter *)mywriter;
+   OutputWriterJob   *job;
+   char              isok;
+
+   writer->mutex.Lock();
+   while(1)
+   {
+      while((writer->jobnum==0)&&(writer->isfinished==0))
+         writer->cond.Wait(&(writer->mutex));
+
+      if(writer->jobnum==0)
+         break;
+
+      job=writer->jobs+writer->firstjob;
+
+      // After an error, the remaining buffers are dropped
+      isok=0;
+      if(writer->iserror==0)
+      {
+         writer->mutex.Unlock();
+
+         if(job->iovecnum>0)
+            isok=WriteVectors(writer->file,job->iovecs,job->iovecnum);
+         else
+            isok=WriteData(writer->file,job->buf,job->len);
+
+         writer->mutex.Lock();
+      }
+      if(isok==0)
+         writer->iserror=1;
+
+      writer->firstjob=(writer->firstjob+1)%OUTPUTWRITER_BUFNUM;
+      writer->jobnum--;
+      writer->cond.SignalAll();
+   }
+   writer->mutex.Unlock();
+}
+
+//**************************************************************************
+
+char OutputWriter::Start(FILE *myfile,char *buf,int bufsize,struct iovec *iovecs,int maxiovecs)
+   // Starts the writer thread for file 'myfile'
+{
+   int i;
+
+   file=myfile;
+   firstjob=jobnum=0;
+   iserror=isfinished=0;
+
+   jobs[0].buf=buf;
+   jobs[0].iovecs=iovecs;
+
+   for(i=1;i<OUTPUTWRITER_BUFNUM;i++)
+   {
+      jobs[i].buf=(char *)malloc(bufsize);
+      jobs[i].iovecs=NULL;
+      if((jobs[i].buf!=NULL)&&(iovecs!=NULL))
+         jobs[i].iovecs=(struct iovec *)malloc(maxiovecs*sizeof(struct iovec));
+
+      if((jobs[i].buf==NULL)||((iovecs!=NULL)&&(jobs[i].iovecs==NULL)))
+      {
+         free(jobs[i].buf);
+         while(--i>0)
+         {
+            free(jobs[i].buf);
+            free(jobs[i].iovecs);
+         }
+         ExitNoMem();
+      }
+   }
+
+   if(thread.Start(WriterMain,this)==0)
+   {
+      for(i=1;i<OUTPUTWRITER_BUFNUM;i++)
+      {
+         free(jobs[i].buf);
+         free(jobs[i].iovecs);
+      }
+      return 0;
+   }
+   return 1;
+}
+
+OutputWriterJob *OutputWriter::PassBuffer(int len,int iovecnum)
+   // Passes the current buffer to the writer thread and returns the next buffer
+{
+   OutputWriterJob *job;
+
+   mutex.Lock();
+   if(iserror)
+   {
+      mutex.Unlock();
+      return NULL;
+   }
+
+   job=jobs+(firstjob+jobnum)%OUTPUTWRITER_BUFNUM;
+   job->len=len;
+   job->iovecnum=iovecnum;
+   jobnum++;
+   cond.SignalAll();
+
+   // We wait until the next buffer has been written
+   while(jobnum==OUTPUTWRITER_BUFNUM)
+      cond.Wait(&mutex);
+
+   job=jobs+(firstjob+jobnum)%OUTPUTWRITER_BUFNUM;
+   mutex.Unlock();
+   return job;
+}
+
+char OutputWriter::WaitForBuffers()
+   // Waits until all buffers passed on are written
+{
+   char isok;
+
+   mutex.Lock();
+   while(jobnum>0)
+      cond.Wait(&mutex);
+   isok=(iserror==0);
+   mutex.Unlock();
+   return isok;
+}
+
+char OutputWriter::Finish()
+   // Stops the writer thread and releases the buffers except for the current one
+{
+   char  isok;
+   int   i;
+
+   mutex.Lock();
+   isfinished=1;
+   cond.SignalAll();
+   mutex.Unlock();
+
+   // The thread writes all remaining buffers before it finishes
+   thread.Join();
+
+   isok=(iserror==0);
+
+   // Since all buffers are written, the output currently fills buffer 'firstjob'
+   for(i=0;i<OUTPUTWRITER_BUFNUM;i++)
+   {
+      if(i==firstjob)
+         continue;
+      free(jobs[i].buf);
+      free(jobs[i].iovecs);
+   }
+   return isok;
+}
+
+#endif
@@ -0,0 +1,103 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements the writer thread of an output file.
+// When the buffer of the output is full, the output passes it to the
+// writer thread and continues with the next free buffer - i.e. the
+// compression or decompression goes on while the data is written.
+// The output waits only if all buffers are still waiting to be written.
+// The writer thread is only used on POSIX systems.
+
+#ifndef OUTPUTWRITER_HPP
+#define OUTPUTWRITER_HPP
+
+#ifndef WIN32
+
+#include <stdio.h>
+#include <sys/uio.h>
+
+#include "Thread.hpp"
+
+// The number of buffers of an output file - the output fills one buffer,
+// while the writer thread writes the others
+#define OUTPUTWRITER_BUFNUM   4
+
+struct OutputWriterJob
+   // A buffer of the output
+{
+   char           *buf;       // The buffer
+   int            len;        // The length of the data in the buffer
+   struct iovec   *iovecs;    // The pieces of the data - or NULL, if the output doesn't keep references
+   int            iovecnum;   // The number of pieces - if this is 0, the data is 'buf' with length 'len'
+};
+
+class OutputWriter
+{
+   FILE              *file;      // The output file
+   OutputWriterJob   jobs[OUTPUTWRITER_BUFNUM];
+   int               firstjob;   // The oldest buffer that has not been written yet
+   int               jobnum;     // The number of buffers that have not been written yet
+   char              iserror;    // Is 1, if a buffer could not be written
+   char              isfinished; // Is 1, if the writer thread must finish
+   XMillThread       thread;
+   XMillMutex        mutex;      // Protects the fields above
+   XMillCondition    cond;       // Is signaled whenever a buffer was passed on or written
+
+   static void WriterMain(void *writer);
+
+public:
+   static char WriteData(FILE *file,char *data,int len);
+      // Writes the 'len' bytes at 'data' with 'write' - returns 0, if an error occurred
+   static char WriteVectors(FILE *file,struct iovec *iovecs,int iovecnum);
+      // Writes the pieces 'iovecs' with 'writev' - returns 0, if an error occurred
+      // The pieces are modified
+
+   char Start(FILE *myfile,char *buf,int bufsize,struct iovec *iovecs,int maxiovecs);
+      // Starts the writer thread for file 'myfile'. The output currently fills
+      // buffer 'buf' and the pieces 'iovecs' (or NULL) - the writer allocates the
+      // other buffers and becomes the owner of all buffers.
+      // Returns 0, if the thread cannot be started - then, the buffers still
+      // belong to the output.
+
+   OutputWriterJob *PassBuffer(int len,int iovecnum);
+      // Passes the buffer that the output currently fills to the writer thread
+      // The data are the first 'len' bytes of the buffer or the 'iovecnum' pieces.
+      // Returns the next buffer to fill - or NULL, if a previous buffer could not be
+      // written. In this case, the current buffer is kept by the output.
+
+   char WaitForBuffers();
+      // Waits until all buffers passed on are written
+      // Returns 0, if a buffer could not be written
+
+   char Finish();
+      // Waits until all buffers are written, stops the writer thread and releases
+      // the buffers - except for the buffer that the output currently fills, which
+      // belongs to the output again. Returns 0, if a buffer could not be written
+};
+
+#endif
+
+#endif
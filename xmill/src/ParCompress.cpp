@@ -0,0 +1,379 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements the parallel compression of large containers.
+// Similar to 'pigz', a container is split into chunks of fixed size
+// that are deflated independently by several threads. Each chunk is primed
+// with the last 32KB of the preceding chunk as the dictionary and ends with
+// a sync flush, so that the chunks can simply be concatenated into a single
+// zlib stream.
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "ParCompress.hpp"
+#include "MemStreamer.hpp"
+#include "Output.hpp"
+#include "Thread.hpp"
+
+#ifndef USE_BZIP
+
+#include "../zlib/zlib.h"
+
+extern unsigned char zlib_compressidx;
+
+struct ParCompressChunk
+   // Describes a single chunk of a container
+{
+   MemStreamBlock *block;        // The memory block and the offset in that block
+   unsigned long  offset;        // where the chunk starts
+   MemStreamBlock *dictblock;    // The memory block and the offset in that block
+   unsigned long  dictoffset;    // where the dictionary of the chunk starts
+   unsigned long  len,dictlen;   // The length of the chunk and of the dictionary
+   char           islast;        // Is this the last chunk of the container?
+   char           iserror;       // Is set to 1, if the compression failed
+
+   unsigned char  *outbuf;       // The compressed data of the chunk
+   unsigned long  outstart,outlen;
+};
+
+struct ParCompressJob
+   // The state shared by all worker threads
+{
+   ParCompressChunk  *chunks;
+   unsigned long     chunknum;
+   unsigned long     nextchunk;  // The next chunk that is not yet compressed
+   XMillMutex        mutex;      // Protects 'nextchunk'
+};
+
+//**************************************************************************
+
+inline void AdvanceMemStreamPos(MemStreamBlock * &block,unsigned long &offset,unsigned long len)
+   // Moves the position (block,offset) in the memory streamer forward by 'len' bytes
+{
+   offset+=len;
+   while((block!=NULL)&&(offset>=block->cursize))
+   {
+      if((offset==block->cursize)&&(block->next==NULL))
+         return;
+      offset-=block->cursize;
+      block=block->next;
+   }
+}
+
+inline void CopyMemStreamData(MemStreamBlock *block,unsigned long offset,unsigned char *dest,unsigned long len)
+   // Copies 'len' bytes from position (block,offset) to 'dest'
+{
+   unsigned long copylen;
+
+   while(len>0)
+   {
+      copylen=block->cursize-offset;
+      if(copylen>len)
+         copylen=len;
+
+      memcpy(dest,block->data+offset,copylen);
+      dest+=copylen;
+      len-=copylen;
+
+      block=block->next;
+      offset=0;
+   }
+}
+
+//**************************************************************************
+
+static char DeflateChunk(z_stream *state,ParCompressChunk *chunk,unsigned long *outsize,int flush)
+   // Calls 'deflate' until the entire input is consumed and, if 'flush'
+   // is not Z_NO_FLUSH, until all output is written.
+   // The output buffer of the chunk grows as needed.
+   // Returns 0, if an error occurred
+{
+   int   err;
+
+   do
+   {
+      if(state->avail_out==0)
+         // We need more output space
+      {
+         unsigned long  usedsize=*outsize;
+         unsigned char  *newbuf=(unsigned char *)realloc(chunk->outbuf,*outsize*2);
+         if(newbuf==NULL)
+            return 0;
+
+         chunk->outbuf=newbuf;
+         *outsize*=2;
+         state->next_out=chunk->outbuf+usedsize;
+         state->avail_out=*outsize-usedsize;
+      }
+
+      err=deflate(state,flush);
+
+      if(err==Z_STREAM_END)
+         return 1;
+      if(err!=Z_OK)
+      {
+         // If the previous flush filled the output buffer exactly,
+         // then there is nothing left to do
+         if((err==Z_BUF_ERROR)&&(flush==Z_SYNC_FLUSH)&&(state->avail_in==0))
+            return 1;
+         return 0;
+      }
+   }
+   while((state->avail_in>0)||((flush!=Z_NO_FLUSH)&&(state->avail_out==0))||(flush==Z_FINISH));
+
+   return 1;
+}
+
+static void CompressChunk(ParCompressChunk *chunk)
+   // Deflates a single chunk into 'chunk->outbuf'
+   // The chunk is compressed as a zlib stream and the zlib header (and
+   // trailer) is removed afterwards
+{
+   z_stream       state;
+   unsigned char  dict[PARCOMPRESS_DICTSIZE];
+   unsigned long  outsize=chunk->len+chunk->len/8+64;
+
+   MemStreamBlock *block=chunk->block;
+   unsigned long  offset=chunk->offset,
+                  len=chunk->len,
+                  blocklen;
+
+   chunk->iserror=1;
+
+   // We use the default memory allocation of the zlib library, since
+   // 'zalloc' exits with an exception that must not leave the thread
+   state.zalloc=Z_NULL;
+   state.zfree=Z_NULL;
+   state.opaque=Z_NULL;
+
+   chunk->outbuf=(unsigned char *)malloc(outsize);
+   if(chunk->outbuf==NULL)
+      return;
+
+   if(deflateInit(&state,zlib_compressidx)!=Z_OK)
+      return;
+
+   state.next_out=chunk->outbuf;
+   state.avail_out=outsize;
+
+   // The dictionary is the data directly before the chunk
+   if(chunk->dictlen>0)
+   {
+      CopyMemStreamData(chunk->dictblock,chunk->dictoffset,dict,chunk->dictlen);
+      if(deflateSetDictionary(&state,dict,chunk->dictlen)!=Z_OK)
+      {
+         deflateEnd(&state);
+         return;
+      }
+   }
+
+   while(len>0)
+   {
+      blocklen=block->cursize-offset;
+      if(blocklen>len)
+         blocklen=len;
+
+      state.next_in=(unsigned char *)block->data+offset;
+      state.avail_in=blocklen;
+
+      if(DeflateChunk(&state,chunk,&outsize,Z_NO_FLUSH)==0)
+      {
+         deflateEnd(&state);
+         return;
+      }
+      len-=blocklen;
+      block=block->next;
+      offset=0;
+   }
+
+   // The last chunk finishes the stream. All other chunks are
+   // flushed to a byte boundary, so that the next chunk can follow
+   if(DeflateChunk(&state,chunk,&outsize,chunk->islast ? Z_FINISH : Z_SYNC_FLUSH)==0)
+   {
+      deflateEnd(&state);
+      return;
+   }
+
+   // We skip the zlib header - which contains the dictionary ID,
+   // if a dictionary has been used - and the trailer of the last chunk
+   chunk->outstart=(chunk->outbuf[1]&0x20) ? 6 : 2;
+   chunk->outlen=state.total_out-chunk->outstart-(chunk->islast ? 4 : 0);
+
+   deflateEnd(&state);
+   chunk->iserror=0;
+}
+
+static void CompressChunks(void *arg)
+   // The main function of the worker threads
+   // Each thread compresses the next available chunk until no chunks are left
+{
+   ParCompressJob *job=(ParCompressJob *)arg;
+   unsigned long  chunkidx;
+
+   while(1)
+   {
+      job->mutex.Lock();
+      chunkidx=job->nextchunk++;
+      job->mutex.Unlock();
+
+      if(chunkidx>=job->chunknum)
+         return;
+
+      CompressChunk(job->chunks+chunkidx);
+   }
+}
+
+//**************************************************************************
+
+void ParallelCompressMemStream(MemStreamer *memstream,Output *output,unsigned long *uncompressedsize,unsigned long *compressedsize)
+   // Compresses the data in 'memstream' with 'threadnum' threads and writes
+   // the resulting zlib stream to 'output'. The input data size and
+   // the output data size are stored in 'uncompressedsize' and 'compressedsize'
+{
+   ParCompressJob    job;
+   XMillThread       *threads;
+   unsigned long     size=memstream->GetSize(),
+                     i,threadcount;
+   MemStreamBlock    *block=memstream->GetFirstBlock();
+   unsigned long     offset=0;
+
+   job.chunknum=(size+PARCOMPRESS_CHUNKSIZE-1)/PARCOMPRESS_CHUNKSIZE;
+   job.nextchunk=0;
+   job.chunks=new ParCompressChunk[job.chunknum];
+   if(job.chunks==NULL)
+      ExitNoMem();
+
+   // We determine the start position of each chunk and its dictionary
+   for(i=0;i<job.chunknum;i++)
+   {
+      ParCompressChunk *chunk=job.chunks+i;
+
+      if(i>0)
+      {
+         AdvanceMemStreamPos(block,offset,PARCOMPRESS_CHUNKSIZE-PARCOMPRESS_DICTSIZE);
+         chunk->dictblock=block;
+         chunk->dictoffset=offset;
+         chunk->dictlen=PARCOMPRESS_DICTSIZE;
+         AdvanceMemStreamPos(block,offset,PARCOMPRESS_DICTSIZE);
+      }
+      else
+         chunk->dictlen=0;
+
+      chunk->block=block;
+      chunk->offset=offset;
+      chunk->len=(i<job.chunknum-1) ? PARCOMPRESS_CHUNKSIZE : size-i*PARCOMPRESS_CHUNKSIZE;
+      chunk->islast=(i==job.chunknum-1);
+      chunk->outbuf=NULL;
+   }
+
+   // We start the worker threads - the current thread works as well
+   threadcount=threadnum-1;
+   if(threadcount>job.chunknum-1)
+      threadcount=job.chunknum-1;
+
+   threads=new XMillThread[threadcount];
+   if(threads==NULL)
+      ExitNoMem();
+
+   for(i=0;i<threadcount;i++)
+   {
+      if(threads[i].Start(CompressChunks,&job)==0)
+         // If we cannot create more threads, the remaining threads
+         // do the work
+         break;
+   }
+
+   CompressChunks(&job);
+
+   for(i=0;i<threadcount;i++)
+      threads[i].Join();
+
+   delete[] threads;
+
+   // We check whether all chunks have been compressed successfully
+   for(i=0;i<job.chunknum;i++)
+   {
+      if(job.chunks[i].iserror)
+         break;
+   }
+
+   if(i<job.chunknum)
+   {
+      for(i=0;i<job.chunknum;i++)
+         free(job.chunks[i].outbuf);
+      delete[] job.chunks;
+
+      Error("Error while compressing container!");
+      Exit();
+   }
+
+   // We compute the zlib header in the same way as 'deflate'
+   // Note that the decompressor does not need the header of the chunks
+   unsigned char  header[4];
+   unsigned       headerval=(Z_DEFLATED+((MAX_WBITS-8)<<4))<<8;
+   unsigned       levelflags=(zlib_compressidx==0) ? 3 : ((unsigned)zlib_compressidx-1)>>1;
+
+   if(levelflags>3)
+      levelflags=3;
+
+   headerval|=(levelflags<<6);
+   headerval+=31-(headerval%31);
+
+   header[0]=(unsigned char)(headerval>>8);
+   header[1]=(unsigned char)headerval;
+   output->StoreData((char *)header,2);
+
+   *compressedsize=2;
+
+   // Now we write the chunks in their original order
+   for(i=0;i<job.chunknum;i++)
+   {
+      output->StoreData((char *)job.chunks[i].outbuf+job.chunks[i].outstart,job.chunks[i].outlen);
+      *compressedsize+=job.chunks[i].outlen;
+      free(job.chunks[i].outbuf);
+   }
+   delete[] job.chunks;
+
+   // The trailer contains the checksum of the entire container
+   unsigned long  adler=adler32(0L,Z_NULL,0);
+
+   block=memstream->GetFirstBlock();
+   while(block!=NULL)
+   {
+      adler=adler32(adler,(unsigned char *)block->data,block->cursize);
+      block=block->next;
+   }
+
+   header[0]=(unsigned char)(adler>>24);
+   header[1]=(unsigned char)(adler>>16);
+   header[2]=(unsigned char)(adler>>8);
+   header[3]=(unsigned char)adler;
+   output->StoreData((char *)header,4);
+
+   *compressedsize+=4;
+   *uncompressedsize=size;
+}
+
+#endif
@@ -0,0 +1,61 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements the parallel compression of large containers.
+// Similar to 'pigz', a container is split into chunks of fixed size
+// that are deflated independently by several threads. Each chunk is primed
+// with the last 32KB of the preceding chunk as the dictionary and ends with
+// a sync flush, so that the chunks can simply be concatenated into a single
+// zlib stream. Hence, the decompressor does not need to know whether a
+// container has been compressed in parallel or not.
+
+#ifndef PARCOMPRESS_HPP
+#define PARCOMPRESS_HPP
+
+class Output;
+class MemStreamer;
+
+#define PARCOMPRESS_CHUNKSIZE    131072L  // The size of a single chunk
+#define PARCOMPRESS_DICTSIZE     32768L   // The size of the dictionary (i.e. the deflate window)
+
+// Containers smaller than this threshold are always compressed sequentially
+#define PARCOMPRESS_THRESHOLD    (2*PARCOMPRESS_CHUNKSIZE)
+
+extern unsigned threadnum;    // The number of compression threads
+
+inline char UseParallelCompress(unsigned long size)
+   // Returns 1, if a container of size 'size' should be compressed in parallel
+{
+#ifdef USE_BZIP
+   return 0;
+#else
+   return (threadnum>1)&&(size>=PARCOMPRESS_THRESHOLD);
+#endif
+}
+
+void ParallelCompressMemStream(MemStreamer *memstream,Output *output,unsigned long *uncompressedsize,unsigned long *compressedsize);
+   // Compresses the data in 'memstream' with 'threadnum' threads and writes
+   // the resulting zlib stream to 'output'. The input data size and
+   // the output data size are stored in 'uncompressedsize' and 'compressedsize'
+
+#endif
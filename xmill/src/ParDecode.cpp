@@ -0,0 +1,422 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements the parallel decoding of a block (option '-j')
+
+#include "ParDecode.hpp"
+#include "UnCompCont.hpp"
+#include "XMLOutput.hpp"
+#include "LabelDict.hpp"
+#include "CurPath.hpp"
+#include "BlockIndex.hpp"
+#include "Record.hpp"
+#include "Thread.hpp"
+
+#undef LoadString
+
+extern MemStreamer            blockmem;
+extern UncompressContainerMan uncomprcont;
+extern char                   use_structcoder;
+extern unsigned               threadnum;
+
+class ParDecodeNullSink : public XMLEventSink
+   // Drops the tokens of a range in front of its first record
+{
+public:
+   void startElement(char *str,int len)   {}
+   void endElement(char *str,int len)  {}
+   void endEmptyElement()  {}
+   void startAttribute(char *str,int len) {}
+   void endAttribute(char *str,int len)   {}
+   void characters(char *str,int len)  {}
+   void whitespaces(char *str,int len) {}
+   void attribWhitespaces(char *str,int len) {}
+   void special(char *str,int len)  {}
+};
+
+struct ParDecodeRange
+   // Describes a range of records of the current block
+{
+   UncompressContainerMan  *contman;      // The containers and the user decompressor states
+   CurPath                 *path;         // The current path
+   XMLOutput               *output;       // The output of the range
+   unsigned long           firstrecord;   // The number of the first record of the range
+   unsigned long           endrecord;     // The number of the first record behind the range
+                                          // or RECORD_ALLRECORDS for the last range
+   char                    printall;      // Is 1 for the first range, which also prints
+                                          // the tokens in front of its first record
+   char                    iserror;       // Is set to 1, if the decoding failed
+   ErrorBuffer             errors;        // The error messages of the range
+
+   // The ranges behind the first range start at a sync point
+   // and have their own state
+   UncompressContainerMan  mycontman;
+   CurPath                 mypath;
+   XMLOutput               myoutput;
+};
+
+struct ParDecodeJob
+   // The state shared by all worker threads
+{
+   ParDecodeRange    *ranges;
+   unsigned long     rangenum;
+   unsigned long     nextrange;  // The next range that is not yet decoded
+   XMillMutex        mutex;      // Protects 'nextrange'
+};
+
+static char       isparallel=0;  // Is 1, while the worker threads decode a block
+static XMillMutex blockmemmutex; // Protects 'blockmem' while 'isparallel' is set
+
+void *GetSharedBlockMem(unsigned long size)
+   // Allocates 'size' bytes in 'blockmem'
+{
+   void *ptr;
+
+   if(isparallel==0)
+      return blockmem.GetByteBlock(size);
+
+   blockmemmutex.Lock();
+   try{
+      ptr=blockmem.GetByteBlock(size);
+   }
+   catch(XMillException *e)
+   {
+      blockmemmutex.Unlock();
+      throw e;
+   }
+   blockmemmutex.Unlock();
+   return ptr;
+}
+
+//**************************************************************************
+
+static void DecodeRange(ParDecodeRange *range)
+   // Decodes the tokens of a single range
+   // This is the same loop as in 'DecodeTreeBlock', but the record
+   // boundaries are counted and the range stops in front of the next range
+{
+   ParDecodeNullSink nullsink;
+   char              *strptr;
+   int               mystrlen;
+   unsigned char     *curptr,*endptr;
+   long              id;
+   char              isneg;
+   unsigned long     currecord=range->firstrecord;
+
+   UncompressContainer  *treecont=range->contman->GetContBlock(0)->GetContainer(0);
+   UncompressContainer  *whitespacecont=range->contman->GetContBlock(0)->GetContainer(1);
+   UncompressContainer  *specialcont=range->contman->GetContBlock(0)->GetContainer(2);
+   CurPath              *path=range->path;
+   XMLEventSink         *output=range->printall ? (XMLEventSink *)range->output : &nullsink;
+
+   UncompressLabelDictItem *labelarray=globallabeldict.GetLabelArray(),*item;
+   unsigned long           labelnum=globallabeldict.GetUncompressLabelNum();
+   TLabelID                labelid;
+
+   // At a sync point, the structure container doesn't start at the beginning
+   curptr=treecont->GetDataPtr();
+   endptr=curptr+(treecont->GetSize()-treecont->GetPos());
+
+   while(curptr<endptr)
+   {
+      id=LoadSInt32(curptr,&isneg);
+
+      if(isneg==0)
+      {
+         if(id>=32768L)
+         {
+            Error("Error while decompressing file!");
+            Exit();
+         }
+
+         switch(id)
+         {
+         case TREETOKEN_ENDLABEL:
+            labelid=path->RemoveLabel();
+            if(labelid>=labelnum)
+               ExitCorruptFile();
+            item=labelarray+labelid;
+
+            if(item->isattrib==0)
+               output->endElement(item->strptr,item->len);
+            else
+               output->endAttribute(item->strptr,item->len);
+            break;
+
+         case TREETOKEN_EMPTYENDLABEL:
+            path->RemoveLabel();
+            output->endEmptyElement();
+            break;
+
+         case TREETOKEN_WHITESPACE:
+            mystrlen=whitespacecont->LoadUInt32();
+            output->whitespaces((char *)whitespacecont->GetDataPtr(mystrlen),mystrlen);
+            break;
+
+         case TREETOKEN_ATTRIBWHITESPACE:
+            mystrlen=whitespacecont->LoadUInt32();
+            output->attribWhitespaces((char *)whitespacecont->GetDataPtr(mystrlen),mystrlen);
+            break;
+
+         case TREETOKEN_SPECIAL:
+            strptr=(char *)(specialcont->LoadString((unsigned *)&mystrlen));
+            output->special(strptr,mystrlen);
+            break;
+
+         default: // A start label
+            id-=LABELIDX_TOKENOFFS;
+            if((unsigned long)id>=labelnum)
+               ExitCorruptFile();
+            item=labelarray+id;
+
+            if((path->GetDepth()==1)&&(item->isattrib==0))
+               // A new record starts
+            {
+               if(currecord==range->endrecord)
+                  // The next range continues here
+                  return;
+
+               if(currecord==range->firstrecord)
+                  output=range->output;
+               currecord++;
+            }
+
+            if(item->isattrib==0)
+               output->startElement(item->strptr,item->len);
+            else
+               output->startAttribute(item->strptr,item->len);
+
+            path->AddLabel((TLabelID)id);
+         }
+      }
+      else  // A text item
+         range->contman->GetContBlock(id)->UncompressText(output);
+   }
+}
+
+static void DecodeRanges(void *arg)
+   // The main function of the worker threads
+   // Each thread decodes the next available range until no ranges are left
+{
+   ParDecodeJob   *job=(ParDecodeJob *)arg;
+   unsigned long  rangeidx;
+
+   while(1)
+   {
+      job->mutex.Lock();
+      rangeidx=job->nextrange++;
+      job->mutex.Unlock();
+
+      if(rangeidx>=job->rangenum)
+         return;
+
+      // The exception must not leave the thread - the error
+      // messages are kept with the range and the main thread prints them
+      SetThreadErrorBuffer(&(job->ranges[rangeidx].errors));
+      try{
+         DecodeRange(job->ranges+rangeidx);
+      }
+      catch(XMillException *)
+      {
+         job->ranges[rangeidx].iserror=1;
+      }
+      SetThreadErrorBuffer(NULL);
+   }
+}
+
+//**************************************************************************
+
+char UseParallelDecode(unsigned long blockidx)
+   // Returns 1, if block 'blockidx' is decoded in parallel
+{
+   unsigned long syncidx;
+
+   // The structure coder and the streamed containers cannot
+   // start at a sync point
+   if((threadnum<2)||use_structcoder||uncomprcont.IsStreaming())
+      return 0;
+
+   syncidx=blockindex.FindFirstSyncPoint(blockidx);
+   return (syncidx<blockindex.GetSyncPointNum())&&
+          (blockindex.GetSyncPoint(syncidx)->block==blockidx);
+}
+
+static void ReleaseRanges(ParDecodeJob *job,unsigned long outputnum)
+   // Releases the ranges and the memory outputs of the first 'outputnum' ranges
+{
+   for(unsigned long i=1;i<outputnum;i++)
+      job->ranges[i].output->CloseFile();
+
+   delete[] job->ranges;
+}
+
+void ParallelDecodeTreeBlock(unsigned long blockidx,XMLOutput *output)
+   // Decodes block 'blockidx' with 'threadnum' threads and prints it to 'output'
+{
+   ParDecodeJob         job;
+   ParDecodeRange       *range;
+   BlockIndexSyncPoint  *syncpoint;
+   XMillThread          *threads;
+   CurPathIterator      it;
+   unsigned long        firstsync=blockindex.FindFirstSyncPoint(blockidx),
+                        syncnum=0,outputnum,
+                        i,j,threadcount;
+   char                 *data;
+   int                  len;
+
+   while((firstsync+syncnum<blockindex.GetSyncPointNum())&&
+         (blockindex.GetSyncPoint(firstsync+syncnum)->block==blockidx))
+      syncnum++;
+
+   // Each range behind the first range starts at a sync point
+   // If there are more sync points than ranges, some sync points are skipped
+   job.rangenum=threadnum*PARDECODE_RANGESPERTHREAD;
+   if(job.rangenum>syncnum+1)
+      job.rangenum=syncnum+1;
+   job.nextrange=0;
+   job.ranges=new ParDecodeRange[job.rangenum];
+   if(job.ranges==NULL)
+      ExitNoMem();
+
+   // The first range continues the previous block
+   range=job.ranges;
+   range->contman=&uncomprcont;
+   range->path=&curpath;
+   range->output=output;
+   range->firstrecord=blockindex.GetBlock(blockidx)->firstrecord;
+   range->printall=1;
+   range->iserror=0;
+
+   outputnum=1;
+
+   try{
+      for(i=1;i<job.rangenum;i++)
+      {
+         syncpoint=blockindex.GetSyncPoint(firstsync+(i-1)*syncnum/(job.rangenum-1));
+
+         range=job.ranges+i;
+         range->contman=&(range->mycontman);
+         range->path=&(range->mypath);
+         range->output=&(range->myoutput);
+         range->firstrecord=syncpoint->record;
+         range->printall=0;
+         range->iserror=0;
+
+         job.ranges[i-1].endrecord=syncpoint->record;
+
+         // The copies are created before any range is decoded,
+         // since they start with the state after 'Init'
+         range->contman->CopyState(&uncomprcont);
+         range->contman->LoadSyncState(syncpoint->state,syncpoint->statelen);
+
+         for(j=0;j<syncpoint->depth;j++)
+         {
+            if(syncpoint->openlabels[j]>=globallabeldict.GetUncompressLabelNum())
+               ExitCorruptFile();
+            range->path->AddLabel(syncpoint->openlabels[j]);
+         }
+
+         range->output->CreateMemoryOutput();
+         range->output->InitRange(output,syncpoint->depth);
+         outputnum++;
+      }
+      job.ranges[job.rangenum-1].endrecord=RECORD_ALLRECORDS;
+   }
+   catch(XMillException *e)
+   {
+      ReleaseRanges(&job,outputnum);
+      throw e;
+   }
+
+   // We start the worker threads - the current thread works as well
+   threadcount=threadnum-1;
+   if(threadcount>job.rangenum-1)
+      threadcount=job.rangenum-1;
+
+   threads=new XMillThread[threadcount];
+   if(threads==NULL)
+      ExitNoMem();
+
+   isparallel=1;
+
+   for(i=0;i<threadcount;i++)
+   {
+      if(threads[i].Start(DecodeRanges,&job)==0)
+         // If we cannot create more threads, the remaining threads
+         // do the work
+         break;
+   }
+
+   DecodeRanges(&job);
+
+   for(i=0;i<threadcount;i++)
+      threads[i].Join();
+
+   delete[] threads;
+
+   isparallel=0;
+
+   for(i=0;i<job.rangenum;i++)
+   {
+      if(job.ranges[i].iserror)
+      {
+         AddErrorMsg(&(job.ranges[i].errors));
+         ReleaseRanges(&job,outputnum);
+         Exit();
+      }
+   }
+
+   try{
+      // Each range ends in front of a start tag, which the next range prints
+      // Therefore, a start tag that is still open must be closed
+      for(i=0;i<job.rangenum-1;i++)
+         job.ranges[i].output->FinishRange();
+
+      for(i=1;i<job.rangenum;i++)
+      {
+         data=job.ranges[i].output->GetMemoryData(&len);
+         output->StoreData(data,len);
+      }
+   }
+   catch(XMillException *e)
+   {
+      ReleaseRanges(&job,outputnum);
+      throw e;
+   }
+
+   // The output and the current path continue behind the last range
+   range=job.ranges+job.rangenum-1;
+   output->ContinueRange(range->output);
+
+   if(range->path!=&curpath)
+   {
+      curpath.Reset();
+      range->path->InitIteratorToStart(&it);
+      for(i=0;i<range->path->GetDepth();i++)
+         curpath.AddLabel(it.GotoNext());
+   }
+
+   ReleaseRanges(&job,outputnum);
+}
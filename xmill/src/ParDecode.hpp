@@ -0,0 +1,58 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements the parallel decoding of a block (option '-j').
+// If the file was compressed with options '-x' and '-y', the sync points
+// split each block into ranges of records. The ranges are decoded by several
+// threads - each range has its own copy of the container positions, the
+// user decompressor states and the current path. The first range continues
+// the output of the previous block. The other ranges are printed into memory
+// buffers, which are appended to the output in order afterwards.
+// Therefore, almost the entire decompressed block is kept in memory and
+// the memory use grows with the block size (option '-m' of the compressor).
+
+#ifndef PARDECODE_HPP
+#define PARDECODE_HPP
+
+class XMLOutput;
+
+// Each thread decodes this number of ranges on average, so that
+// all threads stay busy, even if some ranges take longer than others
+#define PARDECODE_RANGESPERTHREAD   4
+
+char UseParallelDecode(unsigned long blockidx);
+   // Returns 1, if block 'blockidx' is decoded in parallel, i.e. if option '-j'
+   // is set and the block has sync points
+
+void ParallelDecodeTreeBlock(unsigned long blockidx,XMLOutput *output);
+   // Decodes block 'blockidx' with 'threadnum' threads and prints it to 'output'
+   // The containers of the block must have been decompressed and initialized
+
+void *GetSharedBlockMem(unsigned long size);
+   // Allocates 'size' bytes in 'blockmem'. The user decompressors must allocate
+   // their memory with this function, since several threads might decode
+   // the current block at the same time
+
+#endif
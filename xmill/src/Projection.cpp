@@ -0,0 +1,507 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements the selective decompression and the projection
+// of compressed files (option '-P')
+
+#include "Projection.hpp"
+#include "VPathExprMan.hpp"
+#include "UnCompCont.hpp"
+#include "LabelDict.hpp"
+#include "StructCoder.hpp"
+#include "BlockIndex.hpp"
+#include "Input.hpp"
+
+#undef LoadString
+
+extern MemStreamer            mainmem;
+extern UncompressContainerMan uncomprcont;
+extern char                   use_structcoder;
+
+SelectiveUncompressor   *selectiveuncompressor=NULL;
+ProjectionMan           projectionman;
+
+inline char LoadTreeToken(unsigned char * &curptr,unsigned char *endptr,long *id,char *isneg)
+   // Reads the next structure token into '*id' and '*isneg'
+   // The function returns 0 if the end of the block has been reached
+{
+   if(use_structcoder)
+   {
+      unsigned long tokenval;
+
+      if(structdecoder.DecodeToken(&tokenval,isneg)==0)
+         return 0;
+      *id=(long)tokenval;
+   }
+   else
+   {
+      if(curptr>=endptr)
+         return 0;
+      *id=LoadSInt32(curptr,isneg);
+   }
+   if((*isneg==0)&&(*id>=32768L))
+   {
+      Error("Error while decompressing file!");
+      Exit();
+   }
+   return 1;
+}
+
+//**************************************************************************
+
+void SelectiveUncompressor::StartFile()
+   // Initializes the decompression of the next file
+{
+   if(labelmap==NULL)
+   {
+      labelmap=new TLabelID[MAXLABEL_NUM+1];
+      if(labelmap==NULL)
+         ExitNoMem();
+   }
+   maplabelnum=0;
+
+   if(nodestack==NULL)
+   {
+      maxnodestackdepth=256;
+      nodestack=(ProjectionPathNode **)malloc(sizeof(ProjectionPathNode *)*maxnodestackdepth);
+      if(nodestack==NULL)
+         ExitNoMem();
+   }
+
+   // The path nodes refer to the labels of the previous file
+   pathnodemem.ReleaseMemory(0);
+   for(int i=0;i<PROJECTION_HASHSIZE;i++)
+      pathnodehashtable[i]=NULL;
+
+   // The output of 'nulloutput' is simply dropped
+   nulloutput.CreateFile("");
+}
+
+void SelectiveUncompressor::FinishFile(XMLEventSink *output)
+   // Finishes the output after the last block
+{
+   nulloutput.CloseFile();
+}
+
+//**************************************************************************
+
+TLabelID SelectiveUncompressor::MapLabel(TLabelID labelid)
+   // Returns the FSM label for label 'labelid' of the file
+   // The labels are mapped when they are used first
+{
+   char           *strptr;
+   unsigned long  mystrlen;
+   unsigned char  isattrib;
+   TLabelID       fsmlabelid;
+
+   while(maplabelnum<=labelid)
+   {
+      mystrlen=globallabeldict.LookupLabel((TLabelID)maplabelnum,&strptr,&isattrib);
+
+      fsmlabelid=globallabeldict.FindLabelOrAttrib(strptr,mystrlen,isattrib);
+      if(fsmlabelid==LABEL_UNDEFINED)
+         fsmlabelid=(TLabelID)(PROJECTION_UNKNOWNLABEL|(isattrib ? ATTRIBLABEL_STARTIDX : 0));
+
+      labelmap[maplabelnum]=fsmlabelid;
+      maplabelnum++;
+   }
+   return labelmap[labelid];
+}
+
+char SelectiveUncompressor::MatchesPath(VPathExpr *pathexpr,CurPath *path)
+   // Checks whether the element or attribute at the end of 'path' matches 'pathexpr'
+   // The reverse FSM reads the path starting with the innermost label
+{
+   CurPathIterator   it;
+   FSMState          *state=pathexpr->GetReverseFSMStartState();
+   unsigned long     depth=path->GetDepth();
+
+   path->InitIterator(&it);
+
+   while((depth>0)&&(state!=NULL)&&(state->IsAccepting()==0))
+   {
+      state=state->GetNextState(MapLabel(it.GotoPrev()));
+      depth--;
+   }
+   return (state!=NULL)&&state->IsFinal();
+}
+
+void SelectiveUncompressor::StartPathNodes()
+   // Initializes the node stack for the current path 'curpath'
+{
+   CurPathIterator   it;
+   unsigned long     i;
+
+   nodestack[0]=&rootnode;
+   nodestackdepth=1;
+
+   curpath.InitIteratorToStart(&it);
+   for(i=curpath.GetDepth();i>0;i--)
+      AddPathNode(it.GotoNext());
+}
+
+ProjectionPathNode *SelectiveUncompressor::AddPathNode(TLabelID labelid)
+   // Adds the node for label 'labelid' to the node stack
+{
+   ProjectionPathNode   *parent=nodestack[nodestackdepth-1];
+   unsigned long        hashidx=(((unsigned long)parent)+labelid)&PROJECTION_HASHMASK;
+   ProjectionPathNode   *node=pathnodehashtable[hashidx];
+   unsigned long        i;
+
+   while((node!=NULL)&&((node->parent!=parent)||(node->labelid!=labelid)))
+      node=node->nextsamehash;
+
+   if(node==NULL)
+      // A new path? ==> We evaluate the path expressions
+   {
+      matchpath.Reset();
+      for(i=1;i<nodestackdepth;i++)
+         matchpath.AddLabel(nodestack[i]->labelid);
+      matchpath.AddLabel(labelid);
+
+      node=(ProjectionPathNode *)pathnodemem.GetByteBlock(sizeof(ProjectionPathNode));
+      node->parent=parent;
+      node->labelid=labelid;
+      node->isattrib=ISATTRIB(MapLabel(labelid)) ? 1 : 0;
+      node->matches=ComputeMatches(&matchpath);
+
+      node->nextsamehash=pathnodehashtable[hashidx];
+      pathnodehashtable[hashidx]=node;
+   }
+
+   if(nodestackdepth==maxnodestackdepth)
+   {
+      maxnodestackdepth*=2;
+      nodestack=(ProjectionPathNode **)realloc(nodestack,sizeof(ProjectionPathNode *)*maxnodestackdepth);
+      if(nodestack==NULL)
+         ExitNoMem();
+   }
+   nodestack[nodestackdepth++]=node;
+   return node;
+}
+
+inline void SelectiveUncompressor::AddToken(unsigned long token)
+   // Appends a token to the token array
+{
+   if(tokennum==maxtokennum)
+   {
+      maxtokennum=(maxtokennum==0) ? 65536 : maxtokennum*2;
+      tokens=(unsigned long *)realloc(tokens,sizeof(unsigned long)*maxtokennum);
+      if(tokens==NULL)
+         ExitNoMem();
+   }
+   tokens[tokennum++]=token;
+}
+
+//**************************************************************************
+
+void SelectiveUncompressor::MarkNeededBlocks(UncompressContainer *treecont)
+   // Scans the structure of the block and marks the container blocks
+   // that have text items inside needed elements
+{
+   unsigned char     *curptr=treecont->GetDataPtr(),
+                     *endptr=curptr+treecont->GetSize();
+   unsigned long     scanneededdepth=GetNeededDepth();
+   unsigned long     i;
+   long              id;
+   char              isneg;
+
+   // First, we assume that no text items are needed
+   for(i=1;i<uncomprcont.GetBlockNum();i++)
+      uncomprcont.GetContBlock(i)->SetSkipped(1);
+
+   // The scan starts with the current path
+   StartPathNodes();
+
+   if(use_structcoder)
+      structdecoder.StartBlock(curptr,treecont->GetSize());
+
+   tokennum=0;
+
+   while(LoadTreeToken(curptr,endptr,&id,&isneg))
+   {
+      AddToken(isneg ? (PROJECTION_TEXTTOKEN|(unsigned long)id) : (unsigned long)id);
+
+      if(isneg==0)
+      {
+         switch(id)
+         {
+         case TREETOKEN_ENDLABEL:
+         case TREETOKEN_EMPTYENDLABEL:
+            if(GetPathNodeDepth()==scanneededdepth)
+               scanneededdepth=0;
+            RemovePathNode();
+            break;
+
+         case TREETOKEN_WHITESPACE:
+         case TREETOKEN_ATTRIBWHITESPACE:
+         case TREETOKEN_SPECIAL:
+            break;
+
+         default: // A start label
+            if((AddPathNode((TLabelID)(id-LABELIDX_TOKENOFFS))->matches&PROJECTION_NEEDED)&&
+               (scanneededdepth==0))
+               scanneededdepth=GetPathNodeDepth();
+         }
+      }
+      else  // A text item
+      {
+         if((id==0)||((unsigned long)id>=uncomprcont.GetBlockNum()))
+            ExitCorruptFile();
+
+         if(scanneededdepth>0)
+            uncomprcont.GetContBlock(id)->SetSkipped(0);
+      }
+   }
+}
+
+void SelectiveUncompressor::UncompressBlock(Input *input,BlockIndexEntry *indexentry,XMLEventSink *output)
+   // Decompresses the large containers of the current block and produces
+   // the output. If 'indexentry' is not NULL, the large containers that
+   // are not needed are skipped.
+{
+   UncompressContainerBlock   *contblock=uncomprcont.GetContBlock(0);
+   unsigned long              *compressedsizes=NULL;
+   unsigned long              i,largecontnum=0;
+
+   if(indexentry!=NULL)
+   {
+      // The index must describe the same large containers
+      for(i=0;i<uncomprcont.GetBlockNum();i++)
+         largecontnum+=uncomprcont.GetContBlock(i)->GetLargeContNum();
+
+      if(largecontnum!=indexentry->largecontnum)
+         ExitCorruptFile();
+
+      compressedsizes=indexentry->largecontsizes;
+   }
+
+   // The structure, white space and special containers are always needed
+   contblock->UncompressLargeContainers(input);
+   if(compressedsizes!=NULL)
+      compressedsizes+=contblock->GetLargeContNum();
+
+   MarkNeededBlocks(contblock->GetContainer(0));
+
+   for(i=1;i<uncomprcont.GetBlockNum();i++)
+   {
+      contblock=uncomprcont.GetContBlock(i);
+
+      // Without the index, we must decompress the containers to
+      // find the following containers
+      if(contblock->IsSkipped()&&(compressedsizes!=NULL))
+         contblock->SkipLargeContainers(input,compressedsizes);
+      else
+         contblock->UncompressLargeContainers(input);
+
+      if(compressedsizes!=NULL)
+         compressedsizes+=contblock->GetLargeContNum();
+   }
+
+   uncomprcont.Init();
+
+   // The second pass starts again with the current path
+   StartPathNodes();
+
+   contblock=uncomprcont.GetContBlock(0);
+   DecodeBlock(contblock->GetContainer(1),contblock->GetContainer(2),output);
+}
+
+//**************************************************************************
+
+void ProjectionMan::AddPath(char * &str,char *endptr)
+   // Adds the projection path between 'str' and 'endptr'
+{
+   ProjectionPath *path=(ProjectionPath *)mainmem.GetByteBlock(sizeof(ProjectionPath));
+   char           *startptr=str,*ptr;
+
+   path->pathexpr=new(&mainmem) VPathExpr();
+   path->pathexpr->CreateProjectionFromString(str,endptr);
+
+   // The projection keeps whole elements - an attribute
+   // cannot be kept without its element
+   ptr=str;
+   while((ptr>startptr)&&(ptr[-1]!='/'))
+   {
+      ptr--;
+      if(*ptr=='@')
+      {
+         Error("Projection path '");
+         ErrorCont(startptr,str-startptr);
+         ErrorCont("' ends with an attribute - option -P only selects elements!");
+         Exit();
+      }
+   }
+
+   path->next=paths;
+   paths=path;
+
+   selectiveuncompressor=this;
+}
+
+void ProjectionMan::StartFile()
+   // Initializes the projection for the next file
+{
+   SelectiveUncompressor::StartFile();
+   matchdepth=0;
+}
+
+void ProjectionMan::FinishFile(XMLEventSink *output)
+   // Closes the matching element that is still open
+{
+   char           *strptr;
+   unsigned long  mystrlen;
+   unsigned char  isattrib;
+
+   while((matchdepth>0)&&(curpath.GetDepth()>=matchdepth))
+   {
+      mystrlen=globallabeldict.LookupLabel(curpath.RemoveLabel(),&strptr,&isattrib);
+      output->endElement(strptr,mystrlen);
+   }
+   matchdepth=0;
+
+   SelectiveUncompressor::FinishFile(output);
+}
+
+unsigned char ProjectionMan::ComputeMatches(CurPath *path)
+   // Checks whether the element at the end of 'path' matches one of the projection paths
+{
+   ProjectionPath    *projpath=paths;
+   CurPathIterator   it;
+
+   // Only elements can match
+   path->InitIterator(&it);
+   if(ISATTRIB(MapLabel(it.GotoPrev())))
+      return 0;
+
+   while(projpath!=NULL)
+   {
+      if(MatchesPath(projpath->pathexpr,path))
+         return PROJECTION_NEEDED;
+
+      projpath=projpath->next;
+   }
+   return 0;
+}
+
+void ProjectionMan::DecodeBlock(UncompressContainer *whitespacecont,UncompressContainer *specialcont,XMLEventSink *output)
+   // Prints the matching elements of the block
+   // This is the same loop as in 'DecodeTreeBlock', but everything
+   // outside of matching elements is dropped
+{
+   unsigned long     *curtoken=tokens,*endtoken=tokens+tokennum;
+   char              *strptr;
+   unsigned long     mystrlen;
+   unsigned char     isattrib;
+   long              id;
+   UncompressContainerBlock *contblock;
+
+   while(curtoken<endtoken)
+   {
+      id=(long)(*curtoken&~PROJECTION_TEXTTOKEN);
+
+      if((*(curtoken++)&PROJECTION_TEXTTOKEN)==0)
+      {
+         switch(id)
+         {
+         case TREETOKEN_ENDLABEL:
+            mystrlen=globallabeldict.LookupLabel(curpath.RemoveLabel(),&strptr,&isattrib);
+            RemovePathNode();
+            if(matchdepth>0)
+            {
+               if(isattrib==0)
+                  output->endElement(strptr,mystrlen);
+               else
+                  output->endAttribute(strptr,mystrlen);
+
+               if(curpath.GetDepth()<matchdepth)
+                  matchdepth=0;
+            }
+            break;
+
+         case TREETOKEN_EMPTYENDLABEL:
+            curpath.RemoveLabel();
+            RemovePathNode();
+            if(matchdepth>0)
+            {
+               output->endEmptyElement();
+
+               if(curpath.GetDepth()<matchdepth)
+                  matchdepth=0;
+            }
+            break;
+
+         case TREETOKEN_WHITESPACE:
+            mystrlen=whitespacecont->LoadUInt32();
+            strptr=(char *)whitespacecont->GetDataPtr(mystrlen);
+            if(matchdepth>0)
+               output->whitespaces(strptr,mystrlen);
+            break;
+
+         case TREETOKEN_ATTRIBWHITESPACE:
+            mystrlen=whitespacecont->LoadUInt32();
+            strptr=(char *)whitespacecont->GetDataPtr(mystrlen);
+            if(matchdepth>0)
+               output->attribWhitespaces(strptr,mystrlen);
+            break;
+
+         case TREETOKEN_SPECIAL:
+            strptr=(char *)specialcont->LoadString((unsigned *)&mystrlen);
+            if(matchdepth>0)
+               output->special(strptr,mystrlen);
+            break;
+
+         default: // A start label
+            id-=LABELIDX_TOKENOFFS;
+            curpath.AddLabel((TLabelID)id);
+
+            if((AddPathNode((TLabelID)id)->matches&PROJECTION_NEEDED)&&(matchdepth==0))
+               matchdepth=curpath.GetDepth();
+
+            if(matchdepth>0)
+            {
+               mystrlen=globallabeldict.LookupLabel((TLabelID)id,&strptr,&isattrib);
+               if(isattrib==0)
+                  output->startElement(strptr,mystrlen);
+               else
+                  output->startAttribute(strptr,mystrlen);
+            }
+         }
+      }
+      else  // A text item
+      {
+         contblock=uncomprcont.GetContBlock(id);
+
+         // Text items of needed container blocks outside of matching
+         // elements must still be decompressed to advance the containers
+         if(matchdepth>0)
+            contblock->UncompressText(output);
+         else
+         {
+            if(contblock->IsSkipped()==0)
+               contblock->UncompressText(&nulloutput);
+         }
+      }
+   }
+}
@@ -0,0 +1,214 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements the selective decompression of compressed files.
+// Only the text items inside some elements of interest are needed - this is
+// used for the projection (option '-P') and for queries (option '-q').
+//
+// For each block, the structure container is decoded first in order to find the
+// container blocks with text items inside needed elements. All other container
+// blocks are not needed - if the file has a block index, their large containers
+// are skipped without reading them. Otherwise, they are decompressed, but not used.
+// The first pass keeps the decoded tokens, so that the second pass, which
+// produces the output, doesn't need to decode the structure again.
+//
+// The path expressions are parsed into the same FSMs as the container path
+// expressions. The labels of the FSMs are predefined labels of the label dictionary,
+// while the labels in the structure are the labels loaded from the file.
+// Hence, we map each label from the file to the corresponding FSM label.
+//
+// Similar to the backward dataguide of the compressor (see PathTree.hpp),
+// the paths of the document are kept in a tree of path nodes. Each node
+// stores whether its path matches the path expressions, so that the FSMs
+// are only evaluated once for each distinct path.
+
+#ifndef PROJECTION_HPP
+#define PROJECTION_HPP
+
+#include "Types.hpp"
+#include "CurPath.hpp"
+#include "XMLOutput.hpp"
+#include "MemStreamer.hpp"
+
+class VPathExpr;
+class Input;
+class UncompressContainer;
+struct BlockIndexEntry;
+
+// Labels of the file that do not occur in any path expression are
+// mapped to this label (with the attribute bit for attributes)
+#define PROJECTION_UNKNOWNLABEL  ((TLabelID)(ATTRIBLABEL_STARTIDX-1))
+
+// Marks text tokens in the token array
+#define PROJECTION_TEXTTOKEN     0x80000000UL
+
+// The size of the hash table for the path nodes
+#define PROJECTION_HASHSIZE      1024
+#define PROJECTION_HASHMASK      1023
+
+// The match flag for needed elements - i.e. elements whose
+// text items must be decompressed
+#define PROJECTION_NEEDED        1
+
+struct ProjectionPathNode
+   // Represents the path of an element or attribute in the document
+{
+   ProjectionPathNode   *parent;       // The node of the parent element
+   ProjectionPathNode   *nextsamehash; // The next node with the same hash value
+   TLabelID             labelid;       // The label of the element or attribute
+   unsigned char        isattrib;      // Is 1, if the node is an attribute
+   unsigned char        matches;       // The match flags
+};
+
+class SelectiveUncompressor
+   // The base class for the projection and the queries
+{
+   TLabelID       *labelmap;     // Maps the labels of the file to the labels of the FSMs
+   unsigned long  maplabelnum;   // The number of labels that are already mapped
+
+   CurPath        matchpath;     // The path that is matched against the path expressions
+
+   MemStreamer          pathnodemem;   // The memory for the path nodes
+   ProjectionPathNode   *pathnodehashtable[PROJECTION_HASHSIZE];
+   ProjectionPathNode   rootnode;      // The node of the empty path
+
+   ProjectionPathNode   **nodestack;   // The nodes of the current path
+   unsigned long        nodestackdepth,maxnodestackdepth;
+
+   void MarkNeededBlocks(UncompressContainer *treecont);
+      // Scans the structure of the block and marks the container blocks
+      // that have text items inside needed elements
+
+   void AddToken(unsigned long token);
+      // Appends a token to the token array
+
+protected:
+   XMLOutput      nulloutput;    // Receives the text items that are not used
+
+   // The tokens of the current block
+   // Text tokens have bit PROJECTION_TEXTTOKEN set
+   unsigned long  *tokens;
+   unsigned long  tokennum,maxtokennum;
+
+   TLabelID MapLabel(TLabelID labelid);
+      // Returns the FSM label for label 'labelid' of the file
+
+   char MatchesPath(VPathExpr *pathexpr,CurPath *path);
+      // Checks whether the element or attribute at the end of 'path' matches 'pathexpr'
+
+   void StartPathNodes();
+      // Initializes the node stack for the current path 'curpath'
+
+   ProjectionPathNode *AddPathNode(TLabelID labelid);
+      // Adds the node for label 'labelid' to the node stack
+
+   void RemovePathNode()   {  nodestackdepth--;  }
+      // Removes the last node from the node stack
+
+   unsigned long GetPathNodeDepth()   {  return nodestackdepth-1;  }
+      // Returns the depth of the path of the node stack
+
+   virtual unsigned char ComputeMatches(CurPath *path)=0;
+      // Computes the match flags for the element or attribute at the end of 'path'
+      // Flag PROJECTION_NEEDED means that the text items inside of it are needed
+
+   virtual unsigned long GetNeededDepth()=0;
+      // Returns the depth of the needed element that is still open
+      // at the end of the previous block - or 0, if there is none
+
+   virtual void DecodeBlock(UncompressContainer *whitespacecont,UncompressContainer *specialcont,XMLEventSink *output)=0;
+      // Produces the output for the tokens of the current block
+
+public:
+   SelectiveUncompressor()
+   {
+      labelmap=NULL;
+      maplabelnum=0;
+      nodestack=NULL;
+      nodestackdepth=maxnodestackdepth=0;
+      tokens=NULL;
+      tokennum=maxtokennum=0;
+   }
+
+   virtual void StartFile();
+      // Initializes the decompression of the next file
+
+   void UncompressBlock(Input *input,BlockIndexEntry *indexentry,XMLEventSink *output);
+      // Decompresses the large containers of the current block and produces
+      // the output. If 'indexentry' is not NULL, the large containers that
+      // are not needed are skipped.
+
+   virtual void FinishFile(XMLEventSink *output);
+      // Finishes the output after the last block
+};
+
+// The selective decompression that is used - or NULL, if
+// the entire file is decompressed
+extern SelectiveUncompressor *selectiveuncompressor;
+
+//**************************************************************************
+
+struct ProjectionPath
+   // A single projection path
+{
+   VPathExpr      *pathexpr;  // The path expression with the reverse FSM
+   ProjectionPath *next;      // The next projection path
+};
+
+class ProjectionMan : public SelectiveUncompressor
+{
+   ProjectionPath *paths;        // The list of projection paths
+
+   unsigned long  matchdepth;    // The depth of the matching element that is currently printed
+                                 // or 0, if we are not inside a matching element
+
+   unsigned char ComputeMatches(CurPath *path);
+      // Checks whether the element at the end of 'path' matches one of the projection paths
+
+   unsigned long GetNeededDepth()   {  return matchdepth;   }
+
+   void DecodeBlock(UncompressContainer *whitespacecont,UncompressContainer *specialcont,XMLEventSink *output);
+      // Prints the matching elements of the block
+
+public:
+   ProjectionMan()
+   {
+      paths=NULL;
+      matchdepth=0;
+   }
+
+   void AddPath(char * &str,char *endptr);
+      // Adds the projection path between 'str' and 'endptr'
+
+   void StartFile();
+      // Initializes the projection for the next file
+
+   void FinishFile(XMLEventSink *output);
+      // Closes the matching element that is still open
+      // (This can only happen if not all blocks were decompressed)
+};
+
+extern ProjectionMan projectionman;
+
+#endif
@@ -0,0 +1,145 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements the push interface of the compressor
+
+#include <string.h>
+
+#include "PushParse.hpp"
+#include "Types.hpp"
+
+extern InputSource *compress_source;
+
+void Compress(char *srcfile,char *destfile);
+
+//**************************************************************************
+
+void PushCompressor::CompressThread(void *pushcompressor)
+   // The main function of the compressor thread
+{
+   PushCompressor *pc=(PushCompressor *)pushcompressor;
+   char           iserror=0;
+
+   try{
+      Compress(NULL,pc->destfile);
+   }
+   catch(XMillException *)
+      // An error occurred
+   {
+      PrintErrorMsg();
+      iserror=1;
+   }
+
+   // The caller might still wait for the parser
+   pc->mutex.Lock();
+   pc->iserror=iserror;
+   pc->isdone=1;
+   pc->changed.SignalAll();
+   pc->mutex.Unlock();
+}
+
+unsigned PushCompressor::ReadData(char *dest,unsigned bytecount)
+   // Copies the next data of the current chunk for the parser
+{
+   mutex.Lock();
+
+   while((chunklen==0)&&(isfinished==0))
+      changed.Wait(&mutex);
+
+   if(bytecount>chunklen)
+      bytecount=chunklen;
+
+   mymemcpy(dest,chunkptr,bytecount);
+   chunkptr+=bytecount;
+   chunklen-=bytecount;
+
+   // If the chunk is used up, the caller can push the next one
+   if(chunklen==0)
+      changed.SignalAll();
+
+   mutex.Unlock();
+   return bytecount;
+}
+
+//**************************************************************************
+
+char PushCompressor::Start(char *mydestfile)
+   // Starts the compression into file 'mydestfile'
+{
+   chunkptr=NULL;
+   chunklen=0;
+   isfinished=isdone=iserror=0;
+   destfile=mydestfile;
+
+   compress_source=this;
+
+   if(thread.Start(CompressThread,this)==0)
+   {
+      compress_source=NULL;
+      Error("Could not create the compressor thread!");
+      return 0;
+   }
+   return 1;
+}
+
+char PushCompressor::Push(char *data,unsigned long len)
+   // Passes the next 'len' bytes of the document to the compressor
+{
+   char result;
+
+   if(len==0)
+      // An empty chunk would denote the end of the data
+      return 1;
+
+   mutex.Lock();
+
+   chunkptr=data;
+   chunklen=len;
+   changed.SignalAll();
+
+   // We wait until the parser copied the entire chunk
+   while((chunklen>0)&&(isdone==0))
+      changed.Wait(&mutex);
+
+   chunklen=0;
+   result=(isdone&&iserror) ? 0 : 1;
+
+   mutex.Unlock();
+   return result;
+}
+
+char PushCompressor::Finish()
+   // Denotes the end of the document and waits until the compression is finished
+{
+   mutex.Lock();
+   isfinished=1;
+   changed.SignalAll();
+   mutex.Unlock();
+
+   thread.Join();
+
+   compress_source=NULL;
+   return iserror ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements the push interface of the compressor.
+// Normally, the parser pulls the data from a file. With the push interface,
+// the caller feeds arbitrary chunks of data - for example messages received
+// from a socket - and the document is compressed without writing it to a
+// temporary file first.
+//
+// The parser reads its data through 'FillBuf' and continues across buffer
+// boundaries anyway. Hence, the compressor simply runs in a separate thread
+// and reads the chunks from the push compressor, which acts as the data
+// source of the parser. 'Push' waits until the parser has copied the entire
+// chunk into its buffer, so that the caller can reuse the memory afterwards.
+//
+// Since the compressor uses global state, only one compression can run at a time.
+// Example:
+//
+//    PushCompressor pushcompressor;
+//
+//    pushcompressor.Start("out.xmi");
+//    while(...)
+//       pushcompressor.Push(chunk,chunklen);
+//    pushcompressor.Finish();
+
+#ifndef PUSHPARSE_HPP
+#define PUSHPARSE_HPP
+
+#include "File.hpp"
+#include "Thread.hpp"
+
+class PushCompressor : public InputSource
+{
+   XMillMutex     mutex;         // Protects the following fields
+   XMillCondition changed;       // Is signaled if one of the fields changed
+
+   char           *chunkptr;     // The rest of the current chunk
+   unsigned long  chunklen;
+   char           isfinished;    // Is 1, if the caller pushed the last chunk
+   char           isdone;        // Is 1, if the compressor finished
+   char           iserror;       // Is 1, if the compression failed
+
+   char           *destfile;     // The output file
+   XMillThread    thread;        // The thread of the compressor
+
+   static void CompressThread(void *pushcompressor);
+      // The main function of the compressor thread
+
+   unsigned ReadData(char *dest,unsigned bytecount);
+      // Copies the next data of the current chunk for the parser
+      // If there is no data, the function waits until the next chunk is pushed
+
+public:
+   PushCompressor()
+   {
+      chunkptr=NULL;
+      chunklen=0;
+      isfinished=isdone=iserror=0;
+      destfile=NULL;
+   }
+
+   char Start(char *mydestfile);
+      // Starts the compression into file 'mydestfile' - or the standard output,
+      // if 'mydestfile==NULL'. The file name must be valid until 'Finish' is called.
+      // The function returns 0, if the compressor could not be started.
+
+   char Push(char *data,unsigned long len);
+      // Passes the next 'len' bytes of the document to the compressor
+      // The function returns 0, if the compression failed
+
+   char Finish();
+      // Denotes the end of the document and waits until the compression is finished
+      // The function returns 0, if the compression failed
+};
+
+#endif
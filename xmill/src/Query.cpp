@@ -0,0 +1,376 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements simple queries over compressed files (option '-q')
+
+#include "Query.hpp"
+#include "VPathExprMan.hpp"
+#include "UnCompCont.hpp"
+
+extern MemStreamer            mainmem;
+extern UncompressContainerMan uncomprcont;
+
+QueryMan queryman;
+
+//**************************************************************************
+
+void QueryMan::QueryParseError(char *errmsg)
+   // Prints an error message for the query and exits
+{
+   Error("Invalid query '");
+   ErrorCont(querystr);
+   ErrorCont("': ");
+   ErrorCont(errmsg);
+   Exit();
+}
+
+VPathExpr *QueryMan::CreatePath(char *str1,char *endptr1,char *str2,char *endptr2,char addslash)
+   // Creates the path expression for the concatenation of the two strings
+   // If 'addslash' is 1, then the two strings are separated by '/'
+{
+   unsigned long  len1=endptr1-str1+addslash,
+                  len2=endptr2-str2;
+   char           *pathstr=mainmem.GetByteBlock(len1+len2);
+   char           *ptr=pathstr;
+   VPathExpr      *pathexpr;
+
+   memcpy(pathstr,str1,len1-addslash);
+   if(addslash)
+      pathstr[len1-1]='/';
+   memcpy(pathstr+len1,str2,len2);
+
+   pathexpr=new(&mainmem) VPathExpr();
+   pathexpr->CreateProjectionFromString(ptr,pathstr+len1+len2);
+   return pathexpr;
+}
+
+void QueryMan::SetQuery(char * &str)
+   // Parses the query starting at 'str' and moves 'str' to the end of the query
+   // A query has the form 'path' or 'path[condpath]resultpath'
+   // or 'path[condpath="value"]resultpath'
+{
+   char  *endptr=str,*predptr,*condendptr,*ptr;
+   char  quote=0;
+
+   // The query ends with the first white space outside of a quoted string
+   while((*endptr!=0)&&
+         ((quote!=0)||((*endptr!=' ')&&(*endptr!='\t')&&(*endptr!='\r')&&(*endptr!='\n'))))
+   {
+      if(quote!=0)
+      {
+         if(*endptr==quote)
+            quote=0;
+      }
+      else
+      {
+         if((*endptr=='"')||(*endptr=='\''))
+            quote=*endptr;
+      }
+      endptr++;
+   }
+
+   // We keep a copy of the query for the error messages
+   querystr=mainmem.GetByteBlock(endptr-str+1);
+   memcpy(querystr,str,endptr-str);
+   querystr[endptr-str]=0;
+
+   str=endptr;
+
+   endptr=querystr+strlen(querystr);
+   predptr=querystr;
+
+   while((predptr<endptr)&&(*predptr!='['))
+      predptr++;
+
+   if(predptr==endptr)
+      // No predicate?
+   {
+      resultpath=CreatePath(querystr,endptr);
+      selectiveuncompressor=this;
+      return;
+   }
+
+   condendptr=predptr+1;
+   while((condendptr<endptr)&&(*condendptr!='=')&&(*condendptr!=']'))
+      condendptr++;
+
+   if(condendptr==predptr+1)
+      QueryParseError("Path expected after '['");
+
+   if(condendptr==endptr)
+      QueryParseError("Character ']' expected");
+
+   ptr=condendptr;
+   if(*ptr=='=')
+      // We read the value enclosed in '"' or '''
+   {
+      ptr++;
+      if((ptr==endptr)||((*ptr!='"')&&(*ptr!='\'')))
+         QueryParseError("Quoted string expected after '='");
+
+      condvalue=ptr+1;
+      ptr=condvalue;
+      while((ptr<endptr)&&(*ptr!=condvalue[-1]))
+         ptr++;
+
+      if(ptr==endptr)
+         QueryParseError("Missing closing quote");
+
+      condvaluelen=ptr-condvalue;
+      ptr++;
+
+      if((ptr==endptr)||(*ptr!=']'))
+         QueryParseError("Character ']' expected");
+   }
+   ptr++;
+
+   anchorpath=CreatePath(querystr,predptr);
+   condpath=CreatePath(querystr,predptr,predptr+1,condendptr,1);
+
+   if(ptr==endptr)
+      // Without a path after the predicate, we print the elements themselves
+      resultpath=anchorpath;
+   else
+      resultpath=CreatePath(querystr,predptr,ptr,endptr);
+
+   selectiveuncompressor=this;
+}
+
+//**************************************************************************
+
+void QueryMan::StartFile()
+   // Initializes the evaluation for the next file
+{
+   SelectiveUncompressor::StartFile();
+
+   anchordepth=conddepth=resultdepth=0;
+   iscondtrue=0;
+   inattrib=0;
+
+   resultoutput.CreateMemoryOutput();
+   condoutput.CreateMemoryOutput();
+}
+
+void QueryMan::FinishFile(XMLEventSink *output)
+   // Prints the results that are still pending
+{
+   if(resultdepth>0)
+      resultoutput.StoreNewline();
+
+   if((anchorpath==NULL)||iscondtrue)
+      FlushResults(output);
+
+   resultoutput.CloseFile();
+   condoutput.CloseFile();
+
+   SelectiveUncompressor::FinishFile(output);
+}
+
+inline void QueryMan::FlushResults(XMLEventSink *output)
+   // Moves the results to the output
+{
+   int   len;
+   char  *ptr=resultoutput.GetMemoryData(&len);
+
+   // The results are already printed as XML text
+   output->characters(ptr,len);
+   resultoutput.SetMemoryDataSize(0);
+}
+
+//**************************************************************************
+
+unsigned char QueryMan::ComputeMatches(CurPath *path)
+   // Computes the match flags for the element or attribute at the end of 'path'
+   // The text items of result elements and of elements with a value
+   // tested by the predicate are needed
+{
+   unsigned char matches=0;
+
+   if(MatchesPath(resultpath,path))
+      matches|=QUERY_RESULT|PROJECTION_NEEDED;
+
+   if(anchorpath!=NULL)
+   {
+      if(MatchesPath(anchorpath,path))
+         matches|=QUERY_ANCHOR;
+
+      if(MatchesPath(condpath,path))
+      {
+         matches|=QUERY_COND;
+         if(condvalue!=NULL)
+            matches|=PROJECTION_NEEDED;
+      }
+   }
+   return matches;
+}
+
+unsigned long QueryMan::GetNeededDepth()
+   // Returns the depth of the outermost result or tested element that is open
+{
+   if(conddepth==0)
+      return resultdepth;
+   if(resultdepth==0)
+      return conddepth;
+   return (conddepth<resultdepth) ? conddepth : resultdepth;
+}
+
+void QueryMan::DecodeBlock(UncompressContainer *whitespacecont,UncompressContainer *specialcont,XMLEventSink *output)
+   // Evaluates the query for the tokens of the current block
+   // White spaces and special sections are not part of the values
+{
+   unsigned long     *curtoken=tokens,*endtoken=tokens+tokennum;
+   unsigned long     depth;
+   long              id;
+   char              incond,inresult;
+   ProjectionPathNode   *node;
+   char              *ptr;
+   int               len,startlen;
+   UncompressContainerBlock *contblock;
+
+   while(curtoken<endtoken)
+   {
+      id=(long)(*curtoken&~PROJECTION_TEXTTOKEN);
+
+      if((*(curtoken++)&PROJECTION_TEXTTOKEN)==0)
+      {
+         switch(id)
+         {
+         case TREETOKEN_ENDLABEL:
+         case TREETOKEN_EMPTYENDLABEL:
+            depth=curpath.GetDepth();
+
+            if(depth==conddepth)
+               // We compare the value of the tested element
+            {
+               ptr=condoutput.GetMemoryData(&len);
+               if(((unsigned long)len==condvaluelen)&&(memcmp(ptr,condvalue,len)==0))
+                  iscondtrue=1;
+               condoutput.SetMemoryDataSize(0);
+               conddepth=0;
+            }
+            if(depth==resultdepth)
+            {
+               resultoutput.StoreNewline();
+               resultdepth=0;
+
+               if(anchorpath==NULL)
+                  FlushResults(output);
+            }
+            if(depth==anchordepth)
+               // The results are only printed if the predicate holds
+            {
+               if(iscondtrue)
+                  FlushResults(output);
+               else
+                  resultoutput.SetMemoryDataSize(0);
+               anchordepth=0;
+            }
+            inattrib=0;
+            curpath.RemoveLabel();
+            RemovePathNode();
+            break;
+
+         case TREETOKEN_WHITESPACE:
+         case TREETOKEN_ATTRIBWHITESPACE:
+         case TREETOKEN_SPECIAL:
+            break;
+
+         default: // A start label
+            id-=LABELIDX_TOKENOFFS;
+            curpath.AddLabel((TLabelID)id);
+            depth=curpath.GetDepth();
+
+            node=AddPathNode((TLabelID)id);
+            if(node->isattrib)
+               inattrib=1;
+
+            if(anchorpath!=NULL)
+            {
+               if(anchordepth==0)
+               {
+                  if((node->isattrib==0)&&(node->matches&QUERY_ANCHOR))
+                  {
+                     anchordepth=depth;
+                     iscondtrue=0;
+                  }
+                  else
+                     // Outside of the anchor elements, there are no results
+                     break;
+               }
+               else
+               {
+                  if((iscondtrue==0)&&(conddepth==0)&&(node->matches&QUERY_COND))
+                  {
+                     if(condvalue==NULL)
+                        iscondtrue=1;
+                     else
+                        conddepth=depth;
+                  }
+               }
+            }
+            if((resultdepth==0)&&(node->matches&QUERY_RESULT))
+               resultdepth=depth;
+         }
+      }
+      else  // A text item
+      {
+         contblock=uncomprcont.GetContBlock(id);
+
+         // The values of attributes only belong to the attribute itself
+         depth=curpath.GetDepth();
+         incond=(conddepth>0)&&((inattrib==0)||(depth==conddepth));
+         inresult=(resultdepth>0)&&((inattrib==0)||(depth==resultdepth));
+
+         // The values are compared and printed without the XML escapes
+         if(incond)
+         {
+            condoutput.GetMemoryData(&startlen);
+            contblock->UncompressText(&condoutput);
+            ptr=condoutput.GetMemoryData(&len);
+            len=startlen+UnescapeXMLText(ptr+startlen,len-startlen);
+            condoutput.SetMemoryDataSize(len);
+
+            if(inresult)
+               resultoutput.StoreData(ptr+startlen,len-startlen);
+         }
+         else
+         {
+            if(inresult)
+            {
+               resultoutput.GetMemoryData(&startlen);
+               contblock->UncompressText(&resultoutput);
+               ptr=resultoutput.GetMemoryData(&len);
+               resultoutput.SetMemoryDataSize(startlen+UnescapeXMLText(ptr+startlen,len-startlen));
+            }
+            else
+            {
+               // Text items of needed container blocks must still
+               // be decompressed to advance the containers
+               if(contblock->IsSkipped()==0)
+                  contblock->UncompressText(&nulloutput);
+            }
+         }
+      }
+   }
+}
@@ -0,0 +1,111 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements simple queries over compressed files (option '-q').
+// A query is a path expression with at most one predicate, for example
+//
+//    //entry[organism="Human"]/name
+//
+// The decompressor prints the text of each selected element (or attribute)
+// in a separate line - no XML is produced. The predicate either compares the
+// text of a child element or attribute with a string or - without '="..."' -
+// only tests whether it exists. The part before the predicate selects the
+// elements the predicate applies to. Such elements are not nested, i.e. an
+// element inside a selected element is never selected itself.
+//
+// The query is evaluated by the selective decompression, i.e. only the
+// container blocks with text items inside the compared elements and the
+// result elements are decompressed.
+
+#ifndef QUERY_HPP
+#define QUERY_HPP
+
+#include "Projection.hpp"
+
+// The match flags of the path nodes (in addition to PROJECTION_NEEDED)
+#define QUERY_ANCHOR    2  // The path matches the path in front of the predicate
+#define QUERY_COND      4  // The path matches the path of the predicate
+#define QUERY_RESULT    8  // The path matches the result path
+
+class QueryMan : public SelectiveUncompressor
+{
+   char           *querystr;     // The query string
+
+   VPathExpr      *anchorpath;   // The path in front of the predicate - or NULL
+                                 // if the query has no predicate
+   VPathExpr      *condpath;     // The path of the element tested by the predicate
+   VPathExpr      *resultpath;   // The path of the result elements
+
+   char           *condvalue;    // The value of the predicate - or NULL,
+   unsigned long  condvaluelen;  // if the predicate only tests the existence
+
+   unsigned long  anchordepth;   // The depths of the elements that are currently open
+   unsigned long  conddepth;     // or 0, if there is no such element
+   unsigned long  resultdepth;
+   char           iscondtrue;    // Is 1, if the predicate holds for the current anchor element
+   char           inattrib;      // Is 1, if we are inside of an attribute
+
+   XMLOutput      resultoutput;  // Keeps the results until the predicate is known
+   XMLOutput      condoutput;    // Keeps the text of the element tested by the predicate
+
+   void QueryParseError(char *errmsg);
+      // Prints an error message for the query and exits
+
+   VPathExpr *CreatePath(char *str1,char *endptr1,char *str2=NULL,char *endptr2=NULL,char addslash=0);
+      // Creates the path expression for the concatenation of the two strings
+
+   void FlushResults(XMLEventSink *output);
+      // Moves the results to the output
+
+   unsigned char ComputeMatches(CurPath *path);
+      // Computes the match flags for the element or attribute at the end of 'path'
+
+   unsigned long GetNeededDepth();
+
+   void DecodeBlock(UncompressContainer *whitespacecont,UncompressContainer *specialcont,XMLEventSink *output);
+      // Evaluates the query for the tokens of the current block
+
+public:
+   QueryMan()
+   {
+      querystr=NULL;
+      anchorpath=condpath=resultpath=NULL;
+      condvalue=NULL;
+      condvaluelen=0;
+   }
+
+   void SetQuery(char * &str);
+      // Parses the query starting at 'str' and moves 'str' to the end of the query
+
+   void StartFile();
+      // Initializes the evaluation for the next file
+
+   void FinishFile(XMLEventSink *output);
+      // Prints the results that are still pending
+      // (This can only happen if not all blocks were decompressed)
+};
+
+extern QueryMan queryman;
+
+#endif
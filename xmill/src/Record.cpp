@@ -0,0 +1,241 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements the decompression of a range of records (option '-R')
+
+#include "Record.hpp"
+#include "UnCompCont.hpp"
+#include "LabelDict.hpp"
+#include "CurPath.hpp"
+#include "BlockIndex.hpp"
+#include "StructCoder.hpp"
+
+#undef LoadString
+
+extern MemStreamer            mainmem;
+extern UncompressContainerMan uncomprcont;
+extern char                   use_structcoder;
+
+RecordExtractor recordextractor;
+
+void RecordExtractor::SetRecords(char *filename,unsigned long first,unsigned long last)
+   // Finds the block of record 'first' in the index of file 'filename'
+{
+   mainmem.StartNewMemBlock();
+
+   // The standard input and memory data cannot have an index
+   if((filename==NULL)||(blockindex.Load(filename,0)==0))
+   {
+      mainmem.RemoveLastMemBlock();
+      Error("Option -R requires a file compressed with option -x!");
+      Exit();
+   }
+   if(first>=blockindex.GetRecordNum())
+   {
+      char tmpstr[100];
+      mainmem.RemoveLastMemBlock();
+      sprintf(tmpstr,"The file has only %lu records!",blockindex.GetRecordNum());
+      Error(tmpstr);
+      Exit();
+   }
+   startblock=blockindex.FindRecordBlock(first);
+   mainmem.RemoveLastMemBlock();
+
+   firstrecord=first;
+   lastrecord=last;
+   isinside=0;
+
+   // The output of 'nulloutput' is simply dropped
+   nulloutput.CreateFile("");
+}
+
+void RecordExtractor::FinishFile()
+   // Finishes the decompression of the file
+{
+   nulloutput.CloseFile();
+}
+
+void RecordExtractor::StartBlock(unsigned long blockidx)
+   // Prepares the decoding of block 'blockidx'
+{
+   BlockIndexSyncPoint  *syncpoint;
+   unsigned long        i;
+
+   currecord=blockindex.GetBlock(blockidx)->firstrecord;
+
+   if(blockidx!=startblock)
+      return;
+
+   syncpoint=blockindex.FindSyncPoint(blockidx,firstrecord);
+   if(syncpoint==NULL)
+      return;
+
+   // The current path at the beginning of the block is replaced by the path
+   // at the sync point
+   curpath.Reset();
+   for(i=0;i<syncpoint->depth;i++)
+   {
+      if(syncpoint->openlabels[i]>=globallabeldict.GetUncompressLabelNum())
+         ExitCorruptFile();
+      curpath.AddLabel(syncpoint->openlabels[i]);
+   }
+
+   uncomprcont.LoadSyncState(syncpoint->state,syncpoint->statelen);
+   currecord=syncpoint->record;
+}
+
+//**************************************************************************
+
+char RecordExtractor::DecodeBlock(UncompressContainer *treecont,UncompressContainer *whitespacecont,UncompressContainer *specialcont,XMLEventSink *output)
+   // Prints the tokens of the current block that belong to the records
+   // This is the same loop as in 'DecodeTreeBlock', but the record
+   // boundaries are counted and the output outside of the records is dropped
+{
+   char              *strptr;
+   int               mystrlen;
+   unsigned char     *curptr,*endptr;
+   long              id;
+   unsigned long     tokenval,i;
+   char              isneg;
+   CurPathIterator   it;
+
+   UncompressLabelDictItem *labelarray=globallabeldict.GetLabelArray(),*item;
+   unsigned long           labelnum=globallabeldict.GetUncompressLabelNum();
+   TLabelID                labelid;
+
+   // At a sync point, the structure container doesn't start at the beginning
+   curptr=treecont->GetDataPtr();
+   endptr=curptr+(treecont->GetSize()-treecont->GetPos());
+
+   if(use_structcoder)
+      structdecoder.StartBlock(curptr,treecont->GetSize());
+
+   for(;;)
+   {
+      if(use_structcoder)
+      {
+         if(structdecoder.DecodeToken(&tokenval,&isneg)==0)
+            break;
+         id=(long)tokenval;
+      }
+      else
+      {
+         if(curptr>=endptr)
+            break;
+         id=LoadSInt32(curptr,&isneg);
+      }
+
+      if(isneg==0)
+      {
+         if(id>=32768L)
+         {
+            Error("Error while decompressing file!");
+            Exit();
+         }
+
+         switch(id)
+         {
+         case TREETOKEN_ENDLABEL:
+         case TREETOKEN_EMPTYENDLABEL:
+            labelid=curpath.RemoveLabel();
+            if(labelid>=labelnum)
+               ExitCorruptFile();
+            item=labelarray+labelid;
+
+            if(isinside)
+            {
+               if(id==TREETOKEN_EMPTYENDLABEL)
+                  output->endEmptyElement();
+               else if(item->isattrib==0)
+                  output->endElement(item->strptr,item->len);
+               else
+                  output->endAttribute(item->strptr,item->len);
+
+               // Is this the end of the last record?
+               if((curpath.GetDepth()==1)&&(item->isattrib==0)&&(currecord-1==lastrecord))
+               {
+                  isinside=0;
+                  return 1;
+               }
+            }
+            break;
+
+         case TREETOKEN_WHITESPACE:
+            mystrlen=whitespacecont->LoadUInt32();
+            strptr=(char *)whitespacecont->GetDataPtr(mystrlen);
+            if(isinside)
+               output->whitespaces(strptr,mystrlen);
+            break;
+
+         case TREETOKEN_ATTRIBWHITESPACE:
+            mystrlen=whitespacecont->LoadUInt32();
+            strptr=(char *)whitespacecont->GetDataPtr(mystrlen);
+            if(isinside)
+               output->attribWhitespaces(strptr,mystrlen);
+            break;
+
+         case TREETOKEN_SPECIAL:
+            strptr=(char *)(specialcont->LoadString((unsigned *)&mystrlen));
+            if(isinside)
+               output->special(strptr,mystrlen);
+            break;
+
+         default: // A start label
+            id-=LABELIDX_TOKENOFFS;
+            if((unsigned long)id>=labelnum)
+               ExitCorruptFile();
+            item=labelarray+id;
+
+            if((curpath.GetDepth()==1)&&(item->isattrib==0))
+               // A new record starts
+            {
+               if(currecord==firstrecord)
+                  // We open the elements that enclose the records
+               {
+                  curpath.InitIteratorToStart(&it);
+                  for(i=0;i<curpath.GetDepth();i++)
+                  {
+                     labelid=it.GotoNext();
+                     output->startElement(labelarray[labelid].strptr,labelarray[labelid].len);
+                  }
+                  isinside=1;
+               }
+               currecord++;
+            }
+
+            if(isinside)
+            {
+               if(item->isattrib==0)
+                  output->startElement(item->strptr,item->len);
+               else
+                  output->startAttribute(item->strptr,item->len);
+            }
+            curpath.AddLabel((TLabelID)id);
+         }
+      }
+      else  // A text item
+         uncomprcont.GetContBlock(id)->UncompressText(isinside ? output : &nulloutput);
+   }
+   return 0;
+}
@@ -0,0 +1,92 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements the decompression of a range of records (option '-R').
+// A record is a child element of the root element. The block index contains
+// the number of the first record of each block, so that the decompressor
+// can start with the block in which the first record starts.
+//
+// If the file was compressed with option '-y', the index also contains sync
+// points. The decompressor then moves the containers directly to the last
+// sync point in front of the first record and restores the states of the
+// user decompressors. Otherwise, the tokens of the block in front of the first
+// record are decoded as well, but their output is dropped.
+//
+// The decompression stops after the last record. As for option '-B', the
+// elements that enclose the records are printed without their attributes.
+
+#ifndef RECORD_HPP
+#define RECORD_HPP
+
+#include "XMLOutput.hpp"
+
+class UncompressContainer;
+
+// Denotes that the entire file is decompressed (option '-R' is not set)
+#define RECORD_ALLRECORDS 0xFFFFFFFFUL
+
+class RecordExtractor
+{
+   unsigned long  firstrecord,lastrecord; // The range of records
+   unsigned long  startblock;             // The block in which the first record starts
+   unsigned long  currecord;              // The number of the next record that starts
+   char           isinside;               // Is 1, while the records are printed
+
+   XMLOutput      nulloutput;             // Receives the text items in front of the records
+
+public:
+   RecordExtractor()
+   {
+      firstrecord=lastrecord=RECORD_ALLRECORDS;
+      startblock=0;
+      currecord=0;
+      isinside=0;
+   }
+
+   char IsActive()   {  return firstrecord!=RECORD_ALLRECORDS;  }
+      // Returns 1, if only a range of records is decompressed
+
+   void SetRecords(char *filename,unsigned long first,unsigned long last);
+      // Finds the block of record 'first' in the index of file 'filename'
+      // The records 'first' to 'last' are decompressed
+
+   unsigned long GetFirstBlock()  {  return startblock; }
+      // Returns the block in which the first record starts
+
+   void StartBlock(unsigned long blockidx);
+      // Prepares the decoding of block 'blockidx' after the containers have been
+      // initialized. In the first block, the containers and the current path
+      // are moved to the sync point in front of the first record.
+
+   char DecodeBlock(UncompressContainer *treecont,UncompressContainer *whitespacecont,UncompressContainer *specialcont,XMLEventSink *output);
+      // Prints the tokens of the current block that belong to the records
+      // Returns 1, if the last record has been printed
+
+   void FinishFile();
+      // Finishes the decompression of the file
+};
+
+extern RecordExtractor recordextractor;
+
+#endif
@@ -329,6 +329,15 @@ public:
             dataptr+info.subcompressor->GetUserDataSize(),
             overalluncomprsize,overallcomprsize);
    }
+
+   void StoreSyncState(char *dataptr,MemStreamer *mem)
+   {
+      info.subcompressor->StoreSyncState(dataptr,mem);
+
+      if(info.subcompressor2!=NULL)
+         info.subcompressor2->StoreSyncState(
+            dataptr+info.subcompressor->GetUserDataSize(),mem);
+   }
 };
 
 
@@ -361,7 +370,18 @@ public:
             dataptr+info.subuncompressor->GetUserDataSize());
    }
 
-   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLOutput *output)
+   void LoadSyncState(UncompressContainer *cont,char *dataptr,unsigned char * &ptr)
+      // The subcompressors use the containers behind the count container
+   {
+      info.subuncompressor->LoadSyncState(cont+1,dataptr,ptr);
+
+      if(info.subuncompressor2!=NULL)
+         info.subuncompressor2->LoadSyncState(
+            cont+1+info.subuncompressor->GetUserContNum(),
+            dataptr+info.subuncompressor->GetUserDataSize(),ptr);
+   }
+
+   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLEventSink *output)
    {
       unsigned long count=cont->LoadUInt32();
 
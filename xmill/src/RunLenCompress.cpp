@@ -34,6 +34,7 @@ History:
 
 
 #include "UnCompCont.hpp"
+#include "ParDecode.hpp"
 
 
 //***************************************************************************
@@ -119,7 +120,7 @@ struct CurRunLengthState
          else
             allocsize=((len-1)|3)+1;
 
-         *itemref=(CurRunLengthItem *)blockmem.GetByteBlock(sizeof(CurRunLengthItem)+allocsize);
+         *itemref=(CurRunLengthItem *)GetSharedBlockMem(sizeof(CurRunLengthItem)+allocsize);
 
          (*itemref)->size=allocsize;
          (*itemref)->len=len;
@@ -232,6 +233,15 @@ public:
          cont->StoreUInt32(state->runlencount);
       }
    }
+
+   void StoreSyncState(char *dataptr,MemStreamer *mem)
+      // The current run is only stored after its last item. Hence, the
+      // decompressor finds the string and the count of the current run at the sync
+      // point and must skip the items of the run that are in front of the sync point.
+      // We store the number of these items.
+   {
+      mem->StoreUInt32(((CurRunLengthState *)dataptr)->runlencount+1);
+   }
 };
 
 
@@ -260,7 +270,7 @@ public:
       ((CurRunLengthState *)dataptr)->runlencount=-1;
    }
 
-   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLOutput *output)
+   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLEventSink *output)
    {
       CurRunLengthState *state=(CurRunLengthState *)dataptr;
 
@@ -275,9 +285,11 @@ public:
 
          output->characters((char *)ptr,len);
 
-         state->runlencount=((short)cont->LoadUInt32())-1;
-
+         // The string must be kept before the next access to the
+         // container, since a streamed container might move its data
          state->KeepNewString(ptr,len);
+
+         state->runlencount=((short)cont->LoadUInt32())-1;
       }
       else
       {
@@ -293,6 +305,24 @@ public:
          state->runlencount--;
       }
    }
+
+   void LoadSyncState(UncompressContainer *cont,char *dataptr,unsigned char * &ptr)
+      // Loads the current run and skips the items in front of the sync point
+   {
+      CurRunLengthState *state=(CurRunLengthState *)dataptr;
+      unsigned long     skipcount=::LoadUInt32(ptr);
+
+      if(skipcount>0)
+      {
+         int            len=cont->LoadUInt32();
+         unsigned char  *strptr=cont->GetDataPtr(len);
+
+         state->KeepNewString(strptr,len);
+
+         // The run has 'count+1' items
+         state->runlencount=(short)(cont->LoadUInt32()-skipcount);
+      }
+   }
 };
 
 
@@ -32,6 +32,11 @@ History:
 // The interface used is very similar to SAX.
 
 #include <stdio.h>
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
 
 #include "Error.hpp"
 #include "Output.hpp"
@@ -39,6 +44,8 @@ History:
 #include "ContMan.hpp"
 #include "CurPath.hpp"
 #include "XMLParse.hpp"
+#include "StructCoder.hpp"
+#include "BlockIndex.hpp"
 
 extern CurPath  curpath;
 
@@ -69,12 +76,91 @@ void InitForwardDataGuide()
 //**************************************************************************
 //**************************************************************************
 
+extern char use_structcoder;
+
+// The number of structure tokens stored in the current block
+unsigned long treetokencount=0;
+
+inline void StoreTreeToken(char isneg,unsigned long val)
+   // Stores a token in the structure container - either with
+   // the structure coder or simply as a compressed integer
+{
+   treetokencount++;
+
+   if(use_structcoder)
+      structencoder.EncodeToken(isneg,val);
+   else
+      globaltreecont->StoreCompressedSInt(isneg,val);
+}
+
+// The number of records (i.e. children of the root element) parsed so far
+unsigned long recordcount=0;
+
+//**************************************************************************
+
+// With options '-F' and '-N', the compressor finishes a block after some
+// milliseconds or some records, so that a live data stream is passed on
+// with little latency. The block is only finished at the end of a record
+// or of a top-level element, i.e. the parser never stops inside a record.
+
+extern unsigned long flush_interval,flush_records;
+
+// With option '-y', a sync point is stored in front of every n-th record
+extern unsigned long syncpoint_interval;
+
+char                 flushblock=0;
+static unsigned long blockstartrecord=0;  // The number of records in front of the block
+static unsigned long blockstarttime=0;    // The time at which the block was started
+
+inline unsigned long GetMilliSeconds()
+   // Returns the current time in milliseconds
+{
+#ifdef WIN32
+   return GetTickCount();
+#else
+   struct timeval tv;
+
+   gettimeofday(&tv,NULL);
+   return (unsigned long)tv.tv_sec*1000+(unsigned long)tv.tv_usec/1000;
+#endif
+}
+
+void StartBlockFlush()
+   // Starts the time and the record count for finishing the next block
+{
+   flushblock=0;
+   blockstartrecord=recordcount;
+   if(flush_interval>0)
+      blockstarttime=GetMilliSeconds();
+}
+
+inline void CheckBlockFlush()
+   // Checks at the end of a record whether the block should be finished
+   // If the next record has not arrived yet, we wait for it until
+   // the end of the interval. Otherwise, a stalled data stream would
+   // keep the records of the block until the next record is complete.
+{
+   unsigned long elapsed;
+
+   if((flush_records>0)&&(recordcount-blockstartrecord>=flush_records))
+      flushblock=1;
+   else if(flush_interval>0)
+   {
+      elapsed=GetMilliSeconds()-blockstarttime;
+      if((elapsed>=flush_interval)||
+         (xmlparser->WaitForData(flush_interval-elapsed)==0))
+         flushblock=1;
+   }
+}
+
+//**************************************************************************
+
 // First some auxiliary functions for storing start/end labels
 
 inline void StoreEndLabel()
    // We store an end label by simply storing the TREETOKEN_ENDLABEL token
 {
-   globaltreecont->StoreCompressedSInt(0,TREETOKEN_ENDLABEL);
+   StoreTreeToken(0,TREETOKEN_ENDLABEL);
 
 #ifdef USE_FORWARD_DATAGUIDE
    curpathtreenode=curpathtreenode->parent;
@@ -88,7 +174,7 @@ inline void StoreEndLabel()
 inline void StoreEmptyEndLabel()
    // We store an end label by simply storing the TREETOKEN_ENDLABEL token
 {
-   globaltreecont->StoreCompressedSInt(0,TREETOKEN_EMPTYENDLABEL);
+   StoreTreeToken(0,TREETOKEN_EMPTYENDLABEL);
 
 #ifdef USE_FORWARD_DATAGUIDE
    curpathtreenode=curpathtreenode->parent;
@@ -104,7 +190,7 @@ inline void StoreStartLabel(TLabelID labelid)
    // The LABELIDX_TOKENOFFS is used since the first labels (0 and 1) are used
    // to denote white spaces and special strings (DOCTYPE, ...)
 {
-   globaltreecont->StoreCompressedSInt(0,GET_LABELID(labelid)+LABELIDX_TOKENOFFS);
+   StoreTreeToken(0,GET_LABELID(labelid)+LABELIDX_TOKENOFFS);
 
 #ifdef USE_FORWARD_DATAGUIDE
 #ifdef USE_NO_DATAGUIDE
@@ -118,7 +204,7 @@ inline void StoreStartLabel(TLabelID labelid)
 inline void StoreTextToken(unsigned blockid)
    // A text token is stored by simply storing the block ID
 {
-   globaltreecont->StoreCompressedSInt(1,blockid);
+   StoreTreeToken(1,blockid);
 /*
 #ifdef USE_FORWARD_DATAGUIDE
    CurPathIterator it;
@@ -174,7 +260,7 @@ void SAXClient::HandleAttribWhiteSpaces(char *str,int len,char iscont)
       {
          globalwhitespacecont->StoreUInt32(len);
          globalwhitespacecont->StoreData(str,len);
-         globaltreecont->StoreCompressedSInt(0,TREETOKEN_ATTRIBWHITESPACE);
+         StoreTreeToken(0,TREETOKEN_ATTRIBWHITESPACE);
       }
    }
 }
@@ -195,9 +281,16 @@ void SAXClient::HandleStartLabel(char *str,int len,char iscont)
          labelid=LABEL_UNDEFINED;
    }
 
+   // The decompressor can start at a sync point in front of the record
+   if((syncpoint_interval>0)&&(curpath.GetDepth()==1)&&(recordcount%syncpoint_interval==0))
+      blockindex.AddSyncPoint(recordcount);
+
    // Add the label to the path
    curpath.AddLabel(labelid);
 
+   if(curpath.GetDepth()==2)  // Is the element a child of the root element?
+      recordcount++;
+
    // Store the start label in the schema container
    StoreStartLabel(labelid);
 }
@@ -268,6 +361,10 @@ void SAXClient::HandleEndLabel(char *str,int len,char iscont)
       }
       StoreEndLabel();
    }
+
+   // The end of a record is a safe point to finish the block
+   if((curpath.GetDepth()<=1)&&((flush_interval>0)||(flush_records>0)))
+      CheckBlockFlush();
 }
 
 void SAXClient::HandleText(char *str,int len,char iscont,int leftwslen,int rightwslen)
@@ -284,7 +381,7 @@ void SAXClient::HandleText(char *str,int len,char iscont,int leftwslen,int right
          return;
 
       case WHITESPACE_STOREGLOBAL:
-         globaltreecont->StoreCompressedSInt(0,TREETOKEN_WHITESPACE);
+         StoreTreeToken(0,TREETOKEN_WHITESPACE);
          globalwhitespacecont->StoreUInt32(len);
          globalwhitespacecont->StoreData(str,len);
          return;
@@ -305,7 +402,7 @@ void SAXClient::HandleComment(char *str,int len,char iscont)
 {
    if(!ignore_comment)
    {
-      globaltreecont->StoreCompressedSInt(0,TREETOKEN_SPECIAL);
+      StoreTreeToken(0,TREETOKEN_SPECIAL);
       globalspecialcont->StoreUInt32(len);
       globalspecialcont->StoreData(str,len);
    }
@@ -316,7 +413,7 @@ void SAXClient::HandlePI(char *str,int len,char iscont)
 {
    if(!ignore_pi)
    {
-      globaltreecont->StoreCompressedSInt(0,TREETOKEN_SPECIAL);
+      StoreTreeToken(0,TREETOKEN_SPECIAL);
       globalspecialcont->StoreUInt32(len);
       globalspecialcont->StoreData(str,len);
    }
@@ -327,7 +424,7 @@ void SAXClient::HandleDOCTYPE(char *str,int len,char iscont)
 {
    if(!ignore_doctype)
    {
-      globaltreecont->StoreCompressedSInt(0,TREETOKEN_SPECIAL);
+      StoreTreeToken(0,TREETOKEN_SPECIAL);
       globalspecialcont->StoreUInt32(len);
       globalspecialcont->StoreData(str,len);
    }
@@ -338,7 +435,7 @@ void SAXClient::HandleCDATA(char *str,int len,char iscont)
 {
    if(!ignore_cdata)
    {
-      globaltreecont->StoreCompressedSInt(0,TREETOKEN_SPECIAL);
+      StoreTreeToken(0,TREETOKEN_SPECIAL);
       globalspecialcont->StoreUInt32(len);
       globalspecialcont->StoreData(str,len);
    }
@@ -426,7 +523,7 @@ inline char VPathExpr::CompressTextItem(char *str,int len,PathDictNode *pathdict
    // Let's globally store the left white spaces (if there are some)
    if((wsleftlen>0)&&(leftwhitespacescompress==WHITESPACE_STOREGLOBAL))
    {
-      globaltreecont->StoreCompressedSInt(0,TREETOKEN_WHITESPACE);
+      StoreTreeToken(0,TREETOKEN_WHITESPACE);
       globalwhitespacecont->StoreUInt32(wsleftlen);
       globalwhitespacecont->StoreData(str-wsleftlen,wsleftlen);
    }
@@ -440,7 +537,7 @@ inline char VPathExpr::CompressTextItem(char *str,int len,PathDictNode *pathdict
    // Let's globally store the right white spaces (if there are some)
    if((wsrightlen>0)&&(rightwhitespacescompress==WHITESPACE_STOREGLOBAL))
    {
-      globaltreecont->StoreCompressedSInt(0,TREETOKEN_WHITESPACE);
+      StoreTreeToken(0,TREETOKEN_WHITESPACE);
       globalwhitespacecont->StoreUInt32(wsrightlen);
       globalwhitespacecont->StoreData(str+len,wsrightlen);
    }
@@ -44,6 +44,16 @@ void PrintLabel(char *str,int len);
 class XMLParse;
 extern XMLParse *xmlparser;
 
+// The number of structure tokens stored in the current block
+// This is used for the document table of multi-document files
+extern unsigned long treetokencount;
+
+// Is 1, if the parser should finish the current block (options '-F' and '-N')
+extern char flushblock;
+
+void StartBlockFlush();
+   // Starts the time and the record count for finishing the next block
+
 class SAXClient
 {
 public:
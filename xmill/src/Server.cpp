@@ -0,0 +1,381 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements the compression server and its client
+
+#ifndef WIN32
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#include "Types.hpp"
+#include "Error.hpp"
+#include "File.hpp"
+#include "Output.hpp"
+#include "Server.hpp"
+
+char           *server_socket=NULL;
+char           *server_clientsocket=NULL;
+unsigned       server_maxrequests=4;
+unsigned long  server_memorylimit=0;
+
+// Defined in Main.cpp
+void Compress(char *srcfile,char *destfile);
+extern void (*compress_memoryhandler)(char *data,int len);
+
+extern char delete_inputfiles;
+extern char *append_archive;
+extern char verbose;
+
+// The connection of the request handled by the current child process
+static int  server_conn;
+static char server_replysent;
+
+//**************************************************************************
+
+inline char WriteAll(int fd,char *data,unsigned long len)
+   // Writes 'len' bytes to 'fd'. Returns 0, if the connection fails
+{
+   ssize_t byteswritten;
+
+   while(len>0)
+   {
+      byteswritten=write(fd,data,len);
+      if(byteswritten<0)
+      {
+         if(errno==EINTR)
+            continue;
+         return 0;
+      }
+      data+=byteswritten;
+      len-=byteswritten;
+   }
+   return 1;
+}
+
+inline char ReadAll(int fd,char *data,unsigned long len)
+   // Reads 'len' bytes from 'fd'. Returns 0, if the connection ends before
+{
+   ssize_t bytesread;
+
+   while(len>0)
+   {
+      bytesread=read(fd,data,len);
+      if(bytesread<0)
+      {
+         if(errno==EINTR)
+            continue;
+         return 0;
+      }
+      if(bytesread==0)
+         return 0;
+      data+=bytesread;
+      len-=bytesread;
+   }
+   return 1;
+}
+
+static void SendReply(int fd,char status,char *data,unsigned long len)
+   // Sends the status byte, the length and the data
+{
+   char header[SERVER_HEADERSIZE];
+
+   header[0]=status;
+   for(int i=0;i<4;i++)
+      header[i+1]=(char)(len>>(i*8));
+
+   if(WriteAll(fd,header,SERVER_HEADERSIZE))
+      WriteAll(fd,data,len);
+}
+
+static void SendCompressedData(char *data,int len)
+   // This is called by the compressor with the compressed document
+{
+   SendReply(server_conn,SERVER_REPLY_OK,data,len);
+   server_replysent=1;
+}
+
+static void HandleRequest(int conn)
+   // Compresses the document received over 'conn' and sends the result back
+   // This is executed in a child process of the server
+{
+   FILE  *msgfile=tmpfile();
+   char  msg[512];
+   int   len;
+
+   // The compressor reads the document from the standard input
+   dup2(conn,0);
+
+   // The messages of the compressor are collected in a temporary file,
+   // so that they can be sent to the client
+   if(msgfile!=NULL)
+      dup2(fileno(msgfile),1);
+
+   if(server_memorylimit!=0)
+   {
+      struct rlimit limit;
+
+      limit.rlim_cur=limit.rlim_max=server_memorylimit;
+      setrlimit(RLIMIT_AS,&limit);
+   }
+
+   server_conn=conn;
+   server_replysent=0;
+
+   compress_memoryhandler=SendCompressedData;
+   delete_inputfiles=0;
+   append_archive=NULL;
+
+   try{
+      Compress(NULL,NULL);
+   }
+   catch(XMillException *)
+   {
+      PrintErrorMsg();
+   }
+   fflush(stdout);
+
+   if(server_replysent==0)
+   {
+      len=0;
+      if(msgfile!=NULL)
+      {
+         fseek(msgfile,0,SEEK_SET);
+         len=fread(msg,1,sizeof(msg),msgfile);
+      }
+      if(len<=0)
+      {
+         strcpy(msg,"Compression failed!");
+         len=strlen(msg);
+      }
+      SendReply(conn,SERVER_REPLY_ERROR,msg,len);
+   }
+   close(conn);
+}
+
+void RunServer(char *socketpath)
+   // Runs the compression server on the Unix domain socket 'socketpath'
+{
+   struct sockaddr_un   addr;
+   int                  listenfd,conn;
+   unsigned             activerequests=0;
+   pid_t                pid;
+
+   if(strlen(socketpath)>=sizeof(addr.sun_path))
+   {
+      Error("The socket name '");
+      ErrorCont(socketpath);
+      ErrorCont("' is too long!");
+      return;
+   }
+
+   memset(&addr,0,sizeof(addr));
+   addr.sun_family=AF_UNIX;
+   strcpy(addr.sun_path,socketpath);
+
+   // A socket left behind by a previous server is removed
+   unlink(socketpath);
+
+   listenfd=socket(AF_UNIX,SOCK_STREAM,0);
+   if((listenfd<0)||
+      (bind(listenfd,(struct sockaddr *)&addr,sizeof(addr))<0)||
+      (listen(listenfd,16)<0))
+   {
+      Error("Could not create socket '");
+      ErrorCont(socketpath);
+      ErrorCont("'!");
+      if(listenfd>=0)
+         close(listenfd);
+      return;
+   }
+
+   // A client that disconnects early should not terminate the server
+   signal(SIGPIPE,SIG_IGN);
+
+   if(verbose)
+      printf("Waiting for requests on socket '%s'\n",socketpath);
+
+   for(;;)
+   {
+      // We collect the finished requests. If there are too many
+      // active requests, we wait until one of them is finished
+      while(activerequests>0)
+      {
+         pid=waitpid(-1,NULL,(activerequests>=server_maxrequests) ? 0 : WNOHANG);
+         if(pid>0)
+            activerequests--;
+         else
+         {
+            if((pid<0)&&(errno==EINTR))
+               continue;
+            break;
+         }
+      }
+
+      conn=accept(listenfd,NULL,NULL);
+      if(conn<0)
+         continue;
+
+      // The output buffer must be empty before the process is cloned
+      fflush(stdout);
+
+      pid=fork();
+      if(pid==0)
+      {
+         close(listenfd);
+         HandleRequest(conn);
+         _exit(0);
+      }
+      if(pid>0)
+         activerequests++;
+      else
+      {
+         char *msg="The server could not start a new process!";
+         SendReply(conn,SERVER_REPLY_ERROR,msg,strlen(msg));
+      }
+      close(conn);
+   }
+}
+
+//**************************************************************************
+
+char CompressWithServer(char *socketpath,char *srcfile,char *destfile)
+   // Sends the file 'srcfile' to the server at 'socketpath' and stores
+   // the compressed document in 'destfile'
+{
+   struct sockaddr_un   addr;
+   int                  conn;
+   CFile                file;
+   Output               output;
+   char                 buf[65536];
+   char                 header[SERVER_HEADERSIZE];
+   unsigned             bytecount;
+   unsigned long        len;
+
+   if(file.OpenFile(srcfile)==0)
+   {
+      Error("Could not find file '");
+      ErrorCont(srcfile);
+      ErrorCont("'!");
+      return 0;
+   }
+
+   memset(&addr,0,sizeof(addr));
+   addr.sun_family=AF_UNIX;
+   strncpy(addr.sun_path,socketpath,sizeof(addr.sun_path)-1);
+
+   conn=socket(AF_UNIX,SOCK_STREAM,0);
+   if((conn<0)||(connect(conn,(struct sockaddr *)&addr,sizeof(addr))<0))
+   {
+      Error("Could not connect to server '");
+      ErrorCont(socketpath);
+      ErrorCont("'!");
+      if(conn>=0)
+         close(conn);
+      file.CloseFile();
+      return 0;
+   }
+
+   // We send the document and close our side of the connection
+   do
+   {
+      bytecount=file.ReadBlock(buf,sizeof(buf));
+      if(WriteAll(conn,buf,bytecount)==0)
+         break;
+   }
+   while(bytecount==sizeof(buf));
+
+   file.CloseFile();
+   shutdown(conn,SHUT_WR);
+
+   if(ReadAll(conn,header,SERVER_HEADERSIZE)==0)
+   {
+      Error("Connection to server '");
+      ErrorCont(socketpath);
+      ErrorCont("' failed!");
+      close(conn);
+      return 0;
+   }
+
+   len=0;
+   for(int i=4;i>0;i--)
+      len=(len<<8)|(unsigned char)header[i];
+
+   if(header[0]!=SERVER_REPLY_OK)
+   {
+      if(len>sizeof(buf)-1)
+         len=sizeof(buf)-1;
+      if(ReadAll(conn,buf,len)==0)
+         len=0;
+      buf[len]=0;
+
+      // We remove the newline at the end of the message
+      while((len>0)&&((buf[len-1]=='\n')||(buf[len-1]=='\r')))
+         buf[--len]=0;
+
+      Error(buf);
+      close(conn);
+      return 0;
+   }
+
+   if(output.CreateFile(destfile)==0)
+   {
+      Error("Could not create output file '");
+      ErrorCont(destfile);
+      ErrorCont("'!");
+      close(conn);
+      return 0;
+   }
+
+   while(len>0)
+   {
+      bytecount=(len<sizeof(buf)) ? len : sizeof(buf);
+      if(ReadAll(conn,buf,bytecount)==0)
+      {
+         Error("Connection to server '");
+         ErrorCont(socketpath);
+         ErrorCont("' failed!");
+         output.CloseAndDeleteFile();
+         close(conn);
+         return 0;
+      }
+      output.StoreData(buf,bytecount);
+      len-=bytecount;
+   }
+   output.CloseFile();
+   close(conn);
+   return 1;
+}
+
+#endif
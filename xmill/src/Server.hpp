@@ -0,0 +1,67 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements the compression server and its client.
+// The server keeps the configuration (path expressions, FSMs, user compressors
+// and the label dictionary) that has been set up at startup and waits for
+// requests on a Unix domain socket. Each request is compressed in a child
+// process that is forked from the server. The child inherits the initialized
+// state of the server and therefore, no initialization is needed per document.
+//
+// The protocol is simple: the client sends the XML document and closes
+// its side of the connection for writing. The server answers with one status
+// byte, the length of the data (4 bytes, least significant byte first) and
+// the data. The data is either the compressed document or an error message.
+
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#ifndef WIN32
+
+#define SERVER_REPLY_OK       0  // The data is the compressed document
+#define SERVER_REPLY_ERROR    1  // The data is an error message
+
+#define SERVER_HEADERSIZE     5  // The size of the status byte and the length
+
+extern char          *server_socket;         // The socket of the server (option '-Ss')
+extern char          *server_clientsocket;   // The socket used by the client (option '-Sc')
+extern unsigned      server_maxrequests;     // The maximal number of concurrent requests
+extern unsigned long server_memorylimit;     // The memory limit of a request in bytes
+
+void RunServer(char *socketpath);
+   // Runs the compression server on the Unix domain socket 'socketpath'.
+   // The function only returns, if the socket cannot be created. In this
+   // case, an error message is set.
+
+char CompressWithServer(char *socketpath,char *srcfile,char *destfile);
+   // Sends the file 'srcfile' to the server at 'socketpath' and stores
+   // the compressed document in 'destfile'. If 'destfile' is NULL, then
+   // the standard output is used.
+   // The function returns 0 and sets an error message, if the
+   // compression fails.
+
+#endif
+
+#endif
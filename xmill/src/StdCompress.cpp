@@ -31,6 +31,7 @@ History:
 // This module contains the standard user compressors, such as 'u', 'u8', 'di', ...
 
 #include "CompressMan.hpp"
+#include "BitPack.hpp"
 
 //********************************************************************
 
@@ -40,11 +41,11 @@ History:
 
 #include "UnCompCont.hpp"
 
-inline char *IntToStr(long val)
+inline char *IntToStr(long val,char *tmpstr)
    // Convers an integer to a string and returns a pointer to the string
+   // The string is stored at the end of the buffer 'tmpstr' with 20 bytes,
+   // since several threads might print integers at the same time
 {
-static char  tmpstr[20];
-
    char *ptr=tmpstr+19; // We start from the back of the string
    *ptr=0;
 
@@ -77,7 +78,7 @@ static char  tmpstr[20];
    }
 }
 
-inline void PrintZeros(XMLOutput *output,unsigned long zeronum)
+inline void PrintZeros(XMLEventSink *output,unsigned long zeronum)
    // Prints a sequence of zero's
 {
    static char zerostr[]="0000000000";
@@ -90,9 +91,10 @@ inline void PrintZeros(XMLOutput *output,unsigned long zeronum)
    output->characters(zerostr,zeronum);
 }
 
-inline void PrintInteger(unsigned long val,char isneg,unsigned mindigits,XMLOutput *output)
+inline void PrintInteger(unsigned long val,char isneg,unsigned mindigits,XMLEventSink *output)
 {
-   char *ptr=IntToStr(val);
+   char tmpstr[20];
+   char *ptr=IntToStr(val,tmpstr);
    unsigned len=strlen(ptr);
 
    if(isneg)
@@ -139,11 +141,16 @@ public:
       datasize=0;contnum=1;
    }
 
-   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLOutput *output)
+   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLEventSink *output)
    {
       unsigned long len=cont->LoadUInt32();
 
-      output->characters((char *)cont->GetDataPtr(len),len);
+      // The text stays in the container memory until the end of the block
+      // - unless the container is streamed
+      if(cont->IsStreamed())
+         output->characters((char *)cont->GetDataPtr(len),len);
+      else
+         output->blockCharacters((char *)cont->GetDataPtr(len),len);
    }
 };
 
@@ -212,7 +219,7 @@ public:
       datasize=0;contnum=0;
    }
 
-   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLOutput *output)
+   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLEventSink *output)
    {
    }
 };
@@ -336,6 +343,29 @@ inline char ParseSignedInt(char *str,int len,long *val)
 
 // The standard integer user compressor 'u'
 
+// If option '-b' is set, the integer compressors don't store the values
+// as variable-length integers, but collect them in bit-packed frames.
+// The frame is kept in the state of the container block.
+
+extern char use_bitpack;
+
+struct BitPackState
+   // The state of the integer compressors
+{
+   BitPackFrame   *frame;  // The current frame (or NULL, if option '-b' is not set)
+};
+
+inline void InitBitPackState(char *dataptr)
+{
+   ((BitPackState *)dataptr)->frame=use_bitpack ? new BitPackFrame() : NULL;
+}
+
+inline void FinishBitPackState(CompressContainer *cont,char *dataptr)
+{
+   if(((BitPackState *)dataptr)->frame!=NULL)
+      BitPackFinish(cont,((BitPackState *)dataptr)->frame);
+}
+
 
 class UnsignedIntCompressor : public UserCompressor
 {
@@ -346,7 +376,17 @@ public:
    UnsignedIntCompressor(unsigned long mymindigits)
    {
       mindigits=mymindigits;
-      datasize=0;contnum=1;isrejecting=1;canoverlap=1;isfixedlen=0;
+      datasize=sizeof(BitPackState);contnum=1;isrejecting=1;canoverlap=1;isfixedlen=0;
+   }
+
+   void InitCompress(CompressContainer *cont,char *dataptr)
+   {
+      InitBitPackState(dataptr);
+   }
+
+   void FinishCompress(CompressContainer *cont,char *dataptr)
+   {
+      FinishBitPackState(cont,dataptr);
    }
 
 // Compression functions
@@ -359,7 +399,10 @@ public:
 
    void CompressString(char *str,unsigned len,CompressContainer *cont,char *dataptr)
    {
-      cont->StoreUInt32(val);
+      if(((BitPackState *)dataptr)->frame!=NULL)
+         BitPackValue(cont,((BitPackState *)dataptr)->frame,val);
+      else
+         cont->StoreUInt32(val);
    }
 };
 
@@ -372,12 +415,20 @@ public:
    UnsignedIntUncompressor(unsigned long mymindigits=0)
    {
       mindigits=mymindigits;
-      datasize=0;contnum=1;
+      datasize=sizeof(BitPackState);contnum=1;
+   }
+
+   void InitUncompress(UncompressContainer *cont,char *dataptr)
+   {
+      InitBitPackState(dataptr);
    }
 
-   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLOutput *output)
+   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLEventSink *output)
    {
-      PrintInteger(cont->LoadUInt32(),0,mindigits,output);
+      if(((BitPackState *)dataptr)->frame!=NULL)
+         PrintInteger(BitUnpackValue(cont,((BitPackState *)dataptr)->frame),0,mindigits,output);
+      else
+         PrintInteger(cont->LoadUInt32(),0,mindigits,output);
    }
 };
 
@@ -450,7 +501,17 @@ public:
    UnsignedInt8Compressor(unsigned long mymindigits)
    {
       mindigits=mymindigits;
-      datasize=0;contnum=1;isrejecting=1;canoverlap=1;isfixedlen=0;
+      datasize=sizeof(BitPackState);contnum=1;isrejecting=1;canoverlap=1;isfixedlen=0;
+   }
+
+   void InitCompress(CompressContainer *cont,char *dataptr)
+   {
+      InitBitPackState(dataptr);
+   }
+
+   void FinishCompress(CompressContainer *cont,char *dataptr)
+   {
+      FinishBitPackState(cont,dataptr);
    }
 
 // Compression functions
@@ -466,7 +527,10 @@ public:
 
    void CompressString(char *str,unsigned len,CompressContainer *cont,char *dataptr)
    {
-      cont->StoreChar((unsigned char)val);
+      if(((BitPackState *)dataptr)->frame!=NULL)
+         BitPackValue(cont,((BitPackState *)dataptr)->frame,val);
+      else
+         cont->StoreChar((unsigned char)val);
    }
 };
 
@@ -478,12 +542,20 @@ public:
    UnsignedInt8Uncompressor(unsigned long mymindigits=0)
    {
       mindigits=mymindigits;
-      datasize=0;contnum=1;
+      datasize=sizeof(BitPackState);contnum=1;
    }
 
-   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLOutput *output)
+   void InitUncompress(UncompressContainer *cont,char *dataptr)
    {
-      PrintInteger((unsigned long)(unsigned char)cont->LoadChar(),0,mindigits,output);
+      InitBitPackState(dataptr);
+   }
+
+   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLEventSink *output)
+   {
+      if(((BitPackState *)dataptr)->frame!=NULL)
+         PrintInteger(BitUnpackValue(cont,((BitPackState *)dataptr)->frame),0,mindigits,output);
+      else
+         PrintInteger((unsigned long)(unsigned char)cont->LoadChar(),0,mindigits,output);
    }
 };
 
@@ -551,7 +623,17 @@ public:
    SignedIntCompressor(unsigned long mymindigits)
    {
       mindigits=mymindigits;
-      datasize=0;contnum=1;isrejecting=1;canoverlap=1;isfixedlen=0;
+      datasize=sizeof(BitPackState);contnum=1;isrejecting=1;canoverlap=1;isfixedlen=0;
+   }
+
+   void InitCompress(CompressContainer *cont,char *dataptr)
+   {
+      InitBitPackState(dataptr);
+   }
+
+   void FinishCompress(CompressContainer *cont,char *dataptr)
+   {
+      FinishBitPackState(cont,dataptr);
    }
 
 // Compression functions
@@ -563,7 +645,11 @@ public:
 
    void CompressString(char *str,unsigned len,CompressContainer *cont,char *dataptr)
    {
-      cont->StoreSInt32(isneg,val);
+      // For bit-packing, the sign is kept in the lowest bit
+      if(((BitPackState *)dataptr)->frame!=NULL)
+         BitPackValue(cont,((BitPackState *)dataptr)->frame,((val&0x7FFFFFFFL)<<1)|isneg);
+      else
+         cont->StoreSInt32(isneg,val);
    }
 };
 
@@ -576,13 +662,27 @@ public:
    SignedIntUncompressor(unsigned long mymindigits=0)
    {
       mindigits=mymindigits;
-      datasize=0;contnum=1;
+      datasize=sizeof(BitPackState);contnum=1;
+   }
+
+   void InitUncompress(UncompressContainer *cont,char *dataptr)
+   {
+      InitBitPackState(dataptr);
    }
 
-   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLOutput *output)
+   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLEventSink *output)
    {
       char isneg;
-      unsigned long val=cont->LoadSInt32(&isneg);
+      unsigned long val;
+
+      if(((BitPackState *)dataptr)->frame!=NULL)
+      {
+         val=BitUnpackValue(cont,((BitPackState *)dataptr)->frame);
+         isneg=(char)(val&1);
+         val>>=1;
+      }
+      else
+         val=cont->LoadSInt32(&isneg);
 
       PrintInteger(val,isneg,mindigits,output);
    }
@@ -644,7 +744,8 @@ public:
 struct DeltaCompressorState
    // The state of the delta compressor
 {
-   long  prevvalue;
+   long           prevvalue;
+   BitPackFrame   *frame;  // The current frame (or NULL, if option '-b' is not set)
 };
 
 
@@ -665,6 +766,13 @@ public:
    void InitCompress(CompressContainer *cont,char *dataptr)
    {
       ((DeltaCompressorState *)dataptr)->prevvalue=0;
+      ((DeltaCompressorState *)dataptr)->frame=use_bitpack ? new BitPackFrame() : NULL;
+   }
+
+   void FinishCompress(CompressContainer *cont,char *dataptr)
+   {
+      if(((DeltaCompressorState *)dataptr)->frame!=NULL)
+         BitPackFinish(cont,((DeltaCompressorState *)dataptr)->frame);
    }
 
    char ParseString(char *str,unsigned len,char *dataptr)
@@ -685,13 +793,36 @@ public:
 
       dval=val-state->prevvalue;
 
-      if(dval>=0)
-         cont->StoreCompressedSInt(0,dval);
+      if(state->frame!=NULL)
+         // For bit-packing, the sign is kept in the lowest bit
+      {
+         if(dval>=0)
+            BitPackValue(cont,state->frame,(dval&0x7FFFFFFFL)<<1);
+         else
+            BitPackValue(cont,state->frame,(((-dval)&0x7FFFFFFFL)<<1)|1);
+      }
       else
-         cont->StoreCompressedSInt(1,0xFFFFFFFFL-dval+1L);
+      {
+         if(dval>=0)
+            cont->StoreCompressedSInt(0,dval);
+         else
+            cont->StoreCompressedSInt(1,0xFFFFFFFFL-dval+1L);
+      }
 
       state->prevvalue=val;
    }
+
+   void StoreSyncState(char *dataptr,MemStreamer *mem)
+      // The decompressor needs the previous value
+      // The value is stored in two halves, since it might not fit into 30 bits
+   {
+      long           prevvalue=((DeltaCompressorState *)dataptr)->prevvalue;
+      unsigned long  absval=(prevvalue<0) ? (unsigned long)-prevvalue : (unsigned long)prevvalue;
+
+      mem->StoreChar((prevvalue<0) ? 1 : 0);
+      mem->StoreUInt32(absval&0xFFFFUL);
+      mem->StoreUInt32((absval>>16)&0xFFFFUL);
+   }
 };
 
 
@@ -710,19 +841,41 @@ public:
    void InitUncompress(UncompressContainer *cont,char *dataptr)
    {
       ((DeltaCompressorState *)dataptr)->prevvalue=0;
+      ((DeltaCompressorState *)dataptr)->frame=use_bitpack ? new BitPackFrame() : NULL;
    }
 
-   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLOutput *output)
+   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLEventSink *output)
    {
       DeltaCompressorState *state=(DeltaCompressorState *)dataptr;
+      unsigned long        val;
 
-      state->prevvalue+=cont->LoadSInt32();
+      if(state->frame!=NULL)
+      {
+         val=BitUnpackValue(cont,state->frame);
+         if(val&1)
+            state->prevvalue-=(long)(val>>1);
+         else
+            state->prevvalue+=(long)(val>>1);
+      }
+      else
+         state->prevvalue+=cont->LoadSInt32();
 
       if(state->prevvalue&0x80000000L)
          PrintInteger((unsigned long)-state->prevvalue,1,mindigits,output);
       else
          PrintInteger((unsigned long) state->prevvalue,0,mindigits,output);
    }
+
+   void LoadSyncState(UncompressContainer *cont,char *dataptr,unsigned char * &ptr)
+      // Restores the previous value
+   {
+      char           isneg=(char)*(ptr++);
+      unsigned long  absval=::LoadUInt32(ptr);
+
+      absval|=::LoadUInt32(ptr)<<16;
+
+      ((DeltaCompressorState *)dataptr)->prevvalue=isneg ? -(long)absval : (long)absval;
+   }
 };
 
 
@@ -833,7 +986,7 @@ public:
       constantstrlen=len;
    }
 
-   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLOutput *output)
+   void UncompressItem(UncompressContainer *cont,char *dataptr,XMLEventSink *output)
    {
       output->characters(constantstr,constantstrlen);
    }
@@ -0,0 +1,548 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements the structure coder, i.e. the context-modeled
+// arithmetic coder for the tokens of the structure container.
+// The arithmetic coder is a carry-less binary coder with 32-bit
+// precision: the leading bytes of 'low' and 'high' are shifted out
+// as soon as they are equal.
+
+#include "StructCoder.hpp"
+#include "ContMan.hpp"
+
+#define STRUCTPROB_INIT       (2048<<4)   // Probability 1/2 with no updates
+#define STRUCTPROB_MAXCOUNT   15          // The maximum update count
+
+StructEncoder structencoder;
+StructDecoder structdecoder;
+
+// The adaptation rates for the different update counts (65536/(count+1.5))
+static unsigned short structprob_rates[STRUCTPROB_MAXCOUNT+1]=
+{
+   43690,26214,18724,14563,11915,10082,8738,7710,
+   6898,6241,5698,5242,4854,4519,4228,3971
+};
+
+//**************************************************************************
+//**************************************************************************
+
+StructModel::StructModel()
+{
+   preds1=preds2=NULL;
+   kindprobs=numprobs=NULL;
+   history=NULL;
+   matchtable=NULL;
+}
+
+StructModel::~StructModel()
+{
+   if(preds1!=NULL)
+   {
+      delete[] preds1;
+      delete[] preds2;
+      delete[] kindprobs;
+      delete[] numprobs;
+      delete[] history;
+      delete[] matchtable;
+   }
+}
+
+inline void InitProbs(TStructProb *probs,unsigned long num)
+{
+   while(num--)
+      *(probs++)=STRUCTPROB_INIT;
+}
+
+inline void InitPredictions(TStructPred *preds,unsigned long num)
+{
+   while(num--)
+   {
+      preds->token=(unsigned int)STRUCTCODER_NOTOKEN;
+      preds->prob=STRUCTPROB_INIT;
+      preds++;
+   }
+}
+
+void StructModel::ResetModel()
+   // Resets all probabilities and predictions
+{
+   long i;
+
+   // The tables are only allocated if the structure coder is actually used
+   if(preds1==NULL)
+   {
+      preds1=new TStructPred[1L<<STRUCTCODER_PREDBITS1];
+      preds2=new TStructPred[1L<<STRUCTCODER_PREDBITS2];
+      kindprobs=new TStructProb[8L<<STRUCTCODER_KINDBITS];
+      numprobs=new TStructProb[1L<<STRUCTCODER_NUMBITS];
+      history=new unsigned int[1L<<STRUCTCODER_HISTBITS];
+      matchtable=new unsigned int[1L<<STRUCTCODER_MATCHBITS];
+      if((preds1==NULL)||(preds2==NULL)||
+         (kindprobs==NULL)||(numprobs==NULL)||
+         (history==NULL)||(matchtable==NULL))
+         ExitNoMem();
+   }
+
+   // No token is predicted initially
+   InitPredictions(preds1,1L<<STRUCTCODER_PREDBITS1);
+   InitPredictions(preds2,1L<<STRUCTCODER_PREDBITS2);
+   InitProbs(kindprobs,8L<<STRUCTCODER_KINDBITS);
+   InitProbs(numprobs,1L<<STRUCTCODER_NUMBITS);
+   InitProbs(matchprobs,STRUCTCODER_MATCHCTXNUM);
+
+   for(i=0;i<(1L<<STRUCTCODER_MATCHBITS);i++)
+      matchtable[i]=0;
+   histpos=0;
+   matchlen=0;
+
+   for(i=0;i<STRUCTCODER_ORDER;i++)
+      prevtokens[i]=STRUCTCODER_NOTOKEN;
+
+   depth=0;
+}
+
+void StructModel::UpdateContext(unsigned long token,unsigned char kind)
+   // Updates the label stack and the previous tokens after 'token'
+{
+   int i;
+
+   switch(kind)
+   {
+   case STRUCTKIND_LABEL:
+      if(depth<STRUCTCODER_MAXDEPTH)
+         labelstack[depth]=(TLabelID)((token>>1)-LABELIDX_TOKENOFFS);
+      depth++;
+      break;
+
+   case STRUCTKIND_ENDLABEL:
+   case STRUCTKIND_EMPTYENDLABEL:
+      // If the block started within an element, then
+      // the stack can be empty
+      if(depth>0)
+         depth--;
+      break;
+   }
+
+   for(i=STRUCTCODER_ORDER-1;i>0;i--)
+      prevtokens[i]=prevtokens[i-1];
+   prevtokens[0]=token;
+}
+
+int StructModel::GetPredictions(unsigned long *preds,TStructProb **probs)
+   // Determines the distinct predictions for the next token and their probabilities
+   // The function returns the number of predictions
+{
+   unsigned long  pred1,pred2,predmatch;
+   TStructProb    *matchprob;
+   int            prednum=0;
+
+   ComputeContext();
+
+   pred1=preds1[predidx1].token;
+   pred2=preds2[predidx2].token;
+   predmatch=(matchlen>0) ? history[matchptr&STRUCTCODER_HISTMASK] : STRUCTCODER_NOTOKEN;
+
+   // The match is tried first, if it is more likely than the first prediction
+   if((predmatch!=STRUCTCODER_NOTOKEN)&&(predmatch!=pred1))
+   {
+      if(pred1==STRUCTCODER_NOTOKEN)
+         matchprob=GetMatchProb(0);
+      else
+      {
+         matchprob=GetMatchProb(1);
+         if(*matchprob<=preds1[predidx1].prob)
+         {
+            preds[prednum]=pred1;
+            probs[prednum]=&(preds1[predidx1].prob);
+            prednum++;
+            matchprob=GetMatchProb(2);
+         }
+      }
+      preds[prednum]=predmatch;
+      probs[prednum]=matchprob;
+      prednum++;
+   }
+
+   if((pred1!=STRUCTCODER_NOTOKEN)&&((prednum==0)||(preds[0]!=pred1)))
+   {
+      preds[prednum]=pred1;
+      probs[prednum]=&(preds1[predidx1].prob);
+      prednum++;
+   }
+
+   if((pred2!=STRUCTCODER_NOTOKEN)&&(pred2!=pred1)&&(pred2!=predmatch))
+   {
+      preds[prednum]=pred2;
+      probs[prednum]=&(preds2[predidx2].prob);
+      prednum++;
+   }
+   return prednum;
+}
+
+void StructModel::UpdateMatch(unsigned long token)
+   // Appends 'token' to the history and updates the match
+   // If there is no match, we look for the last occurrence of
+   // the last STRUCTCODER_MATCHORDER tokens
+{
+   unsigned int   h;
+   int            i;
+
+   if(matchlen>0)
+   {
+      if(history[matchptr&STRUCTCODER_HISTMASK]==token)
+      {
+         matchlen++;
+         matchptr++;
+      }
+      else
+         matchlen=0;
+   }
+
+   history[histpos&STRUCTCODER_HISTMASK]=(unsigned int)token;
+   histpos++;
+
+   if(histpos<STRUCTCODER_MATCHORDER)
+      return;
+
+   h=0;
+   for(i=1;i<=STRUCTCODER_MATCHORDER;i++)
+      h=(h^history[(histpos-i)&STRUCTCODER_HISTMASK])*2654435761U;
+   h=(h^(h>>15))>>(32-STRUCTCODER_MATCHBITS);
+
+   // The position must still be in the history
+   if((matchlen==0)&&(matchtable[h]!=0)&&
+      (histpos-matchtable[h]<=STRUCTCODER_HISTMASK))
+   {
+      matchptr=matchtable[h];
+      matchlen=1;
+   }
+   matchtable[h]=(unsigned int)histpos;
+}
+
+inline unsigned int GetProb(TStructProb *prob)
+   // Returns the 12-bit probability of a 1-bit
+{
+   return *prob>>4;
+}
+
+inline void UpdateProb(TStructProb *prob,int bit)
+   // Adapts the probability of a 1-bit
+   // The probability always stays between 0 and 4096 (exclusive)
+{
+   unsigned int p=*prob>>4,count=*prob&15;
+
+   if(bit)
+      p+=((4096-p)*structprob_rates[count])>>16;
+   else
+      p-=(p*structprob_rates[count])>>16;
+
+   if(count<STRUCTPROB_MAXCOUNT)
+      count++;
+
+   *prob=(TStructProb)((p<<4)|count);
+}
+
+//**************************************************************************
+//**************************************************************************
+
+// The encoder
+
+void StructEncoder::StartBlock(CompressContainer *mycont)
+   // Starts a new block - the output is sent to 'mycont'
+{
+   ResetModel();
+   cont=mycont;
+   low=0;
+   high=0xFFFFFFFFU;
+}
+
+inline void StructEncoder::EncodeBit(TStructProb *prob,int bit)
+   // Encodes a bit with the adaptive probability '*prob'
+{
+   unsigned int mid=low+((high-low)>>12)*GetProb(prob);
+
+   if(bit)
+      high=mid;
+   else
+      low=mid+1;
+
+   UpdateProb(prob,bit);
+
+   // We shift out all leading bytes that are equal
+   while(((low^high)&0xFF000000U)==0)
+   {
+      cont->StoreChar((unsigned char)(high>>24));
+      low<<=8;
+      high=(high<<8)|255;
+   }
+}
+
+void StructEncoder::EncodeKind(unsigned char kind)
+   // Encodes the kind of the token
+{
+   TStructProb *probs=GetKindProbs();
+   int         i,bit,node=1;
+
+   for(i=2;i>=0;i--)
+   {
+      bit=(kind>>i)&1;
+      EncodeBit(probs+node,bit);
+      node=(node<<1)|bit;
+   }
+}
+
+void StructEncoder::EncodeNumber(int idx,unsigned long val)
+   // Encodes a label ID (idx=0) or a block ID (idx=1)
+   // First, we encode the number of bits and then the bits
+   // below the most significant bit
+{
+   unsigned int   h=ctxhash+idx;
+   unsigned long  tmpval=val,prefix=1;
+   int            bitnum=0,i,bit,node=1;
+
+   while(tmpval!=0)
+   {
+      bitnum++;
+      tmpval>>=1;
+   }
+
+   for(i=5;i>=0;i--)
+   {
+      bit=(bitnum>>i)&1;
+      EncodeBit(GetNumProb(h,node),bit);
+      node=(node<<1)|bit;
+   }
+
+   for(i=bitnum-2;i>=0;i--)
+   {
+      bit=(val>>i)&1;
+      EncodeBit(GetNumProb(h,(unsigned int)(prefix<<6)+node),bit);
+      prefix=(prefix<<1)|bit;
+   }
+}
+
+inline char StructEncoder::EncodePredictions(unsigned long token)
+   // Encodes whether 'token' is one of the predicted tokens
+   // Returns 1 if the token has been predicted correctly
+{
+   unsigned long  preds[3];
+   TStructProb    *probs[3];
+   int            i,prednum=GetPredictions(preds,probs);
+
+   for(i=0;i<prednum;i++)
+   {
+      if(preds[i]==token)
+      {
+         EncodeBit(probs[i],1);
+         return 1;
+      }
+      EncodeBit(probs[i],0);
+   }
+   return 0;
+}
+
+void StructEncoder::EncodeToken(char isneg,unsigned long val)
+   // Encodes a structure token
+{
+   unsigned long  token=(val<<1)|(isneg ? 1 : 0);
+   unsigned char  kind;
+
+   if(isneg)
+      kind=STRUCTKIND_TEXT;
+   else
+      kind=(val<LABELIDX_TOKENOFFS) ? (unsigned char)val : STRUCTKIND_LABEL;
+
+   if(EncodePredictions(token)==0)
+   {
+      EncodeKind(kind);
+
+      if(kind==STRUCTKIND_LABEL)
+         EncodeNumber(0,val-LABELIDX_TOKENOFFS);
+      else
+      {
+         if(kind==STRUCTKIND_TEXT)
+            EncodeNumber(1,val);
+      }
+   }
+   UpdatePredictions(token);
+   UpdateContext(token,kind);
+}
+
+void StructEncoder::FinishBlock()
+   // Encodes the end of the block and flushes the coder
+{
+   // The end of the block is never predicted
+   EncodePredictions(STRUCTCODER_NOTOKEN);
+   EncodeKind(STRUCTKIND_ENDOFBLOCK);
+
+   // We store the entire lower bound, since the decoder
+   // always reads four bytes ahead
+   cont->StoreChar((unsigned char)(low>>24));
+   cont->StoreChar((unsigned char)(low>>16));
+   cont->StoreChar((unsigned char)(low>>8));
+   cont->StoreChar((unsigned char)low);
+}
+
+//**************************************************************************
+//**************************************************************************
+
+// The decoder
+
+void StructDecoder::StartBlock(unsigned char *ptr,unsigned long len)
+   // Starts decoding the block at 'ptr'
+{
+   ResetModel();
+
+   curptr=ptr;
+   endptr=ptr+len;
+
+   low=0;
+   high=0xFFFFFFFFU;
+   code=LoadByte();
+   code=(code<<8)|LoadByte();
+   code=(code<<8)|LoadByte();
+   code=(code<<8)|LoadByte();
+}
+
+inline int StructDecoder::DecodeBit(TStructProb *prob)
+   // Decodes a bit with the adaptive probability '*prob'
+{
+   unsigned int   mid=low+((high-low)>>12)*GetProb(prob);
+   int            bit;
+
+   if(code<=mid)
+   {
+      high=mid;
+      bit=1;
+   }
+   else
+   {
+      low=mid+1;
+      bit=0;
+   }
+
+   UpdateProb(prob,bit);
+
+   while(((low^high)&0xFF000000U)==0)
+   {
+      low<<=8;
+      high=(high<<8)|255;
+      code=(code<<8)|LoadByte();
+   }
+   return bit;
+}
+
+unsigned char StructDecoder::DecodeKind()
+   // Decodes the kind of the token
+{
+   TStructProb *probs=GetKindProbs();
+   int         i,node=1;
+
+   for(i=0;i<3;i++)
+      node=(node<<1)|DecodeBit(probs+node);
+
+   return (unsigned char)(node-8);
+}
+
+unsigned long StructDecoder::DecodeNumber(int idx)
+   // Decodes a label ID (idx=0) or a block ID (idx=1)
+{
+   unsigned int   h=ctxhash+idx;
+   unsigned long  val;
+   int            bitnum,i,node=1;
+
+   for(i=0;i<6;i++)
+      node=(node<<1)|DecodeBit(GetNumProb(h,node));
+
+   bitnum=node-64;
+   if(bitnum==0)
+      return 0;
+
+   if(bitnum>32)
+      ExitCorruptFile();
+
+   val=1;
+   for(i=bitnum-2;i>=0;i--)
+      val=(val<<1)|DecodeBit(GetNumProb(h,(unsigned int)(val<<6)+node));
+
+   return val;
+}
+
+inline unsigned long StructDecoder::DecodePredictions()
+   // Decodes whether the next token is one of the predicted tokens
+   // Returns the token or STRUCTCODER_NOTOKEN
+{
+   unsigned long  preds[3];
+   TStructProb    *probs[3];
+   int            i,prednum=GetPredictions(preds,probs);
+
+   for(i=0;i<prednum;i++)
+   {
+      if(DecodeBit(probs[i]))
+         return preds[i];
+   }
+   return STRUCTCODER_NOTOKEN;
+}
+
+char StructDecoder::DecodeToken(unsigned long *val,char *isneg)
+   // Decodes the next structure token into '*val' and '*isneg'
+   // The function returns 0 if the end of the block has been reached
+{
+   unsigned long  token=DecodePredictions();
+   unsigned char  kind;
+
+   if(token!=STRUCTCODER_NOTOKEN)
+   {
+      if(token&1)
+         kind=STRUCTKIND_TEXT;
+      else
+         kind=((token>>1)<LABELIDX_TOKENOFFS) ? (unsigned char)(token>>1) : STRUCTKIND_LABEL;
+   }
+   else
+   {
+      kind=DecodeKind();
+      switch(kind)
+      {
+      case STRUCTKIND_ENDOFBLOCK:
+         return 0;
+
+      case STRUCTKIND_LABEL:
+         token=(DecodeNumber(0)+LABELIDX_TOKENOFFS)<<1;
+         break;
+
+      case STRUCTKIND_TEXT:
+         token=(DecodeNumber(1)<<1)|1;
+         break;
+
+      default:
+         token=kind<<1;
+      }
+   }
+   UpdatePredictions(token);
+   UpdateContext(token,kind);
+
+   *val=token>>1;
+   *isneg=(char)(token&1);
+   return 1;
+}
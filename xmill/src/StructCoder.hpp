@@ -0,0 +1,276 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module implements the structure coder. Instead of storing each
+// structure token as a variable-length integer that is later compressed by
+// zlib, the structure coder predicts the next token from the parent label
+// (i.e. the top of the current path) and the previous tokens and encodes the
+// token with an adaptive binary arithmetic coder.
+// For regular documents, almost all tokens are predicted correctly and
+// cost only a small fraction of a bit.
+//
+// There are three predictions: the token following the last occurrence
+// of the last six tokens (i.e. the match prediction), a prediction based
+// on the parent label and the last three tokens and one based on the parent
+// label and the last token only.
+// A token is encoded as follows:
+//    - For each of the predictions that differ from the previous ones,
+//      a bit telling whether the token is that prediction
+//    - If not, the kind of the token (end label, white space, start label, text, ...)
+//      as a three-bit binary tree
+//    - For start labels and text tokens, the label ID/block ID as
+//      the number of bits followed by the bits themselves.
+// The kind and the IDs are modeled in the context of the parent label and the last token.
+// The model is reset at the beginning of each block, so that
+// blocks can be decoded independently of each other.
+
+#ifndef STRUCTCODER_HPP
+#define STRUCTCODER_HPP
+
+#include "Types.hpp"
+#include "Error.hpp"
+
+class CompressContainer;
+
+#define STRUCTCODER_ORDER     3     // The number of previous tokens for the first prediction
+#define STRUCTCODER_PREDBITS1 16    // The number of index bits of the first prediction table
+#define STRUCTCODER_PREDBITS2 16    // The number of index bits of the second prediction table
+#define STRUCTCODER_KINDBITS  12    // The number of index bits of the kind contexts
+#define STRUCTCODER_NUMBITS   18    // The number of index bits of the label/block ID contexts
+#define STRUCTCODER_MAXDEPTH  256   // The maximum depth of the label stack
+
+#define STRUCTCODER_HISTBITS  20    // The number of index bits of the token history
+#define STRUCTCODER_MATCHBITS 16    // The number of index bits of the match table
+#define STRUCTCODER_MATCHORDER 6    // The number of tokens that are hashed for the match table
+#define STRUCTCODER_MATCHCTXNUM 96  // The number of contexts of the match probability
+#define STRUCTCODER_HISTMASK  ((1L<<STRUCTCODER_HISTBITS)-1)
+
+#define STRUCTCODER_NOTOKEN   0xFFFFFFFFUL   // Denotes a missing prediction
+
+// The kinds of tokens
+#define STRUCTKIND_ENDLABEL         TREETOKEN_ENDLABEL
+#define STRUCTKIND_EMPTYENDLABEL    TREETOKEN_EMPTYENDLABEL
+#define STRUCTKIND_WHITESPACE       TREETOKEN_WHITESPACE
+#define STRUCTKIND_ATTRIBWHITESPACE TREETOKEN_ATTRIBWHITESPACE
+#define STRUCTKIND_SPECIAL          TREETOKEN_SPECIAL
+#define STRUCTKIND_LABEL            5
+#define STRUCTKIND_TEXT             6
+#define STRUCTKIND_ENDOFBLOCK       7
+
+// A probability is stored in 16 bits: the upper 12 bits contain the
+// probability of a 1-bit and the lower 4 bits count the number of updates.
+// The probabilities adapt quickly at first and more slowly later on.
+typedef unsigned short TStructProb;
+
+struct TStructPred
+   // A prediction for a context
+{
+   unsigned int   token;   // The predicted token
+   TStructProb    prob;    // The probability that the prediction is correct
+};
+
+class StructModel
+   // The context model that is shared by the encoder and the decoder
+{
+protected:
+   TStructPred    *preds1,*preds2;           // The predictions for each context
+   TStructProb    *kindprobs;                // The probabilities of the kind bit trees
+   TStructProb    *numprobs;                 // The probabilities of the label/block ID bits
+   TStructProb    matchprobs[STRUCTCODER_MATCHCTXNUM];
+                                             // The probabilities that the match prediction is correct
+
+   unsigned int   *history;      // The tokens of the current block (as a ring buffer)
+   unsigned int   *matchtable;   // The history position after the last occurrence of each context
+   unsigned long  histpos;       // The number of tokens in the current block
+   unsigned long  matchptr;      // The history position of the match prediction
+   unsigned long  matchlen;      // The length of the current match (0, if there is no match)
+
+   TLabelID       labelstack[STRUCTCODER_MAXDEPTH];   // The stack of the open labels
+   unsigned long  depth;                     // The current depth
+   unsigned long  prevtokens[STRUCTCODER_ORDER];      // The previous tokens
+
+   unsigned int   ctxhash;                   // The hash of the parent label and the last token
+   unsigned long  predidx1,predidx2;         // The indices of the predictions for the current token
+
+   void ResetModel();
+      // Resets all probabilities and predictions
+
+   TLabelID GetParentLabel()
+      // Returns the label at the top of the stack
+   {
+      if(depth==0)
+         return LABEL_UNDEFINED;
+      return labelstack[(depth<=STRUCTCODER_MAXDEPTH) ? depth-1 : STRUCTCODER_MAXDEPTH-1];
+   }
+
+   void ComputeContext()
+      // Computes the context hash and the indices of the predictions
+   {
+      unsigned int   h;
+      int            i;
+
+      ctxhash=((unsigned int)GetParentLabel()+1)*2654435761U;
+      ctxhash=(ctxhash^(unsigned int)prevtokens[0])*0x85EBCA6BU;
+      ctxhash^=ctxhash>>15;
+      predidx2=ctxhash>>(32-STRUCTCODER_PREDBITS2);
+
+      h=ctxhash;
+      for(i=1;i<STRUCTCODER_ORDER;i++)
+         h=(h^(unsigned int)prevtokens[i])*0xC2B2AE35U;
+      predidx1=(h^(h>>15))>>(32-STRUCTCODER_PREDBITS1);
+   }
+
+   TStructProb *GetMatchProb(int state)
+      // Returns the probability of the match prediction depending on the
+      // match length and on the first prediction: 'state' is 0, if there
+      // is no first prediction, and 1 or 2, if the match is tried before
+      // or after the first prediction
+   {
+      unsigned long len=matchlen,bucket=matchlen;
+
+      // Long matches are grouped logarithmically
+      if(len>=16)
+      {
+         bucket=15;
+         while((len>=16)&&(bucket<31))
+         {
+            len>>=1;
+            bucket++;
+         }
+      }
+      return matchprobs+bucket*3+state;
+   }
+
+   int GetPredictions(unsigned long *preds,TStructProb **probs);
+      // Determines the distinct predictions for the next token and their probabilities
+      // The function returns the number of predictions
+
+   void UpdateMatch(unsigned long token);
+      // Appends 'token' to the history and updates the match
+
+   void UpdatePredictions(unsigned long token)
+      // Sets 'token' as the prediction for the current context
+   {
+      preds1[predidx1].token=(unsigned int)token;
+      preds2[predidx2].token=(unsigned int)token;
+      UpdateMatch(token);
+   }
+
+   TStructProb *GetKindProbs()
+      // Returns the probabilities of the kind bit tree for the current context
+   {
+      return kindprobs+((ctxhash>>(32-STRUCTCODER_KINDBITS))<<3);
+   }
+
+   TStructProb *GetNumProb(unsigned int h,unsigned int key)
+      // Returns the probability of the label/block ID bit
+      // identified by 'key' in context 'h'
+   {
+      h=(h^(key*2654435761U))*0x85EBCA6BU;
+      return numprobs+((h^(h>>15))>>(32-STRUCTCODER_NUMBITS));
+   }
+
+   void UpdateContext(unsigned long token,unsigned char kind);
+      // Updates the label stack and the previous tokens after 'token'
+
+public:
+   StructModel();
+   ~StructModel();
+};
+
+//**************************************************************************
+
+class StructEncoder : public StructModel
+   // The encoder for the structure tokens
+{
+   unsigned int      low,high;   // The current range
+   CompressContainer *cont;      // The container that receives the output
+
+   void EncodeBit(TStructProb *prob,int bit);
+      // Encodes a bit with the adaptive probability '*prob'
+
+   void EncodeNumber(int idx,unsigned long val);
+      // Encodes a label ID (idx=0) or a block ID (idx=1)
+
+   void EncodeKind(unsigned char kind);
+      // Encodes the kind of the token
+
+   char EncodePredictions(unsigned long token);
+      // Encodes whether 'token' is one of the predicted tokens
+
+public:
+   void StartBlock(CompressContainer *mycont);
+      // Starts a new block - the output is sent to 'mycont'
+
+   void EncodeToken(char isneg,unsigned long val);
+      // Encodes a structure token
+      // If 'isneg' is 1, then 'val' is a block ID of a text token
+      // Otherwise, 'val' is one of TREETOKEN_... or a label ID + LABELIDX_TOKENOFFS
+
+   void FinishBlock();
+      // Encodes the end of the block and flushes the coder
+};
+
+//**************************************************************************
+
+class StructDecoder : public StructModel
+   // The decoder for the structure tokens
+{
+   unsigned int   low,high,code; // The current range and the code value
+   unsigned char  *curptr,*endptr;
+
+   unsigned char LoadByte()
+      // The encoder flushes exactly the bytes that the decoder reads,
+      // hence we never read beyond the end of a valid block
+   {
+      if(curptr>=endptr)
+         ExitCorruptFile();
+      return *(curptr++);
+   }
+
+   int DecodeBit(TStructProb *prob);
+      // Decodes a bit with the adaptive probability '*prob'
+
+   unsigned long DecodeNumber(int idx);
+      // Decodes a label ID (idx=0) or a block ID (idx=1)
+
+   unsigned char DecodeKind();
+      // Decodes the kind of the token
+
+   unsigned long DecodePredictions();
+      // Decodes whether the next token is one of the predicted tokens
+
+public:
+   void StartBlock(unsigned char *ptr,unsigned long len);
+      // Starts decoding the block at 'ptr'
+
+   char DecodeToken(unsigned long *val,char *isneg);
+      // Decodes the next structure token into '*val' and '*isneg'
+      // The function returns 0 if the end of the block has been reached
+};
+
+extern StructEncoder structencoder;
+extern StructDecoder structdecoder;
+
+#endif
@@ -0,0 +1,155 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+//**************************************************************************
+//**************************************************************************
+
+// This module contains a thin wrapper around the native thread
+// library (Win32 threads or POSIX threads). It is used by the
+// modules that distribute work over several worker threads.
+
+#ifndef THREAD_HPP
+#define THREAD_HPP
+
+#ifdef WIN32
+#include <windows.h>
+#undef CreateFile    // Would otherwise rename 'Output::CreateFile'
+#else
+#include <pthread.h>
+#endif
+
+typedef void (*XMillThreadFunc)(void *arg);
+   // The type of a thread's main function
+
+class XMillThread
+   // Represents a single worker thread
+{
+   XMillThreadFunc   func;    // The main function of the thread
+   void              *arg;    // The argument passed to 'func'
+#ifdef WIN32
+   HANDLE            handle;
+#else
+   pthread_t         handle;
+#endif
+   char              isrunning;
+
+#ifdef WIN32
+   static DWORD WINAPI ThreadMain(LPVOID thread)
+   {
+      ((XMillThread *)thread)->func(((XMillThread *)thread)->arg);
+      return 0;
+   }
+#else
+   static void *ThreadMain(void *thread)
+   {
+      ((XMillThread *)thread)->func(((XMillThread *)thread)->arg);
+      return NULL;
+   }
+#endif
+
+public:
+   XMillThread()  {  isrunning=0; }
+
+   char Start(XMillThreadFunc myfunc,void *myarg)
+      // Starts the thread with function 'myfunc' and argument 'myarg'
+      // The function returns 0, if the thread could not be created
+   {
+      func=myfunc;
+      arg=myarg;
+#ifdef WIN32
+      handle=CreateThread(NULL,0,ThreadMain,this,0,NULL);
+      if(handle==NULL)
+         return 0;
+#else
+      if(pthread_create(&handle,NULL,ThreadMain,this)!=0)
+         return 0;
+#endif
+      isrunning=1;
+      return 1;
+   }
+
+   void Join()
+      // Waits until the thread finished
+   {
+      if(isrunning==0)
+         return;
+#ifdef WIN32
+      WaitForSingleObject(handle,INFINITE);
+      CloseHandle(handle);
+#else
+      pthread_join(handle,NULL);
+#endif
+      isrunning=0;
+   }
+};
+
+//**************************************************************************
+
+class XMillMutex
+   // A simple mutual exclusion lock
+{
+   friend class XMillCondition;
+
+#ifdef WIN32
+   CRITICAL_SECTION  mutex;
+#else
+   pthread_mutex_t   mutex;
+#endif
+
+public:
+#ifdef WIN32
+   XMillMutex()   {  InitializeCriticalSection(&mutex);  }
+   ~XMillMutex()  {  DeleteCriticalSection(&mutex);   }
+   void Lock()    {  EnterCriticalSection(&mutex); }
+   void Unlock()  {  LeaveCriticalSection(&mutex); }
+#else
+   XMillMutex()   {  pthread_mutex_init(&mutex,NULL); }
+   ~XMillMutex()  {  pthread_mutex_destroy(&mutex);   }
+   void Lock()    {  pthread_mutex_lock(&mutex);   }
+   void Unlock()  {  pthread_mutex_unlock(&mutex); }
+#endif
+};
+
+//**************************************************************************
+
+class XMillCondition
+   // A condition variable - a thread waits with a locked mutex
+   // until another thread signals that the condition might have changed
+{
+#ifdef WIN32
+   CONDITION_VARIABLE   cond;
+#else
+   pthread_cond_t       cond;
+#endif
+
+public:
+#ifdef WIN32
+   XMillCondition()  {  InitializeConditionVariable(&cond);  }
+   void Wait(XMillMutex *mutex)  {  SleepConditionVariableCS(&cond,&(mutex->mutex),INFINITE);  }
+   void SignalAll()  {  WakeAllConditionVariable(&cond);  }
+#else
+   XMillCondition()  {  pthread_cond_init(&cond,NULL);  }
+   ~XMillCondition() {  pthread_cond_destroy(&cond);  }
+   void Wait(XMillMutex *mutex)  {  pthread_cond_wait(&cond,&(mutex->mutex));  }
+   void SignalAll()  {  pthread_cond_broadcast(&cond);  }
+#endif
+};
+
+#endif
@@ -42,6 +42,14 @@ typedef unsigned short TLabelID;
 typedef unsigned short TContID;
 #define CONTID_UNDEFINED ((TContID)65535)
 
+// A position or size in a file - the files can be larger than 4GB
+#ifdef WIN32
+typedef __int64   TFilePos;
+#else
+#include <sys/types.h>
+typedef off_t     TFilePos;
+#endif
+
 #define SMALLCONT_THRESHOLD   2000
 
 
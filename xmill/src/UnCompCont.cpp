@@ -34,20 +34,57 @@ History:
 #include "VPathExprMan.hpp"
 #include "Types.hpp"
 #include "SmallUncompress.hpp"
+#include "Input.hpp"
+#include "Compress.hpp"
 
 extern VPathExprMan pathexprman;
 
 UncompressContainerMan  uncomprcont;
 
+// The size of the buffer for the compressed data of a streamed container
+#define UNCOMPRESS_STREAMINBUF   16384L
+
+struct UncompressStream
+   // The state of a container that is decompressed incrementally
+{
+   Uncompressor   uncompressor;
+   unsigned long  windowsize;    // The size of the window 'dataptr'
+   unsigned long  remaining;     // The number of bytes that are not decompressed yet
+
+   unsigned char  *compressed;   // The compressed data
+   unsigned char  *nextin;       // The next compressed data to be decompressed
+   unsigned long  availin;       // The number of bytes at 'nextin'
+
+   TFilePos       filepos;       // If the data is read from the file, this is the
+   unsigned long  fileremaining; // position and size of the compressed data that
+                                 // has not been read into 'compressed'
+};
+
+static FILE *streamfile=NULL;
+   // The file for reading the compressed data of streamed containers
+
 inline void UncompressContainer::AllocateContMem(unsigned long mincontsize)
    // Allocates the memory - but only if the size is larger than 'mincontsize'
    // This will allows us to allocate memory starting with the largest
    // containers. Then, smaller containers can be allocated.
 {
-   if((dataptr!=NULL)||(size<mincontsize))
+   if((dataptr!=NULL)||(stream!=NULL)||(size<mincontsize))
       return;
 
    curptr=dataptr=AllocateMemBlock(size);
+   endptr=dataptr+size;
+}
+
+void UncompressContainer::SetStreamed()
+   // Marks the container to be decompressed incrementally
+   // The window is allocated when the container is loaded
+{
+   stream=new UncompressStream();
+   if(stream==NULL)
+      ExitNoMem();
+
+   stream->windowsize=0;
+   stream->compressed=NULL;
 }
 
 inline void UncompressContainerBlock::Load(SmallBlockUncompressor *uncompressor)
@@ -64,6 +101,8 @@ inline void UncompressContainerBlock::Load(SmallBlockUncompressor *uncompressor)
    // Let's load the number of containers
    contnum=uncompressor->LoadUInt32();
 
+   isskipped=0;
+
    if((pathexpr!=NULL)&&(pathexpr->UnGetUserContNum()!=contnum))
    {
       Error("Corrupt compressed file !");
@@ -91,11 +130,13 @@ inline void UncompressContainerBlock::AllocateContMem(unsigned long mincontsize)
 //****************************************************************************
 //****************************************************************************
 
-void UncompressContainerMan::Load(SmallBlockUncompressor *uncompressor)
+char UncompressContainerMan::Load(SmallBlockUncompressor *uncompressor)
    // Loads the structural information from the small block decompressor
 {
    // The number of container blocks
    blocknum=uncompressor->LoadUInt32();
+   if(blocknum==0)
+      return 0;
 
    // Let's allocate the container block array
    blockarray=(UncompressContainerBlock *)blockmem.GetByteBlock(sizeof(UncompressContainerBlock)*blocknum);
@@ -103,6 +144,8 @@ void UncompressContainerMan::Load(SmallBlockUncompressor *uncompressor)
    // Let's load the structural information for all container blocks
    for(unsigned i=0;i<blocknum;i++)
       blockarray[i].Load(uncompressor);
+
+   return 1;
 }
 
 
@@ -144,10 +187,16 @@ void UncompressContainer::UncompressSmallContainer(SmallBlockUncompressor *uncom
    memcpy(dataptr,srcptr,size);
 }
 
-void UncompressContainer::UncompressLargeContainer(Input *input)
+void UncompressContainer::UncompressLargeContainer(Input *input,unsigned long compressedsize)
    // Decompresses the large container data and stores
    // it in the data buffer
 {
+   if(stream!=NULL)
+   {
+      LoadStream(input,compressedsize);
+      return;
+   }
+
    Uncompressor uncompress;
    unsigned long  uncompsize=size;
 
@@ -159,6 +208,173 @@ void UncompressContainer::UncompressLargeContainer(Input *input)
    }
 }
 
+void UncompressContainer::LoadStream(Input *input,unsigned long compressedsize)
+   // Finds the compressed data of a streamed container in 'input'
+   // and decompresses the first window
+   // If the data is read from the file, we only remember the position of the data.
+   // Otherwise, the compressed data is kept in memory.
+   // Without the compressed size, the data is decompressed once to find its end.
+{
+   TFilePos       startpos=input->GetDataPos();
+   unsigned long  capturesize=0;
+
+   stream->windowsize=UNCOMPRESS_STREAMWINDOW;
+   curptr=endptr=dataptr=(unsigned char *)malloc(stream->windowsize+4);
+   if(dataptr==NULL)
+      ExitNoMem();
+
+   if(compressedsize==0)
+   {
+      unsigned char  *srcptr;
+      unsigned long  srclen,len;
+      int            avail;
+      char           ismore;
+
+      do
+      {
+         avail=input->GetCurBlockPtr((char **)&srcptr);
+         if(avail==0)
+         {
+            input->RefillAndGetCurBlockPtr((char **)&srcptr,&avail);
+            if(avail==0)
+               ExitCorruptFile();
+         }
+         srclen=avail;
+
+         // We decompress into the window, until the compressed
+         // data in the buffer is consumed
+         do
+         {
+            len=stream->windowsize;
+            ismore=stream->uncompressor.UncompressData(&srcptr,&srclen,dataptr,&len);
+         }
+         while(ismore&&(len>0));
+
+         if(streamfile==NULL)
+            // We keep the compressed data
+         {
+            if(compressedsize+avail-srclen>capturesize)
+            {
+               capturesize=(compressedsize+avail-srclen)*2;
+               stream->compressed=(unsigned char *)realloc(stream->compressed,capturesize);
+               if(stream->compressed==NULL)
+                  ExitNoMem();
+            }
+            memcpy(stream->compressed+compressedsize,srcptr-(avail-srclen),avail-srclen);
+         }
+         compressedsize+=avail-srclen;
+         input->SkipData(avail-srclen);
+      }
+      while(ismore);
+   }
+   else
+   {
+      if(streamfile==NULL)
+      {
+         stream->compressed=(unsigned char *)malloc(compressedsize);
+         if(stream->compressed==NULL)
+            ExitNoMem();
+         if(input->ReadData((char *)stream->compressed,compressedsize))
+            ExitCorruptFile();
+      }
+      else
+      {
+         if(input->SeekData(compressedsize)==0)
+            ExitCorruptFile();
+      }
+   }
+
+   if(streamfile==NULL)
+   {
+      stream->nextin=stream->compressed;
+      stream->availin=compressedsize;
+      stream->fileremaining=0;
+   }
+   else
+   {
+      stream->compressed=(unsigned char *)malloc(UNCOMPRESS_STREAMINBUF);
+      if(stream->compressed==NULL)
+         ExitNoMem();
+      stream->availin=0;
+      stream->filepos=startpos;
+      stream->fileremaining=compressedsize;
+   }
+   stream->remaining=size;
+
+   Refill(0);
+}
+
+void UncompressContainer::Refill(unsigned long len)
+   // Makes the next 'len' bytes available in the window of a streamed
+   // container - or all remaining bytes, if there are fewer bytes
+   // The rest of the window is moved to the beginning and the window
+   // is filled with decompressed data
+{
+   if(stream==NULL)
+      return;
+
+   unsigned long  restlen=endptr-curptr;
+   unsigned long  outlen;
+
+   if(len>stream->windowsize)
+      // A single item is larger than the window
+   {
+      unsigned char *newwindow=(unsigned char *)malloc(len+4);
+      if(newwindow==NULL)
+         ExitNoMem();
+      memcpy(newwindow,curptr,restlen);
+      free(dataptr);
+      dataptr=newwindow;
+      stream->windowsize=len;
+   }
+   else
+      memmove(dataptr,curptr,restlen);
+
+   curptr=dataptr;
+   endptr=dataptr+restlen;
+
+   while((stream->remaining>0)&&(endptr<dataptr+stream->windowsize))
+   {
+      if((stream->availin==0)&&(stream->fileremaining>0))
+         // We read more compressed data from the file
+      {
+         stream->availin=(stream->fileremaining<UNCOMPRESS_STREAMINBUF) ? stream->fileremaining : UNCOMPRESS_STREAMINBUF;
+
+         if((SeekFile(streamfile,stream->filepos)!=0)||
+            (fread(stream->compressed,1,stream->availin,streamfile)!=stream->availin))
+            ExitCorruptFile();
+
+         stream->nextin=stream->compressed;
+         stream->filepos+=stream->availin;
+         stream->fileremaining-=stream->availin;
+      }
+
+      outlen=dataptr+stream->windowsize-endptr;
+      if(outlen>stream->remaining)
+         outlen=stream->remaining;
+
+      if(stream->uncompressor.UncompressData(&stream->nextin,&stream->availin,endptr,&outlen)==0)
+      {
+         // The compressed data ends too early?
+         if(outlen<stream->remaining)
+            ExitCorruptFile();
+      }
+      else
+      {
+         // No progress is possible without more compressed data?
+         if((outlen==0)&&(stream->availin==0)&&(stream->fileremaining==0))
+            ExitCorruptFile();
+      }
+
+      endptr+=outlen;
+      stream->remaining-=outlen;
+   }
+
+   // Integers are read without checking the end of the data
+   // Therefore, we terminate the data with zeros
+   memset(endptr,0,4);
+}
+
 //****************************************************************************
 
 void UncompressContainerBlock::UncompressSmallContainers(SmallBlockUncompressor *uncompressor)
@@ -174,17 +390,67 @@ void UncompressContainerBlock::UncompressSmallContainers(SmallBlockUncompressor
    }
 }
 
-void UncompressContainerBlock::UncompressLargeContainers(Input *input)
+void UncompressContainerBlock::UncompressLargeContainers(Input *input,unsigned long *compressedsizes)
    // Decompresses the data of large containers and stores
    // it in the data buffers
 {
    for(unsigned long i=0;i<contnum;i++)
    {
       if(contarray[i].GetSize()>=SMALLCONT_THRESHOLD)
-         contarray[i].UncompressLargeContainer(input);
+      {
+         if(compressedsizes!=NULL)
+            contarray[i].UncompressLargeContainer(input,*(compressedsizes++));
+         else
+            contarray[i].UncompressLargeContainer(input);
+      }
+   }
+}
+
+unsigned long UncompressContainerBlock::SetStreamed(char istreeblock)
+   // Marks the large containers to be decompressed incrementally and
+   // returns their overall size. The structure container of the
+   // first block is never streamed.
+{
+   unsigned long size=0;
+
+   for(unsigned long i=(istreeblock ? 1 : 0);i<contnum;i++)
+   {
+      if(contarray[i].GetSize()>=UNCOMPRESS_STREAMMINSIZE)
+      {
+         contarray[i].SetStreamed();
+         size+=contarray[i].GetSize();
+      }
+   }
+   return size;
+}
+
+void UncompressContainerBlock::SkipLargeContainers(Input *input,unsigned long *compressedsizes)
+   // Skips the large containers in 'input' without decompressing them
+{
+   for(unsigned long i=0;i<contnum;i++)
+   {
+      if(contarray[i].GetSize()>=SMALLCONT_THRESHOLD)
+      {
+         if(input->SeekData(*compressedsizes)==0)
+            ExitCorruptFile();
+         compressedsizes++;
+      }
    }
 }
 
+unsigned long UncompressContainerBlock::GetLargeContNum()
+   // Returns the number of large containers
+{
+   unsigned long num=0;
+
+   for(unsigned long i=0;i<contnum;i++)
+   {
+      if(contarray[i].GetSize()>=SMALLCONT_THRESHOLD)
+         num++;
+   }
+   return num;
+}
+
 //****************************************************************************
 //****************************************************************************
 
@@ -196,12 +462,72 @@ void UncompressContainerMan::UncompressSmallContainers(SmallBlockUncompressor *u
       blockarray[i].UncompressSmallContainers(uncompressor);
 }
 
-void UncompressContainerMan::UncompressLargeContainers(Input *input)
+void UncompressContainerMan::UncompressLargeContainers(Input *input,unsigned long *compressedsizes)
    // Decompresses the data of large containers and stores
    // it in the data buffers
+   // If 'compressedsizes' is not NULL, it contains the compressed size
+   // of each large container
+{
+   for(unsigned long i=0;i<blocknum;i++)
+   {
+      blockarray[i].UncompressLargeContainers(input,compressedsizes);
+      if(compressedsizes!=NULL)
+         compressedsizes+=blockarray[i].GetLargeContNum();
+   }
+}
+
+unsigned long UncompressContainerMan::GetLargeContNum()
+   // Returns the number of large containers
+{
+   unsigned long num=0;
+
+   for(unsigned long i=0;i<blocknum;i++)
+      num+=blockarray[i].GetLargeContNum();
+   return num;
+}
+
+//****************************************************************************
+
+void UncompressContainerMan::StartStreaming(char *filename)
+   // Starts the low-memory mode for the decompression of 'filename'
+   // If 'filename' is NULL, the compressed data of the streamed containers
+   // is kept in memory
+{
+   isstreaming=1;
+
+   if(filename!=NULL)
+   {
+      streamfile=fopen(filename,"rb");
+      if(streamfile==NULL)
+      {
+         Error("Could not open file '");
+         ErrorCont(filename);
+         ErrorCont("'!");
+         Exit();
+      }
+   }
+}
+
+void UncompressContainerMan::FinishStreaming()
+   // Finishes the low-memory mode
+{
+   if(streamfile!=NULL)
+   {
+      fclose(streamfile);
+      streamfile=NULL;
+   }
+   isstreaming=0;
+}
+
+unsigned long UncompressContainerMan::SetStreamed()
+   // Marks the large containers of the current block to be decompressed
+   // incrementally and returns their overall size
 {
+   unsigned long size=0;
+
    for(unsigned long i=0;i<blocknum;i++)
-      blockarray[i].UncompressLargeContainers(input);
+      size+=blockarray[i].SetStreamed(i==0);
+   return size;
 }
 
 //****************************************************************************
@@ -214,6 +540,64 @@ void UncompressContainerMan::Init()
       blockarray[i].Init();
 }
 
+void UncompressContainerMan::LoadSyncState(unsigned char *state,unsigned long statelen)
+   // Moves the containers to the positions of a sync point and
+   // restores the states of the user decompressors
+{
+   unsigned char  *ptr=state,*endptr=state+statelen;
+   unsigned long  syncblocknum,i,j;
+
+   // The container blocks created after the sync point
+   // start at the beginning of their containers
+   syncblocknum=::LoadUInt32(ptr);
+   if(syncblocknum>blocknum)
+      ExitCorruptFile();
+
+   for(i=0;i<syncblocknum;i++)
+   {
+      if(::LoadUInt32(ptr)!=blockarray[i].GetContNum())
+         ExitCorruptFile();
+
+      for(j=0;j<blockarray[i].GetContNum();j++)
+         blockarray[i].GetContainer(j)->SetPos(::LoadUInt32(ptr));
+
+      if(ptr>endptr)
+         ExitCorruptFile();
+   }
+
+   for(i=0;i<syncblocknum;i++)
+      blockarray[i].LoadSyncState(ptr);
+
+   if(ptr!=endptr)
+      ExitCorruptFile();
+}
+
+inline void UncompressContainerBlock::CopyState(UncompressContainerBlock *src)
+   // Copies the containers and the user decompressor state of 'src'
+{
+   unsigned long size=sizeof(UncompressContainer)*src->contnum+
+                      ((src->pathexpr!=NULL) ? src->pathexpr->UnGetUserDataSize() : 0);
+
+   *this=*src;
+
+   // The state space of the user decompressor follows the containers
+   contarray=(UncompressContainer *)blockmem.GetByteBlock(size);
+   mymemcpy((char *)contarray,(char *)src->contarray,size);
+}
+
+void UncompressContainerMan::CopyState(UncompressContainerMan *src)
+   // Makes this container manager a copy of 'src' that shares the container data
+   // The copy is allocated in 'blockmem'
+{
+   blocknum=src->blocknum;
+   isstreaming=src->isstreaming;
+
+   blockarray=(UncompressContainerBlock *)blockmem.GetByteBlock(sizeof(UncompressContainerBlock)*blocknum);
+
+   for(unsigned long i=0;i<blocknum;i++)
+      blockarray[i].CopyState(src->blockarray+i);
+}
+
 
 //****************************************************************************
 //****************************************************************************
@@ -222,6 +606,15 @@ void UncompressContainerMan::Init()
 
 inline void UncompressContainer::ReleaseContMem()
 {
+   if(stream!=NULL)
+   {
+      free(dataptr);
+      free(stream->compressed);
+      delete stream;
+      stream=NULL;
+      dataptr=curptr=endptr=NULL;
+      return;
+   }
    FreeMemBlock(dataptr,size);
 }
 
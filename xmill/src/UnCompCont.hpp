@@ -39,6 +39,15 @@ extern MemStreamer blockmem;
 class VPathExpr;
 class Input;
 class UserUncompressor;
+struct UncompressStream;
+
+// In the low-memory mode (option '-L'), large containers are not
+// decompressed entirely. Instead, the data is decompressed incrementally
+// into a window of UNCOMPRESS_STREAMWINDOW bytes while the container is read.
+// Only containers with at least UNCOMPRESS_STREAMMINSIZE bytes are streamed,
+// since each stream needs the window and the zlib state.
+#define UNCOMPRESS_STREAMWINDOW  65536L
+#define UNCOMPRESS_STREAMMINSIZE 262144L
 
 class UncompressContainer
    // This class represents a single decompressor container
@@ -48,6 +57,15 @@ class UncompressContainer
    unsigned char        *dataptr;   // The pointer to the data
    unsigned long        size;       // The size of the container
    unsigned char        *curptr;    // The current position in the container
+   unsigned char        *endptr;    // The end of the data that is available
+   UncompressStream     *stream;    // The decompression state, if the container is streamed
+
+   void Refill(unsigned long len);
+      // Makes the next 'len' bytes available in the window of a streamed
+      // container - or all remaining bytes, if there are fewer bytes
+   void LoadStream(Input *input,unsigned long compressedsize);
+      // Finds the compressed data of a streamed container in 'input'
+      // and decompresses the first window
 
 public:
 
@@ -58,11 +76,18 @@ public:
       // This sets the initial size - the memory is allocated later
       // and the data is loaded later
    {
-      dataptr=curptr=NULL;
+      dataptr=curptr=endptr=NULL;
+      stream=NULL;
       size=mysize;
    }
    unsigned long GetSize() {  return size;   }
 
+   void SetStreamed();
+      // Marks the container to be decompressed incrementally
+   char IsStreamed() {  return stream!=NULL; }
+      // Returns 1, if the container is streamed. The data returned by
+      // 'GetDataPtr' is then only valid until the next access.
+
    void AllocateContMem(unsigned long mincontsize);
       // Allocates the memory - but only if the size is larger than 'mincontsize'
       // This will allows us to allocate memory starting with the largest
@@ -74,31 +99,55 @@ public:
       // Decompresses the container data and stores
       // it in the data buffer
    void UncompressSmallContainer(SmallBlockUncompressor *uncompressor);
-   void UncompressLargeContainer(Input *input);
+   void UncompressLargeContainer(Input *input,unsigned long compressedsize=0);
+      // For streamed containers, only the first window is decompressed
+      // If 'compressedsize' is known, the compressed data is not decompressed
+      // in order to find the next container
 
    unsigned char *GetDataPtr()   {  return curptr; }
 
+   unsigned long GetPos()  {  return curptr-dataptr;  }
+      // Returns the current position in a container that is not streamed
+   void SetPos(unsigned long pos)
+      // Moves to position 'pos' of a container that is not streamed
+   {
+      if(pos>size)
+         ExitCorruptFile();
+      curptr=dataptr+pos;
+   }
+
    unsigned char *GetDataPtr(int len)
    {
+      if(curptr+len>endptr)
+      {
+         Refill(len);
+         if(curptr+len>endptr)
+            ExitCorruptFile();
+      }
       curptr+=len;
       return curptr-len;
    }
 
    // Some auxiliary functions for reading integers and strings
+   // An integer has at most 4 bytes
    unsigned long LoadUInt32()
    {
+      if(curptr+4>endptr)
+         Refill(4);
       return ::LoadUInt32(curptr);
    }
 
    unsigned long LoadSInt32(char *isneg)
    {
+      if(curptr+4>endptr)
+         Refill(4);
       return ::LoadSInt32(curptr,isneg);
    }
 
    long LoadSInt32()
    {
       char isneg;
-      long val=::LoadSInt32(curptr,&isneg);
+      long val=LoadSInt32(&isneg);
       if(isneg)
          return 0L-val;
       else
@@ -107,15 +156,15 @@ public:
 
    char LoadChar()
    {
+      if(curptr>=endptr)
+         Refill(1);
       return ::LoadChar(curptr);
    }
 
    unsigned char *LoadString(unsigned *len)
    {
       *len=LoadUInt32();
-
-      curptr+=*len;
-      return curptr-*len;
+      return GetDataPtr(*len);
    }
 };
 
@@ -130,6 +179,8 @@ class UncompressContainerBlock
    VPathExpr            *pathexpr;  // The path expression
    UncompressContainer  *contarray; // The array of containers
    unsigned long        contnum;    // The number of containers in the array
+   char                 isskipped;  // Is 1, if the text items of the block are not needed
+                                    // Then, the large containers are not decompressed
 
    // Note: The state space for the user compressor is stored *directly*
    // after the container array space !
@@ -151,9 +202,27 @@ public:
       // Decompresses the container data and stores
       // it in the containers
    void UncompressSmallContainers(SmallBlockUncompressor *uncompressor);
-   void UncompressLargeContainers(Input *input);
+   void UncompressLargeContainers(Input *input,unsigned long *compressedsizes=NULL);
+      // If 'compressedsizes' is not NULL, it contains the compressed size
+      // of each large container
+
+   unsigned long SetStreamed(char istreeblock);
+      // Marks the large containers to be decompressed incrementally and
+      // returns their overall size. The structure container of the
+      // first block is never streamed.
+
+   void SkipLargeContainers(Input *input,unsigned long *compressedsizes);
+      // Skips the large containers in 'input' without decompressing them
+      // 'compressedsizes' contains the compressed size of each large container
+
+   unsigned long GetLargeContNum();
+      // Returns the number of large containers
+
+   void SetSkipped(char myisskipped)   {  isskipped=myisskipped;  }
+   char IsSkipped()                    {  return isskipped; }
 
    UncompressContainer  *GetContainer(unsigned idx)   {  return contarray+idx;   }
+   unsigned long        GetContNum()   {  return contnum;  }
 
    UserUncompressor *GetUserUncompressor()
    {
@@ -170,21 +239,33 @@ public:
       // Initializes the decompress container block
       // This initializes the decompressor state data
    {
-      if(pathexpr!=NULL)
+      if((pathexpr!=NULL)&&(isskipped==0))
          GetUserUncompressor()->InitUncompress(GetContainer(0),GetUserDataPtr());
    }
 
-   void UncompressText(XMLOutput *output)
+   void UncompressText(XMLEventSink *output)
       // Decompresses a text item and prints it to 'output'
    {
       GetUserUncompressor()->UncompressItem(GetContainer(0),GetUserDataPtr(),output);
    }
 
+   void CopyState(UncompressContainerBlock *src);
+      // Copies the containers and the user decompressor state of 'src'
+      // The copy shares the data of the containers with 'src'
+
+   void LoadSyncState(unsigned char * &ptr)
+      // Restores the state of the user decompressor at a sync point
+      // The containers must already be at the positions of the sync point
+   {
+      if((pathexpr!=NULL)&&(isskipped==0))
+         GetUserUncompressor()->LoadSyncState(GetContainer(0),GetUserDataPtr(),ptr);
+   }
+
    void FinishUncompress()
       // After all items have been read, this function cleans
       // up the user decompressor states
    {
-      if(pathexpr!=NULL)
+      if((pathexpr!=NULL)&&(isskipped==0))
          pathexpr->GetUserUncompressor()->FinishUncompress(GetContainer(0),GetUserDataPtr());
    }
 };
@@ -196,9 +277,13 @@ class UncompressContainerMan
    UncompressContainerBlock   *blockarray;   // The array of container blocks
    unsigned long              blocknum;      // The number of container blocks
 
+   char                       isstreaming;   // Is 1 in the low-memory mode
+
 public:
-   void Load(SmallBlockUncompressor *uncompress);
+   char Load(SmallBlockUncompressor *uncompress);
       // Loads the structural information from the small block decompressor
+      // Returns 0, if there are no container blocks - this marks the
+      // block index behind the last block (see BlockIndex.hpp)
 
    void AllocateContMem();
       // Allocates the memory for the container sequentially.
@@ -212,12 +297,39 @@ public:
 
       // Decompresses the container data and stores
       // it in the containers
-   void UncompressLargeContainers(Input *input);
+   void UncompressLargeContainers(Input *input,unsigned long *compressedsizes=NULL);
    void UncompressSmallContainers(SmallBlockUncompressor *uncompressor);
 
+   void StartStreaming(char *filename);
+      // Starts the low-memory mode for the decompression of 'filename'
+      // If 'filename' is NULL, the compressed data of the streamed containers
+      // is kept in memory
+   void FinishStreaming();
+      // Finishes the low-memory mode
+   char IsStreaming()   {  return isstreaming;  }
+
+   unsigned long SetStreamed();
+      // Marks the large containers of the current block to be decompressed
+      // incrementally and returns their overall size
+
+   unsigned long GetLargeContNum();
+      // Returns the number of large containers
+
    void Init();   // Initializes the state data for all container blocks
 
+   void LoadSyncState(unsigned char *state,unsigned long statelen);
+      // Moves the containers to the positions of a sync point and restores the
+      // states of the user decompressors (see CompressContainerMan::StoreSyncState)
+      // This must be called after 'Init'
+
+   void CopyState(UncompressContainerMan *src);
+      // Makes this container manager a copy of 'src' with its own container
+      // positions and user decompressor states, but the same container data.
+      // This allows several threads to read the containers of the current block
+      // (see ParDecode.hpp). The copy is only valid until the end of the block.
+
    UncompressContainerBlock  *GetContBlock(unsigned idx)   {  return blockarray+idx;   }
+   unsigned long GetBlockNum()   {  return blocknum;  }
 
    void FinishUncompress();
       // Finishes the decompression
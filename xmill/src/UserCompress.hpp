@@ -46,7 +46,7 @@ class CompressContainer;
 
 
 
-#include "XMLOutput.hpp"
+#include "XMLEventSink.hpp"
 
 class UserUncompressor;
 class Input;
@@ -169,6 +169,11 @@ public:
    virtual void PrintCompressInfo(char *dataptr,unsigned long *overalluncomprsize,unsigned long *overallcomprsize) {}
       // Prints statistical information about how well the compressor compressed
       // the data
+
+   virtual void StoreSyncState(char *dataptr,MemStreamer *mem)  {}
+      // Stores the state that the decompressor needs in order to continue
+      // with the next text item at a sync point (see option '-y').
+      // Only compressors that depend on previous items have such a state.
 };
 
 
@@ -200,12 +205,17 @@ public:
    virtual void InitUncompress(UncompressContainer *cont,char *dataptr)    {}
       // Initializes the decompressor
 
-   virtual void UncompressItem(UncompressContainer *cont,char *dataptr,XMLOutput *output)=0;
+   virtual void UncompressItem(UncompressContainer *cont,char *dataptr,XMLEventSink *output)=0;
       // Does the actual decompression of a single text item
       // and prints the text to 'output'
 
    virtual void FinishUncompress(UncompressContainer *cont,char *dataptr)  {}
       // Finished the decompression
+
+   virtual void LoadSyncState(UncompressContainer *cont,char *dataptr,unsigned char * &ptr)  {}
+      // Restores the state stored with 'StoreSyncState' from 'ptr' after
+      // the decompressor has been initialized. The containers are already
+      // at the positions of the sync point.
 };
 
 
@@ -45,6 +45,8 @@ History:
 
 
 #include "Load.hpp"
+#include "File.hpp"
+#include "Output.hpp"
 
 // The memory used for allocating the path expression and FSM information
 extern MemStreamer mainmem;
@@ -112,10 +114,14 @@ inline void VPathExpr::HandlePathExprOption(char * &str,char *endptr)
    }
 
    // Otherwise, it must be a compressor:
+   // Both instances are created from the same string, i.e. we must
+   // start over for the decompressor
 
+   char *compressorstr=str;
 
    usercompressor=compressman.CreateCompressorInstance(str,endptr);
 
+   str=compressorstr;
    useruncompressor=compressman.CreateUncompressorInstance(str,endptr);
 
 }
@@ -376,31 +382,25 @@ inline FSM *VPathExpr::ParseXPath(char * &str,char *endptr,char ignore_pounds)
    return fsm;
 }
 
-void VPathExpr::CreateFromString(char * &str,char *endptr)
-   // This function initializes the object with the path expression
-   // found between 'str' and 'endptr.
-   // It creates the forward and backward FSM and parses the
-   // user compressor string
+void VPathExpr::ParsePath(char * &str,char *endptr)
+   // Parses the path at 'str' and creates the non-deterministic forward FSM
+   // in the temporary memory. The labels of the path are inserted into the
+   // label dictionary. Afterwards, 'str' points to the character after the path
 {
 #ifdef FULL_PATHEXPR
    VRegExpr       *regexpr;
 #endif
-   FSM            *tmpforwardfsm;
-   char           *savestr=str;
 
    regexprstr=str;
    regexprendptr=endptr;   // The end ptr will be set later
 
-   // We start a new block of temporary data
-   tmpmem.StartNewMemBlock();
-
    // The forward FSM is only generated in temporary memory
    fsmmem=&tmpmem;
    fsmtmpmem=&tmpmem;
 
    // For now, it is required that paths start with '/'
    if(*str=='/')
-      tmpforwardfsm=ParseXPath(str,endptr,0);
+      nondetfsm=ParseXPath(str,endptr,0);
    else
    {
 #ifdef FULL_PATHEXPR
@@ -411,14 +411,27 @@ void VPathExpr::CreateFromString(char * &str,char *endptr)
 
       // Let's convert the regular expression into an automaton
       // Let's create an FSM
-      tmpforwardfsm=regexpr->CreateNonDetFSM();
+      nondetfsm=regexpr->CreateNonDetFSM();
 #else
       PathParseError("Character '/' expected",str);
 #endif
    }
+}
+
+void VPathExpr::ComputeFSMs()
+   // Computes the minimal reverse FSM (and the forward FSM) from the
+   // non-deterministic FSM created by 'ParsePath'
+{
+   FSM            *tmpforwardfsm;
+
+   // We start a new block of temporary data
+   tmpmem.StartNewMemBlock();
+
+   fsmmem=&tmpmem;
+   fsmtmpmem=&tmpmem;
 
    // Let's make the FSM deterministic
-   tmpforwardfsm=tmpforwardfsm->MakeDeterministic();
+   tmpforwardfsm=nondetfsm->MakeDeterministic();
 
    // Let's minimize
    tmpforwardfsm=tmpforwardfsm->Minimize();
@@ -449,8 +462,10 @@ void VPathExpr::CreateFromString(char * &str,char *endptr)
    reversefsm->ComputeStatesHasPoundsAhead();
 
 #ifdef USE_FORWARD_DATAGUIDE
+   char *savestr=regexprstr;
+
    if(*savestr=='/')
-      forwardfsm=ParseXPath(savestr,endptr,1);
+      forwardfsm=ParseXPath(savestr,regexprendptr,1);
    else
    {
       Error("Fatal Error in VPathExpr::CreateFromString\n");
@@ -472,6 +487,18 @@ void VPathExpr::CreateFromString(char * &str,char *endptr)
    // We remove all the temporary data
    tmpmem.RemoveLastMemBlock();
 
+   nondetfsm=NULL;
+}
+
+void VPathExpr::CreateFromString(char * &str,char *endptr)
+   // This function initializes the object with the path expression
+   // found between 'str' and 'endptr.
+   // It creates the forward and backward FSM and parses the
+   // user compressor string
+   // The FSMs are computed later by 'VPathExprMan::CreateFSMs'
+{
+   ParsePath(str,endptr);
+
 //*************************************************************************
 
    // We use the global setting as default for the white space handling
@@ -493,6 +520,28 @@ void VPathExpr::CreateFromString(char * &str,char *endptr)
    regexprendptr=str;
 }
 
+void VPathExpr::CreateProjectionFromString(char * &str,char *endptr)
+   // Initializes the object with the projection path found
+   // between 'str' and 'endptr'. Only the FSMs are created - a projection
+   // path does not have a user compressor
+{
+   tmpmem.StartNewMemBlock();
+
+   ParsePath(str,endptr);
+
+   if(str!=endptr)
+      PathParseError("Unexpected character",str);
+
+   regexprendptr=str;
+
+   ComputeFSMs();
+
+   tmpmem.RemoveLastMemBlock();
+
+   usercompressor=NULL;
+   useruncompressor=NULL;
+}
+
 void VPathExpr::InitWhitespaceHandling()
    // If the default white space handling for the path expression
    // is the global setting, then we replace that reference
@@ -538,6 +587,14 @@ void VPathExprMan::AddNewVPathExpr(char * &str,char *endptr)
    // Create the path expression
    VPathExpr *item=new(&mainmem) VPathExpr();
 
+   // The non-deterministic FSMs are kept in the temporary memory
+   // until function 'CreateFSMs' is called
+   if(hasnondetfsms==0)
+   {
+      tmpmem.StartNewMemBlock();
+      hasnondetfsms=1;
+   }
+
    item->idx=pathexprnum+1;
    pathexprnum++;
 
@@ -640,3 +697,193 @@ void VPathExprMan::Load(SmallBlockUncompressor *uncompress)
    }
 }
 
+
+//************************************************************************
+//************************************************************************
+
+// The FSM cache file contains the key, the hash value of the path expressions,
+// the number of path expressions and the path expression strings.
+// Then, the size of the FSM data and the FSMs of all path expressions follow.
+
+#ifdef USE_FORWARD_DATAGUIDE
+#define FSMCACHE_KEY 0x584D44UL
+#else
+#define FSMCACHE_KEY 0x584D43UL
+#endif
+
+unsigned long VPathExprMan::ComputeHash()
+   // Computes a hash value over all path expression strings
+{
+   unsigned long  val=pathexprnum;
+   VPathExpr      *curpathexpr=pathexprs;
+   char           *ptr;
+
+   while(curpathexpr!=NULL)
+   {
+      for(ptr=curpathexpr->regexprstr;ptr<curpathexpr->regexprendptr;ptr++)
+         val=(val*31+(unsigned char)*ptr)&0x3FFFFFFFUL;
+
+      val=(val*31+1)&0x3FFFFFFFUL;
+      curpathexpr=curpathexpr->next;
+   }
+   return val;
+}
+
+char VPathExprMan::LoadFSMCache(char *filename)
+   // Loads the FSMs of all path expressions from the cache file 'filename'
+   // The function returns 0, if the file does not exist or if it has
+   // been created for other path expressions
+{
+   CFile          file;
+   unsigned char  *buf,*ptr,*endptr;
+   unsigned long  filesize,len;
+   VPathExpr      *curpathexpr;
+
+   if(file.OpenFile(filename)==0)
+      return 0;
+
+   // The entire file is read with a single read operation
+   filesize=file.GetFileSize();
+
+   buf=(unsigned char *)malloc(filesize+4);
+   if(buf==NULL)
+      ExitNoMem();
+
+   if(file.ReadBlock((char *)buf,filesize)!=filesize)
+   {
+      file.CloseFile();
+      free(buf);
+      return 0;
+   }
+   file.CloseFile();
+
+   ptr=buf;
+   endptr=buf+filesize;
+   // We add some zeros, so that truncated integers are not read
+   // beyond the end of the buffer
+   memset(endptr,0,4);
+
+   // We check the key, the hash value and all path expressions
+   if((LoadUInt32(ptr)!=FSMCACHE_KEY)||
+      (LoadUInt32(ptr)!=ComputeHash())||
+      (LoadUInt32(ptr)!=pathexprnum))
+   {
+      free(buf);
+      return 0;
+   }
+
+   for(curpathexpr=pathexprs;curpathexpr!=NULL;curpathexpr=curpathexpr->next)
+   {
+      len=LoadUInt32(ptr);
+      if((ptr>endptr)||
+         (len!=(unsigned long)(curpathexpr->regexprendptr-curpathexpr->regexprstr))||
+         ((unsigned long)(endptr-ptr)<len)||
+         (memcmp(ptr,curpathexpr->regexprstr,len)!=0))
+      {
+         free(buf);
+         return 0;
+      }
+      ptr+=len;
+   }
+
+   // The remaining data contains the FSMs
+   len=LoadUInt32(ptr);
+   if((ptr>endptr)||(len!=(unsigned long)(endptr-ptr)))
+   {
+      free(buf);
+      return 0;
+   }
+
+   fsmmem=&mainmem;
+
+   // If the FSM data is corrupt, the FSMs are computed again
+   // from the non-deterministic FSMs and the cache file is replaced
+   for(curpathexpr=pathexprs;curpathexpr!=NULL;curpathexpr=curpathexpr->next)
+   {
+      mainmem.WordAlign();
+      curpathexpr->reversefsm=new(&mainmem) FSM();
+      if(curpathexpr->reversefsm->Load(ptr,endptr,&mainmem)==0)
+         break;
+#ifdef USE_FORWARD_DATAGUIDE
+      mainmem.WordAlign();
+      curpathexpr->forwardfsm=new(&mainmem) FSM();
+      if(curpathexpr->forwardfsm->Load(ptr,endptr,&mainmem)==0)
+         break;
+#endif
+   }
+   if((curpathexpr!=NULL)||(ptr!=endptr))
+   {
+      free(buf);
+      return 0;
+   }
+   free(buf);
+
+   for(curpathexpr=pathexprs;curpathexpr!=NULL;curpathexpr=curpathexpr->next)
+      curpathexpr->nondetfsm=NULL;
+   return 1;
+}
+
+void VPathExprMan::StoreFSMCache(char *filename)
+   // Stores the FSMs of all path expressions in the cache file 'filename'
+{
+   MemStreamer    mem,fsmdata;
+   MemStreamBlock *block;
+   Output         output;
+   VPathExpr      *curpathexpr;
+
+   mem.StoreUInt32(FSMCACHE_KEY);
+   mem.StoreUInt32(ComputeHash());
+   mem.StoreUInt32(pathexprnum);
+
+   for(curpathexpr=pathexprs;curpathexpr!=NULL;curpathexpr=curpathexpr->next)
+   {
+      mem.StoreUInt32(curpathexpr->regexprendptr-curpathexpr->regexprstr);
+      mem.StoreData(curpathexpr->regexprstr,curpathexpr->regexprendptr-curpathexpr->regexprstr);
+
+      curpathexpr->reversefsm->Store(&fsmdata);
+#ifdef USE_FORWARD_DATAGUIDE
+      curpathexpr->forwardfsm->Store(&fsmdata);
+#endif
+   }
+   mem.StoreUInt32(fsmdata.GetSize());
+
+   if(output.CreateFile(filename)==0)
+   {
+      Error("Could not create FSM cache file '");
+      ErrorCont(filename);
+      ErrorCont("'!");
+      PrintErrorMsg();
+      return;
+   }
+
+   for(block=mem.GetFirstBlock();block!=NULL;block=block->next)
+      output.StoreData(block->data,block->cursize);
+   for(block=fsmdata.GetFirstBlock();block!=NULL;block=block->next)
+      output.StoreData(block->data,block->cursize);
+
+   output.CloseFile();
+}
+
+void VPathExprMan::CreateFSMs(char *cachefilename)
+   // Computes the FSMs of all path expressions
+{
+   VPathExpr *curpathexpr;
+
+   if(hasnondetfsms==0)
+      return;
+
+   if((cachefilename==NULL)||(LoadFSMCache(cachefilename)==0))
+   {
+      for(curpathexpr=pathexprs;curpathexpr!=NULL;curpathexpr=curpathexpr->next)
+      {
+         if(curpathexpr->nondetfsm!=NULL)
+            curpathexpr->ComputeFSMs();
+      }
+      if(cachefilename!=NULL)
+         StoreFSMCache(cachefilename);
+   }
+
+   // The non-deterministic FSMs are not needed anymore
+   tmpmem.RemoveLastMemBlock();
+   hasnondetfsms=0;
+}
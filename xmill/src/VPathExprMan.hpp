@@ -56,6 +56,9 @@ class VPathExpr
 #endif
    FSM            *reversefsm;   // The reverse FSM
 
+   FSM            *nondetfsm;    // The non-deterministic forward FSM
+                                 // This is only kept until the FSMs are computed
+
 
    // We also keep the original path expression string
    char           *regexprstr,*regexprendptr,   // The entire string
@@ -101,6 +104,13 @@ class VPathExpr
       // by the global default value
       // This function is called after the parsing
 
+   void ParsePath(char * &str,char *endptr);
+      // Parses the path at 'str' and creates the non-deterministic forward FSM
+
+   void ComputeFSMs();
+      // Computes the minimal reverse FSM (and the forward FSM) from the
+      // non-deterministic forward FSM
+
 public:
 
    void *operator new(size_t size, MemStreamer *mem)  {  return mem->GetByteBlock(size); }
@@ -117,6 +127,7 @@ public:
       forwardfsm=NULL;
 #endif
       reversefsm=NULL;
+      nondetfsm=NULL;
       next=NULL;
 
    }
@@ -124,8 +135,12 @@ public:
    void CreateFromString(char * &str,char *endptr);
       // This function initializes the object with the path expression
       // found between 'str' and 'endptr.
-      // It creates the forward and backward FSM and parses the
-      // user compressor string
+      // It parses the path and the user compressor string. The forward
+      // and backward FSM are computed later by 'VPathExprMan::CreateFSMs'
+
+   void CreateProjectionFromString(char * &str,char *endptr);
+      // Initializes the object with the projection path found
+      // between 'str' and 'endptr'. Only the FSMs are created.
 
    void PrintRegExpr(); // Prints the container path expression
 
@@ -203,12 +218,26 @@ class VPathExprMan
    VPathExpr      *pathexprs;       // The list of paths
    VPathExpr      *lastpathexpr;    // The pointer to the last path
 
+   char           hasnondetfsms;    // Is 1, if some paths still need their FSMs
+
+   unsigned long ComputeHash();
+      // Computes a hash value over all path expression strings
+
+   char LoadFSMCache(char *filename);
+      // Loads the FSMs of all path expressions from the cache file 'filename'
+      // The function returns 0, if the file does not exist or if it has
+      // been created for other path expressions
+
+   void StoreFSMCache(char *filename);
+      // Stores the FSMs of all path expressions in the cache file 'filename'
+
 public:
 
    VPathExprMan()
    {
       pathexprnum=0;
       pathexprs=lastpathexpr=NULL;
+      hasnondetfsms=0;
    }
 
    VPathExpr *GetPathExpr(unsigned long idx)
@@ -223,6 +252,13 @@ public:
    void AddNewVPathExpr(char * &str,char *endptr);
       // Adds a new path expression to the set of paths
 
+   void CreateFSMs(char *cachefilename=NULL);
+      // Computes the FSMs of all path expressions. This is called
+      // after all path expressions have been added.
+      // If 'cachefilename' is not NULL, then the FSMs are loaded from the cache
+      // file, if it has been created for the same path expressions.
+      // Otherwise, the FSMs are computed and stored in the cache file.
+
    void Store(MemStreamer *memstream);
       // Stores all path expressions
 
@@ -0,0 +1,83 @@
+/*
+This product contains certain software code or other information
+("AT&T Software") proprietary to AT&T Corp. ("AT&T").  The AT&T
+Software is provided to you "AS IS".  YOU ASSUME TOTAL RESPONSIBILITY
+AND RISK FOR USE OF THE AT&T SOFTWARE.  AT&T DOES NOT MAKE, AND
+EXPRESSLY DISCLAIMS, ANY EXPRESS OR IMPLIED WARRANTIES OF ANY KIND
+WHATSOEVER, INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+MERCHANTABILITY OR FITNESS FOR A PARTICULAR PURPOSE, WARRANTIES OF
+TITLE OR NON-INFRINGEMENT OF ANY INTELLECTUAL PROPERTY RIGHTS, ANY
+WARRANTIES ARISING BY USAGE OF TRADE, COURSE OF DEALING OR COURSE OF
+PERFORMANCE, OR ANY WARRANTY THAT THE AT&T SOFTWARE IS "ERROR FREE" OR
+WILL MEET YOUR REQUIREMENTS.
+
+Unless you accept a license to use the AT&T Software, you shall not
+reverse compile, disassemble or otherwise reverse engineer this
+product to ascertain the source code for any AT&T Software.
+
+(c) AT&T Corp. All rights reserved.  AT&T is a registered trademark of AT&T Corp.
+*/
+
+
+
+//**************************************************************************
+//**************************************************************************
+
+// This module contains the interface for receiving the decompressed
+// document as a sequence of events - similar to SAX.
+// The decompressor ('DecodeTreeBlock', the user decompressors and the
+// selective decompressors) produces its output through this interface.
+// 'XMLOutput' implements it by printing the XML text. An application
+// can implement it to load the document directly from the compressed
+// file without printing and parsing the XML text (see MemCompress.hpp).
+//
+// The strings passed to the functions are not terminated with '\0'.
+// They often point directly into the memory of the containers and
+// are only valid during the call.
+//
+// The text is passed as it appears in the XML document, i.e. with the
+// entity and character references ('&amp;', '&lt;', '&#233;', ...) of the
+// text and the attribute values. This is what 'XMLOutput' needs. Sinks that
+// need the actual characters can copy the text and decode it with
+// 'UnescapeXMLText'.
+
+#ifndef XMLEVENTSINK_HPP
+#define XMLEVENTSINK_HPP
+
+class XMLEventSink
+{
+public:
+   virtual void startElement(char *str,int len)=0;
+      // Starts the element with label 'str'
+   virtual void endElement(char *str,int len)=0;
+      // Ends the element with label 'str'
+   virtual void endEmptyElement()=0;
+      // Ends the current element, which has no content
+      // This replaces 'endElement'
+
+   virtual void startAttribute(char *str,int len)=0;
+      // Starts the attribute with name 'str' of the current element
+      // The value follows with 'characters'
+   virtual void endAttribute(char *str=NULL,int len=0)=0;
+      // Ends the current attribute
+
+   virtual void characters(char *str,int len)=0;
+      // Passes a piece of text of an element or of an attribute value
+      // The text of an element or attribute can consist of several pieces
+   virtual void blockCharacters(char *str,int len)  {  characters(str,len);  }
+      // Same as 'characters', but the text stays valid until the end of the
+      // current block, i.e. it can be kept without copying it
+   virtual void whitespaces(char *str,int len)=0;
+      // Passes white spaces between elements
+   virtual void attribWhitespaces(char *str,int len)=0;
+      // Passes white spaces between attributes
+   virtual void special(char *str,int len)=0;
+      // Passes a comment, processing instruction, CDATA section or
+      // DOCTYPE section including its markup (e.g. '<!--' and '-->')
+};
+
+int UnescapeXMLText(char *str,int len);
+   // Replaces the entity and character references in the text 'str'
+   // and returns the new length (see XMLOutput.cpp)
+
+#endif
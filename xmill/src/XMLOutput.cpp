@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <string.h>
 #include "XMLOutput.hpp"
 
 #ifdef SET_OUTPUT_STATIC
@@ -33,9 +34,143 @@ void OUTPUT_STATIC XMLOutput::characters(char *str,int len)
 {
 }
 
+void OUTPUT_STATIC XMLOutput::blockCharacters(char *str,int len)
+{
+}
+
 void OUTPUT_STATIC XMLOutput::whitespaces(char *str,int len)
 {
 }
 
+void OUTPUT_STATIC XMLOutput::endEmptyElement()
+{
+}
+
+void OUTPUT_STATIC XMLOutput::attribWhitespaces(char *str,int len)
+{
+}
+
+void OUTPUT_STATIC XMLOutput::special(char *str,int len)
+{
+}
+
 #endif
 
+
+//**************************************************************************
+
+inline int IsXMLEntity(char *str,int len,char *name)
+   // Checks whether the 'len' characters at 'str' are the entity name 'name'
+{
+   return (strlen(name)==(size_t)len)&&(memcmp(str,name,len)==0);
+}
+
+int UnescapeXMLText(char *str,int len)
+   // The decompressor reproduces the text of the original document, i.e.
+   // the text contains the escapes of the XML document ('&amp;', '&#38;', ...).
+   // This function replaces the references in the text 'str' of length 'len'
+   // by the characters they stand for. Character references are stored in UTF-8.
+   // Since the replacement is never longer than the reference, the text
+   // is changed in place. Unknown references are kept unchanged.
+   // The function returns the new length of the text.
+{
+   char           *srcptr=str,*destptr=str,*endptr=str+len,*nameptr,*ptr;
+   unsigned long  val;
+   int            namelen,digit;
+
+   while(srcptr<endptr)
+   {
+      if(*srcptr!='&')
+      {
+         *(destptr++)=*(srcptr++);
+         continue;
+      }
+
+      // We look for the ';' that ends the reference
+      nameptr=srcptr+1;
+      ptr=nameptr;
+      while((ptr<endptr)&&(*ptr!=';')&&(ptr-nameptr<10))
+         ptr++;
+
+      if((ptr==endptr)||(*ptr!=';'))
+      {
+         *(destptr++)=*(srcptr++);
+         continue;
+      }
+      namelen=ptr-nameptr;
+
+      if(IsXMLEntity(nameptr,namelen,"amp"))
+         *(destptr++)='&';
+      else if(IsXMLEntity(nameptr,namelen,"lt"))
+         *(destptr++)='<';
+      else if(IsXMLEntity(nameptr,namelen,"gt"))
+         *(destptr++)='>';
+      else if(IsXMLEntity(nameptr,namelen,"quot"))
+         *(destptr++)='"';
+      else if(IsXMLEntity(nameptr,namelen,"apos"))
+         *(destptr++)='\'';
+      else if((namelen>=2)&&(*nameptr=='#'))
+         // A character reference '&#ddd;' or '&#xhhh;'
+      {
+         val=0;
+         if((nameptr[1]=='x')&&(namelen>=3))
+         {
+            for(ptr=nameptr+2;ptr<nameptr+namelen;ptr++)
+            {
+               if((*ptr>='0')&&(*ptr<='9'))
+                  digit=*ptr-'0';
+               else if((*ptr>='a')&&(*ptr<='f'))
+                  digit=*ptr-'a'+10;
+               else if((*ptr>='A')&&(*ptr<='F'))
+                  digit=*ptr-'A'+10;
+               else
+                  break;
+               val=val*16+digit;
+            }
+         }
+         else
+         {
+            for(ptr=nameptr+1;ptr<nameptr+namelen;ptr++)
+            {
+               if((*ptr<'0')||(*ptr>'9'))
+                  break;
+               val=val*10+(*ptr-'0');
+            }
+         }
+         if((ptr<nameptr+namelen)||(val==0)||(val>0x10FFFF))
+            // The reference is not valid
+         {
+            *(destptr++)=*(srcptr++);
+            continue;
+         }
+
+         if(val<0x80)
+            *(destptr++)=(char)val;
+         else if(val<0x800)
+         {
+            *(destptr++)=(char)(0xC0|(val>>6));
+            *(destptr++)=(char)(0x80|(val&0x3F));
+         }
+         else if(val<0x10000)
+         {
+            *(destptr++)=(char)(0xE0|(val>>12));
+            *(destptr++)=(char)(0x80|((val>>6)&0x3F));
+            *(destptr++)=(char)(0x80|(val&0x3F));
+         }
+         else
+         {
+            *(destptr++)=(char)(0xF0|(val>>18));
+            *(destptr++)=(char)(0x80|((val>>12)&0x3F));
+            *(destptr++)=(char)(0x80|((val>>6)&0x3F));
+            *(destptr++)=(char)(0x80|(val&0x3F));
+         }
+      }
+      else
+      {
+         *(destptr++)=*(srcptr++);
+         continue;
+      }
+      srcptr=nameptr+namelen+1;
+   }
+   return destptr-str;
+}
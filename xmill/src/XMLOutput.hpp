@@ -17,6 +17,7 @@
 #define XMLOUTPUT_HPP
 
 #include "Output.hpp"
+#include "XMLEventSink.hpp"
 /*
 #define XMLOUTPUT_DEFAULT              0
 #define XMLOUTPUT_LABELSTARTED         1
@@ -37,10 +38,20 @@
 #define XMLINTENT_SPACES      3
 #define XMLINTENT_TABS        4
 
-class XMLOutput : public Output
+// The indentation of a new line is copied from a prepared string
+// with the new line and XMLOUTPUT_MAXINDENT spaces or tabs.
+// Only deeper lines are indented character by character.
+#define XMLOUTPUT_MAXINDENT   256
+
+class XMLOutput : public Output, public XMLEventSink
+   // Prints the decompressed document as XML text
 {
    OUTPUT_STATIC int curcol,coldelta;
 
+   OUTPUT_STATIC char indentstr[XMLOUTPUT_MAXINDENT+2];  // The new line and the indentation
+   OUTPUT_STATIC char indentisdos;  // The newline convention of 'indentstr' - or 2 if
+                                    // the string is not initialized
+
    OUTPUT_STATIC struct ABC {
    unsigned char  status:3;
    unsigned char  content:2;
@@ -50,26 +61,60 @@ class XMLOutput : public Output
    unsigned char  attribwhitespace:1;
    } x;
 
-   OUTPUT_STATIC void GotoNextLine(char moveright)
+   OUTPUT_STATIC void InitIndentation()
+      // Prepares the string with the new line and the indentation
+      // The newline convention can change after 'Init'
+   {
+      char *ptr=indentstr;
+
+      if(usedosnewline)
+         *(ptr++)='\r';
+      *(ptr++)='\n';
+
+      mymemset(ptr,(x.intentation==XMLINTENT_TABS) ? '\t' : ' ',XMLOUTPUT_MAXINDENT);
+      indentisdos=usedosnewline;
+   }
+
+   OUTPUT_STATIC char *GotoNextLine(char moveright,int len,char closelabel=0)
+      // Starts a new line and returns the space for the next 'len' bytes
+      // The new line and the indentation are copied at once
+      // If 'closelabel' is 1, the current start tag is closed with '>' first
    {
+      char  *ptr;
+      int   indentlen;
+
       switch(x.intentation)
       {
       case XMLINTENT_SPACES:
       case XMLINTENT_TABS:
       {
-         StoreNewline();
-
          if(moveright==0)
             curcol-=coldelta;
 
-         if(x.intentation==XMLINTENT_SPACES)
-            mymemset(GetDataPtr(curcol),' ',curcol);
+         if(indentisdos!=usedosnewline)
+            InitIndentation();
+
+         if(curcol<=XMLOUTPUT_MAXINDENT)
+         {
+            indentlen=curcol+(usedosnewline ? 2 : 1);
+            ptr=GetDataPtr(closelabel+indentlen+len);
+            if(closelabel)
+               *(ptr++)='>';
+            mymemcpy(ptr,indentstr,indentlen);
+            ptr+=indentlen;
+         }
          else
-            mymemset(GetDataPtr(curcol),'\t',curcol);
+         {
+            if(closelabel)
+               StoreChar('>');
+            StoreNewline();
+            mymemset(GetDataPtr(curcol),indentstr[usedosnewline ? 2 : 1],curcol);
+            ptr=GetDataPtr(len);
+         }
 
          if(moveright)
             curcol+=coldelta;
-         break;
+         return ptr;
       }
 /*
       case XMLINTENT_WRAP:
@@ -77,6 +122,10 @@ class XMLOutput : public Output
             StoreNewline();
 */
       }
+      ptr=GetDataPtr(closelabel+len);
+      if(closelabel)
+         *(ptr++)='>';
+      return ptr;
    }
 
 public:
@@ -91,6 +140,8 @@ public:
       x.isinattrib=0;
 
       x.valuespacing=myvaluespacing;
+
+      indentisdos=2;
    }
 
    XMLOutput()
@@ -98,17 +149,51 @@ public:
       Init(XMLINTENT_NONE);
    }
 
+   // A block can be decoded as several ranges of records in parallel (see ParDecode.hpp)
+   // Each range starts in front of a record, i.e. behind a start tag, an end tag
+   // or some text - and the output of the range always starts with a start tag.
+
+   void OUTPUT_STATIC InitRange(XMLOutput *docoutput,unsigned long depth)
+      // Prepares the output of a range that starts at depth 'depth'
+      // of the document printed by 'docoutput'
+   {
+      Init(docoutput->x.intentation,docoutput->x.valuespacing,docoutput->coldelta);
+      curcol=depth*coldelta;
+      x.status=XMLOUTPUT_AFTERENDLABEL;
+   }
+
+   void OUTPUT_STATIC FinishRange()
+      // Finishes the output of a range - a start tag that is still
+      // open is closed, since the next range doesn't close it
+   {
+      if(x.status==XMLOUTPUT_OPENLABEL)
+      {
+         StoreChar('>');
+         x.status=XMLOUTPUT_AFTERENDLABEL;
+      }
+   }
+
+   void OUTPUT_STATIC ContinueRange(XMLOutput *rangeoutput)
+      // Continues the document behind the last range printed by 'rangeoutput'
+   {
+      curcol=rangeoutput->curcol;
+      x.status=rangeoutput->x.status;
+      x.attribwhitespace=rangeoutput->x.attribwhitespace;
+   }
+
 //***********************************************************************
 
 #ifndef XDEMILL_NOOUTPUT
 
    void OUTPUT_STATIC startElement(char *str,int len)
    {
+      char *ptr=NULL;
+
+      // The space for the start tag is reserved together with the new line
       switch(x.status)
       {
       case XMLOUTPUT_OPENLABEL:
-         StoreChar('>');
-         GotoNextLine(1);
+         ptr=GotoNextLine(1,len+1,1);
          break;
 
       case XMLOUTPUT_OPENATTRIB:
@@ -117,24 +202,23 @@ public:
 
       case XMLOUTPUT_AFTERENDLABEL:
       case XMLOUTPUT_AFTERDATA:
-         GotoNextLine(1);
+         ptr=GotoNextLine(1,len+1);
          break;
 
-      case XMLOUTPUT_INIT:
+      default: // XMLOUTPUT_INIT
          curcol+=coldelta;
-         break;
+         ptr=GetDataPtr(len+1);
       }
-      StoreChar('<');
+      *(ptr++)='<';
+      mymemcpy(ptr,str,len);
 
       x.status=XMLOUTPUT_OPENLABEL;
-      StoreData(str,len);
-
       x.attribwhitespace=0;
    }
 
    void OUTPUT_STATIC endElement(char *str,int len)
    {
-      char *ptr;
+      char *ptr=NULL;
       switch(x.status)
       {
       case XMLOUTPUT_OPENLABEL:
@@ -150,11 +234,12 @@ public:
          return;
 
       case XMLOUTPUT_AFTERENDLABEL:
-         GotoNextLine(0);
+         ptr=GotoNextLine(0,len+3);
          break;
 
       case XMLOUTPUT_AFTERDATA:
          curcol-=coldelta;
+         ptr=GetDataPtr(len+3);
          break;
 
       default:
@@ -162,8 +247,6 @@ public:
          Exit();
       }
 
-      ptr=GetDataPtr(len+3);
-
       *(ptr++)='<';
       *(ptr++)='/';
       mymemcpy(ptr,str,len);
@@ -252,6 +335,26 @@ public:
       x.status=XMLOUTPUT_AFTERDATA;
    }
 
+   void OUTPUT_STATIC blockCharacters(char *str,int len)
+      // The text is only referenced by the output
+   {
+      switch(x.status)
+      {
+      case XMLOUTPUT_OPENATTRIB:
+         StoreDataRef(str,len);
+         return;
+
+      case XMLOUTPUT_OPENLABEL:
+         StoreChar('>');
+
+      case XMLOUTPUT_AFTERDATA:
+      case XMLOUTPUT_AFTERENDLABEL:
+      case XMLOUTPUT_INIT:
+         StoreDataRef(str,len);
+      }
+      x.status=XMLOUTPUT_AFTERDATA;
+   }
+
    void OUTPUT_STATIC whitespaces(char *str,int len)
    {
       characters(str,len);
@@ -264,6 +367,11 @@ public:
       x.attribwhitespace=1;
    }
 
+   void OUTPUT_STATIC special(char *str,int len)
+   {
+      characters(str,len);
+   }
+
 #else
    void OUTPUT_STATIC startElement(char *str,int len);// {}
    void OUTPUT_STATIC endElement(char *str,int len);// {}
@@ -271,8 +379,10 @@ public:
    void OUTPUT_STATIC startAttribute(char *str,int len);// {}
    void OUTPUT_STATIC endAttribute(char *str=NULL,int len=0);// {}
    void OUTPUT_STATIC characters(char *str,int len);// {}
+   void OUTPUT_STATIC blockCharacters(char *str,int len);// {}
    void OUTPUT_STATIC whitespaces(char *str,int len);// {}
    void OUTPUT_STATIC attribWhitespaces(char *str,int len); // {}
+   void OUTPUT_STATIC special(char *str,int len); // {}
 #endif
 
 };
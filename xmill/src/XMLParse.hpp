@@ -37,6 +37,7 @@ History:
 #include "SAXClient.hpp"
 
 extern unsigned long memory_cutoff;
+extern unsigned long syncpointmemory;
    // The memory cutoff is the maximum amount of memory that should be used
    // If the current memory allocation exceed the limit, then the parser stops
    // and the current data is written to the compressed output file
@@ -546,9 +547,10 @@ public:
             ParseLabel();
          }
       }
-      while(allocatedmemory<memory_cutoff);
+      while((allocatedmemory-syncpointmemory<memory_cutoff)&&(flushblock==0));
          // We perform the parsing as long as the allocated memory is smaller than the
-         // memory cut off
+         // memory cut off - or until the block should be finished (options '-F' and '-N')
+         // The memory of the sync points (option '-y') is kept for the entire file
 
       return 0;
    }
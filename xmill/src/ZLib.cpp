@@ -382,38 +382,57 @@ void Compressor::FinishCompress(unsigned long *uncompressedsize,unsigned long *c
 
 
 
-char Uncompressor::Uncompress(Input *input,unsigned char *dataptr,unsigned long *len)
-   // Decompresses the data from 'input' and stores
-   // the result in 'dataptr'. It decompresses at most *len
-   // bytes. Afterwards, '*len' is set to the actual number
-   // of bytes uncompressed.
-   // The function returns 1, if output buffer is full and
-   // there is more data to read. Otherwise, the function returns 0.
+Uncompressor::~Uncompressor()
+   // The deconstructor
 {
-   // We haven't initialized the object yet, we do that now
-   if(isinitialized==0)
+   if(isinitialized)
+      // We release the internal memory of the zlib state
    {
 #ifdef USE_BZIP
-      state.bzalloc=zalloc;
-      state.bzfree=zfree;
+      bzDecompressEnd(&state);
 #else
-      state.zalloc=zalloc;
-      state.zfree=zfree;
+      inflateEnd(&state);
 #endif
+      isinitialized=0;
+   }
+}
 
+void Uncompressor::Init()
+   // Initializes the zlib state
+{
 #ifdef USE_BZIP
-      if(bzDecompressInit(&state,0,0)!=BZ_OK)
+   state.bzalloc=zalloc;
+   state.bzfree=zfree;
 #else
-      if(inflateInit(&state)!=Z_OK)
+   state.zalloc=zalloc;
+   state.zfree=zfree;
 #endif
-      {
-         Error("Error while compressing container!");
-         Exit();
-      }
 
-      isinitialized=1;
+#ifdef USE_BZIP
+   if(bzDecompressInit(&state,0,0)!=BZ_OK)
+#else
+   if(inflateInit(&state)!=Z_OK)
+#endif
+   {
+      Error("Error while compressing container!");
+      Exit();
    }
 
+   isinitialized=1;
+}
+
+char Uncompressor::Uncompress(Input *input,unsigned char *dataptr,unsigned long *len)
+   // Decompresses the data from 'input' and stores
+   // the result in 'dataptr'. It decompresses at most *len
+   // bytes. Afterwards, '*len' is set to the actual number
+   // of bytes uncompressed.
+   // The function returns 1, if output buffer is full and
+   // there is more data to read. Otherwise, the function returns 0.
+{
+   // We haven't initialized the object yet, we do that now
+   if(isinitialized==0)
+      Init();
+
    int   save_in;
 
 #ifdef USE_BZIP
@@ -501,4 +520,79 @@ char Uncompressor::Uncompress(Input *input,unsigned char *dataptr,unsigned long
    while(1);
 }
 
+char Uncompressor::UncompressData(unsigned char **srcptr,unsigned long *srclen,unsigned char *dataptr,unsigned long *len)
+   // Decompresses the next piece of the data at '*srcptr' with
+   // length '*srclen' and stores the result in 'dataptr'.
+   // It decompresses at most *len bytes. Afterwards, '*len' is set to
+   // the number of bytes decompressed by this call.
+   // The function returns 0, if the end of the compressed data has been
+   // reached. Otherwise, it returns 1.
+{
+   if(isinitialized==0)
+      Init();
+
+#ifdef USE_BZIP
+   state.next_in=(char *)*srcptr;
+   state.next_out=(char *)dataptr;
+#else
+   state.next_in=(unsigned char *)*srcptr;
+   state.next_out=(unsigned char *)dataptr;
+#endif
+   state.avail_in=*srclen;
+   state.avail_out=*len;
+
+   char  isend=0;
+
+#ifdef USE_BZIP
+   switch(bzDecompress(&state))
+#else
+   switch(inflate(&state,Z_NO_FLUSH))
+#endif
+   {
+#ifdef USE_BZIP
+   case BZ_STREAM_END:
+#else
+   case Z_STREAM_END:
+#endif
+      isend=1;
+      break;
+
+#ifdef USE_BZIP
+   case BZ_OK:
+#else
+   case Z_OK:
+   case Z_BUF_ERROR: // No progress is possible, since there is no more input
+#endif
+      break;
+
+   default:
+      Error("Error while uncompressing container!");
+      Exit();
+   }
+
+   // We return the rest of the compressed data and the
+   // amount of decompressed data
+   *len-=state.avail_out;
+   *srcptr=(unsigned char *)state.next_in;
+   *srclen=state.avail_in;
+
+   if(isend==0)
+      return 1;
+
+   // The next compressed data starts a new stream
+#ifdef USE_BZIP
+   if(bzDecompressEnd(&state)!=BZ_OK)
+#else
+   if(inflateReset(&state)!=Z_OK)
+#endif
+   {
+      Error("Error while uncompressing container!");
+      Exit();
+   }
+#ifdef USE_BZIP
+   isinitialized=0;
+#endif
+   return 0;
+}
+
 
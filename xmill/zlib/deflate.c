@@ -87,6 +87,33 @@ local int read_buf        OF((z_streamp strm, Bytef *buf, unsigned size));
 #else
 local uInt longest_match  OF((deflate_state *s, IPos cur_match));
 #endif
+#ifdef X86_DEFLATE
+/* Unaligned loads for the x86 code */
+#ifdef _MSC_VER
+#  include <intrin.h>
+#  include <nmmintrin.h>
+#  define X86_TARGET_SSE42
+   typedef unsigned __int64 x86_u64;
+   typedef unsigned __int64 x86_u64_u;
+   typedef unsigned int     x86_u32_u;
+   typedef unsigned short   x86_u16_u;
+#else
+#  include <cpuid.h>
+#  include <nmmintrin.h>
+#  define X86_TARGET_SSE42 __attribute__((target("sse4.2")))
+   typedef unsigned long long x86_u64;
+   typedef unsigned long long x86_u64_u __attribute__((aligned(1), may_alias));
+   typedef unsigned int       x86_u32_u __attribute__((aligned(1), may_alias));
+   typedef unsigned short     x86_u16_u __attribute__((aligned(1), may_alias));
+#endif
+#define X86_LOAD64(p) (*(const x86_u64_u *)(p))
+#define X86_LOAD32(p) (*(const x86_u32_u *)(p))
+#define X86_LOAD16(p) (*(const x86_u16_u *)(p))
+
+local int  x86_has_sse42  OF((void));
+local uInt crc_hash_key   OF((const Bytef *str));
+local int  compare_258    OF((const Bytef *scan, const Bytef *match));
+#endif
 
 #ifdef DEBUG
 local  void check_match OF((deflate_state *s, IPos start, IPos match,
@@ -155,6 +182,19 @@ struct static_tree_desc_s {int dummy;}; /* for buggy compilers */
  */
 #define UPDATE_HASH(s,h,c) (h = (((h)<<s->hash_shift) ^ (c)) & s->hash_mask)
 
+/* ===========================================================================
+ * Compute the hash key of the string str and store it in ins_h.
+ * IN  assertion: see UPDATE_HASH, unless s->crc_hash is set
+ */
+#ifdef X86_DEFLATE
+#define HASH_KEY(s, str) \
+   ((s)->crc_hash ? \
+    ((s)->ins_h = crc_hash_key((s)->window + (str)) & (s)->hash_mask) : \
+    UPDATE_HASH(s, s->ins_h, s->window[(str) + (MIN_MATCH-1)]))
+#else
+#define HASH_KEY(s, str) UPDATE_HASH(s, s->ins_h, s->window[(str) + (MIN_MATCH-1)])
+#endif
+
 
 /* ===========================================================================
  * Insert string str in the dictionary and set match_head to the previous head
@@ -173,7 +213,7 @@ struct static_tree_desc_s {int dummy;}; /* for buggy compilers */
     s->head[s->ins_h] = (Pos)(str))
 #else
 #define INSERT_STRING(s, str, match_head) \
-   (UPDATE_HASH(s, s->ins_h, s->window[(str) + (MIN_MATCH-1)]), \
+   (HASH_KEY(s, str), \
     s->prev[(str) & s->w_mask] = match_head = s->head[s->ins_h], \
     s->head[s->ins_h] = (Pos)(str))
 #endif
@@ -277,6 +317,13 @@ int ZEXPORT deflateInit2_(strm, level, method, windowBits, memLevel, strategy,
         deflateEnd (strm);
         return Z_MEM_ERROR;
     }
+#ifdef X86_DEFLATE
+    s->crc_hash = x86_has_sse42();
+    /* The crc hash key looks at one byte beyond the string, which may
+     * be past the end of the input: make the result deterministic.
+     */
+    zmemzero(s->window, (unsigned)(2*s->w_size));
+#endif
     s->d_buf = overlay + s->lit_bufsize/sizeof(ush);
     s->l_buf = s->pending_buf + (1+sizeof(ush))*s->lit_bufsize;
 
@@ -722,7 +769,66 @@ local void lm_init (s)
 /* For 80x86 and 680x0, an optimized version will be provided in match.asm or
  * match.S. The code will be functionally equivalent.
  */
-#ifndef FASTEST
+#ifdef X86_DEFLATE
+/* ---------------------------------------------------------------------------
+ * Optimized version for x86: the strings are compared eight bytes at a time
+ * with unaligned loads. Since the crc hash key does not guarantee that the
+ * third bytes of the strings are equal, all bytes are compared.
+ */
+local uInt longest_match(s, cur_match)
+    deflate_state *s;
+    IPos cur_match;                             /* current match */
+{
+    unsigned chain_length = s->max_chain_length;/* max hash chain length */
+    register Bytef *scan = s->window + s->strstart; /* current string */
+    register Bytef *match;                       /* matched string */
+    register int len;                           /* length of current match */
+    int best_len = s->prev_length;              /* best match length so far */
+    int nice_match = s->nice_match;             /* stop if match long enough */
+    IPos limit = s->strstart > (IPos)MAX_DIST(s) ?
+        s->strstart - (IPos)MAX_DIST(s) : NIL;
+    Posf *prev = s->prev;
+    uInt wmask = s->w_mask;
+    register ush scan_start = X86_LOAD16(scan);
+    register ush scan_end   = X86_LOAD16(scan+best_len-1);
+
+    /* Do not waste too much time if we already have a good match: */
+    if (s->prev_length >= s->good_match) {
+        chain_length >>= 2;
+    }
+    /* Do not look for matches beyond the end of the input. This is necessary
+     * to make deflate deterministic.
+     */
+    if ((uInt)nice_match > s->lookahead) nice_match = s->lookahead;
+
+    Assert((ulg)s->strstart <= s->window_size-MIN_LOOKAHEAD, "need lookahead");
+
+    do {
+        Assert(cur_match < s->strstart, "no future");
+        match = s->window + cur_match;
+
+        /* Skip to next match if the match length cannot increase
+         * or if the match length is less than 2:
+         */
+        if (X86_LOAD16(match+best_len-1) != scan_end ||
+            X86_LOAD16(match) != scan_start) continue;
+
+        len = compare_258(scan, match);
+
+        if (len > best_len) {
+            s->match_start = cur_match;
+            best_len = len;
+            if (len >= nice_match) break;
+            scan_end = X86_LOAD16(scan+best_len-1);
+        }
+    } while ((cur_match = prev[cur_match & wmask]) > limit
+             && --chain_length != 0);
+
+    if ((uInt)best_len <= s->lookahead) return (uInt)best_len;
+    return s->lookahead;
+}
+
+#elif !defined(FASTEST)
 local uInt longest_match(s, cur_match)
     deflate_state *s;
     IPos cur_match;                             /* current match */
@@ -920,6 +1026,77 @@ local uInt longest_match(s, cur_match)
 #endif /* FASTEST */
 #endif /* ASMV */
 
+#ifdef X86_DEFLATE
+/* ===========================================================================
+ * Check at run time whether the processor supports SSE4.2
+ */
+local int x86_has_sse42()
+{
+    static int has_sse42 = -1;
+
+    if (has_sse42 < 0) {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 1);
+        has_sse42 = (info[2] >> 20) & 1;
+#else
+        unsigned int eax, ebx, ecx, edx;
+        has_sse42 = __get_cpuid(1, &eax, &ebx, &ecx, &edx) ?
+                    (int)((ecx >> 20) & 1) : 0;
+#endif
+    }
+    return has_sse42;
+}
+
+/* ===========================================================================
+ * Return the crc32 of the first four bytes of str (the hash key)
+ */
+X86_TARGET_SSE42
+local uInt crc_hash_key(str)
+    const Bytef *str;
+{
+    return (uInt)_mm_crc32_u32(0, X86_LOAD32(str));
+}
+
+/* ===========================================================================
+ * Return the number of equal bytes at the beginning of scan and match,
+ * at most MAX_MATCH. At most MAX_MATCH bytes of each string are read.
+ */
+local int compare_258(scan, match)
+    const Bytef *scan;
+    const Bytef *match;
+{
+    int len;
+    x86_u64 diff;
+
+    for (len = 0; len < MAX_MATCH-2; len += 8) {
+        diff = X86_LOAD64(scan+len) ^ X86_LOAD64(match+len);
+        if (diff != 0) {
+            /* The first different byte is the lowest non-zero byte */
+#ifdef _MSC_VER
+            unsigned long bit;
+#  ifdef _M_X64
+            _BitScanForward64(&bit, diff);
+#  else
+            if ((unsigned long)diff != 0)
+                _BitScanForward(&bit, (unsigned long)diff);
+            else {
+                _BitScanForward(&bit, (unsigned long)(diff >> 32));
+                bit += 32;
+            }
+#  endif
+            return len + (int)(bit >> 3);
+#else
+            return len + (__builtin_ctzll(diff) >> 3);
+#endif
+        }
+    }
+    if (scan[len] != match[len]) return len;
+    if (scan[len+1] != match[len+1]) return len+1;
+    return MAX_MATCH;
+}
+#endif /* X86_DEFLATE */
+
 #ifdef DEBUG
 /* ===========================================================================
  * Check that the match at match_start is indeed a match.
@@ -15,6 +15,18 @@
 
 #include "zutil.h"
 
+/* On x86 processors, longest_match() compares strings eight bytes at a
+ * time and, if the processor supports SSE4.2 (checked at run time), the
+ * strings are hashed with the crc32 instruction. The output is a valid
+ * deflate stream either way. Define NO_X86_DEFLATE to use the portable
+ * code only.
+ */
+#if !defined(NO_X86_DEFLATE) && !defined(FASTEST) && !defined(ASMV) && \
+    (defined(__x86_64__) || defined(__i386__) || \
+     defined(_M_X64) || defined(_M_IX86))
+#  define X86_DEFLATE
+#endif
+
 /* ===========================================================================
  * Internal compression state.
  */
@@ -132,6 +144,14 @@ typedef struct internal_state {
      *   hash_shift * MIN_MATCH >= hash_bits
      */
 
+#ifdef X86_DEFLATE
+    int crc_hash;
+    /* Nonzero if the hash key of a string is the crc32 of its first four
+     * bytes. The key is then computed directly for each string instead of
+     * being rolled from the key of the previous string.
+     */
+#endif
+
     long block_start;
     /* Window position at the beginning of the current output block. Gets
      * negative when the window is moved backwards.
@@ -16,6 +16,28 @@ struct inflate_codes_state {int dummy;}; /* for buggy compilers */
 #define exop word.what.Exop
 #define bits word.what.Bits
 
+/* On x86 processors, the bit buffer is 64 bits wide and is refilled with
+   a single unaligned load, so that one refill covers a complete length/
+   distance pair or up to three literals. Matches are copied eight bytes at
+   a time. Define NO_X86_INFLATE to use the portable code only. */
+#if !defined(NO_X86_INFLATE) && \
+    (defined(__x86_64__) || defined(__i386__) || \
+     defined(_M_X64) || defined(_M_IX86))
+#  define X86_INFLATE
+#endif
+
+#ifdef X86_INFLATE
+#ifdef _MSC_VER
+   typedef unsigned __int64 bitbuf64;
+   typedef unsigned __int64 x86_u64_u;
+#else
+   typedef unsigned long long bitbuf64;
+   typedef unsigned long long x86_u64_u __attribute__((aligned(1), may_alias));
+#endif
+#define X86_LOAD64(p) (*(const x86_u64_u *)(p))
+#define X86_STORE64(p,v) (*(x86_u64_u *)(p)=(v))
+#endif
+
 /* macros for bit input with no checking and for returning unused bytes */
 #define GRABBITS(j) {while(k<(j)){b|=((uLong)NEXTBYTE)<<k;k+=8;}}
 #define UNGRAB {c=z->avail_in-n;c=(k>>3)<c?k>>3:c;n+=c;p-=c;k-=c<<3;}
@@ -25,6 +47,194 @@ struct inflate_codes_state {int dummy;}; /* for buggy compilers */
    at least ten.  The ten bytes are six bytes for the longest length/
    distance pair plus four bytes for overloading the bit buffer. */
 
+#ifdef X86_INFLATE
+
+/* Fill the bit buffer to at least 56 bits with one eight byte load. The
+   bits above k are always a copy of the next input bytes, so or-ing them
+   again is harmless. This needs eight bytes of input, which the caller
+   guarantees. */
+#define WIDEREFILL {b|=X86_LOAD64(p)<<k;c=(63-k)>>3;p+=c;n-=c;k+=c<<3;}
+
+/* Return the unused bytes and clear the prefetched bits above k, since
+   the rest of inflate expects zeros there */
+#define WIDEUNGRAB {UNGRAB b&=(((bitbuf64)1)<<k)-1;}
+#define WIDEUPDATE {s->bitb=(uLong)b;s->bitk=k;UPDIN UPDOUT}
+
+/* Decode a literal that follows a literal without refilling the bit buffer.
+   A code needs at most 15 bits and after a refill there are at least 56. */
+#define NEXTLITERAL \
+    if ((t = tl + ((uInt)b & ml))->exop != 0) continue; \
+    DUMPBITS(t->bits) \
+    Tracevv((stderr, t->base >= 0x20 && t->base < 0x7f ? \
+              "inflate:         * literal '%c'\n" : \
+              "inflate:         * literal 0x%02x\n", t->base)); \
+    *q++ = (Byte)t->base; \
+    m--;
+
+int inflate_fast(bl, bd, tl, td, s, z)
+uInt bl, bd;
+inflate_huft *tl;
+inflate_huft *td; /* need separate declaration for Borland C++ */
+inflate_blocks_statef *s;
+z_streamp z;
+{
+  inflate_huft *t;      /* temporary pointer */
+  uInt e;               /* extra bits or operation */
+  bitbuf64 b;           /* bit buffer */
+  uInt k;               /* bits in bit buffer */
+  Bytef *p;             /* input data pointer */
+  uInt n;               /* bytes available there */
+  Bytef *q;             /* output window write pointer */
+  uInt m;               /* bytes to end of window or read pointer */
+  uInt ml;              /* mask for literal/length tree */
+  uInt md;              /* mask for distance tree */
+  uInt c;               /* bytes to copy */
+  uInt d;               /* distance back to copy from */
+  Bytef *r;             /* copy source pointer */
+
+  /* load input, output, bit values */
+  LOAD
+
+  /* initialize masks */
+  ml = inflate_mask[bl];
+  md = inflate_mask[bd];
+
+  /* do until not enough input or output space for fast loop */
+  do {                          /* assume called with m >= 258 && n >= 10 */
+    /* a literal/length code with extra bits and a distance code with
+       extra bits need at most 48 bits */
+    WIDEREFILL
+
+    /* get literal/length code */
+    if ((e = (t = tl + ((uInt)b & ml))->exop) == 0)
+    {
+      DUMPBITS(t->bits)
+      Tracevv((stderr, t->base >= 0x20 && t->base < 0x7f ?
+                "inflate:         * literal '%c'\n" :
+                "inflate:         * literal 0x%02x\n", t->base));
+      *q++ = (Byte)t->base;
+      m--;
+
+      /* up to two more literals fit into the bit buffer */
+      NEXTLITERAL
+      NEXTLITERAL
+      continue;
+    }
+    do {
+      DUMPBITS(t->bits)
+      if (e & 16)
+      {
+        /* get extra bits for length */
+        e &= 15;
+        c = t->base + ((uInt)b & inflate_mask[e]);
+        DUMPBITS(e)
+        Tracevv((stderr, "inflate:         * length %u\n", c));
+
+        /* decode distance base of block to copy */
+        e = (t = td + ((uInt)b & md))->exop;
+        do {
+          DUMPBITS(t->bits)
+          if (e & 16)
+          {
+            /* get extra bits to add to distance base */
+            e &= 15;
+            d = t->base + ((uInt)b & inflate_mask[e]);
+            DUMPBITS(e)
+            Tracevv((stderr, "inflate:         * distance %u\n", d));
+
+            /* do the copy */
+            m -= c;
+            if ((uInt)(q - s->window) >= d)     /* offset before dest */
+            {
+              r = q - d;
+              if (d >= 8 && m >= 8)
+              {
+                /* Copy eight bytes at a time. Since the distance is at least
+                   eight, each load only reads bytes that are already final.
+                   Up to seven bytes after the end of the match are
+                   overwritten, which is within the free window space. */
+                do {
+                  X86_STORE64(q, X86_LOAD64(r));
+                  q += 8;  r += 8;
+                } while (c > 8 && (c -= 8, 1));
+                q -= 8 - c;
+                break;
+              }
+              *q++ = *r++;  c--;        /* minimum count is three, */
+              *q++ = *r++;  c--;        /*  so unroll loop a little */
+            }
+            else                        /* else offset after destination */
+            {
+              e = d - (uInt)(q - s->window); /* bytes from offset to end */
+              r = s->end - e;           /* pointer to offset */
+              if (c > e)                /* if source crosses, */
+              {
+                c -= e;                 /* copy to end of window */
+                do {
+                  *q++ = *r++;
+                } while (--e);
+                r = s->window;          /* copy rest from start of window */
+              }
+            }
+            do {                        /* copy all or what's left */
+              *q++ = *r++;
+            } while (--c);
+            break;
+          }
+          else if ((e & 64) == 0)
+          {
+            t += t->base;
+            e = (t += ((uInt)b & inflate_mask[e]))->exop;
+          }
+          else
+          {
+            z->msg = (char*)"invalid distance code";
+            WIDEUNGRAB
+            WIDEUPDATE
+            return Z_DATA_ERROR;
+          }
+        } while (1);
+        break;
+      }
+      if ((e & 64) == 0)
+      {
+        t += t->base;
+        if ((e = (t += ((uInt)b & inflate_mask[e]))->exop) == 0)
+        {
+          DUMPBITS(t->bits)
+          Tracevv((stderr, t->base >= 0x20 && t->base < 0x7f ?
+                    "inflate:         * literal '%c'\n" :
+                    "inflate:         * literal 0x%02x\n", t->base));
+          *q++ = (Byte)t->base;
+          m--;
+          break;
+        }
+      }
+      else if (e & 32)
+      {
+        Tracevv((stderr, "inflate:         * end of block\n"));
+        WIDEUNGRAB
+        WIDEUPDATE
+        return Z_STREAM_END;
+      }
+      else
+      {
+        z->msg = (char*)"invalid literal/length code";
+        WIDEUNGRAB
+        WIDEUPDATE
+        return Z_DATA_ERROR;
+      }
+    } while (1);
+  } while (m >= 258 && n >= 10);
+
+  /* not enough input or output--restore pointers and return */
+  WIDEUNGRAB
+  WIDEUPDATE
+  return Z_OK;
+}
+
+#else /* X86_INFLATE */
+
 int inflate_fast(bl, bd, tl, td, s, z)
 uInt bl, bd;
 inflate_huft *tl;
@@ -168,3 +378,5 @@ z_streamp z;
   UPDATE
   return Z_OK;
 }
+
+#endif /* X86_INFLATE */